@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Compare two Google Benchmark JSON result files.
+
+Exits non-zero when any benchmark present in both files is slower than the
+baseline by more than the threshold (a fraction, 0.10 = 10%).
+"""
+
+import argparse
+import json
+import sys
+
+UNIT_TO_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    with open(path) as f:
+        data = json.load(f)
+    times = {}
+    for bench in data.get("benchmarks", []):
+        # With --benchmark_repetitions only the median is compared.
+        if bench.get("run_type") == "aggregate" and bench.get("aggregate_name") != "median":
+            continue
+        if bench.get("run_type") == "iteration" and bench.get("repetitions", 1) > 1:
+            continue
+        name = bench.get("run_name", bench["name"])
+        times[name] = bench[metric] * UNIT_TO_NS[bench.get("time_unit", "ns")]
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=0.10)
+    parser.add_argument("--metric", choices=["real_time", "cpu_time"], default="cpu_time")
+    args = parser.parse_args()
+
+    try:
+        baseline = load(args.baseline, args.metric)
+    except FileNotFoundError:
+        print(f"no baseline at {args.baseline}; copy the contender there to create one")
+        return 2
+    contender = load(args.contender, args.metric)
+
+    regressions = []
+    width = max((len(name) for name in contender), default=4)
+    print(f"{'benchmark':<{width}}  {'baseline':>14}  {'contender':>14}  {'change':>8}")
+    for name, time in contender.items():
+        if name not in baseline:
+            print(f"{name:<{width}}  {'-':>14}  {time:>12.1f}ns  {'new':>8}")
+            continue
+        change = (time - baseline[name]) / baseline[name]
+        flag = ""
+        if change > args.threshold:
+            regressions.append(name)
+            flag = "  REGRESSION"
+        print(f"{name:<{width}}  {baseline[name]:>12.1f}ns  {time:>12.1f}ns  {change:>+7.1%}{flag}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) regressed by more than {args.threshold:.0%}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
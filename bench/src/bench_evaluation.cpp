@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/evaluation.h>
+#include <classifier/math.h>
+#include <classifier/model.h>
+#include <classifier/model_selection.h>
+#include <classifier/trainer.h>
+
+#include "synthetic.h"
+
+namespace {
+
+constexpr std::size_t features = 16;
+constexpr std::size_t rows = 1 << 19;
+
+using Set = classifier::Trainer<features>::TrainingSet;
+
+Set const& holdout() {
+    static Set const data = bench::make_training_set<features>(rows);
+    return data;
+}
+
+// The loop evaluation replaces: classify each row, keep every score and
+// sort them all for the AUC.
+void BM_EvaluateByClassify(benchmark::State& state) {
+    auto const& data = holdout();
+    auto const model = bench::make_model<features>();
+    std::vector<std::pair<float, float>> scored;
+    for (auto _ : state) {
+        scored.clear();
+        double loss = 0.0;
+        std::size_t correct = 0;
+        for (auto const& sample : data) {
+            std::array<float, features> x;
+            std::copy_n(sample.begin(), features, x.begin());
+            auto result = model.classify(x);
+            float p = result.prediction == classifier::Prediction::positive
+                          ? result.confidence
+                          : 1.0f - result.confidence;
+            float z = classifier::math::dot(model.weights(), std::span<float const, features>(x)) +
+                      model.bias();
+            loss += classifier::math::logistic_loss(z, sample[features]);
+            correct += (p >= 0.5f) == (sample[features] > 0.5f);
+            scored.emplace_back(p, sample[features]);
+        }
+        double auc = classifier::detail::roc_auc(scored);
+        benchmark::DoNotOptimize(loss);
+        benchmark::DoNotOptimize(correct);
+        benchmark::DoNotOptimize(auc);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(rows));
+}
+
+// range(0) threads (0 = all hardware threads), range(1) the AUC error budget
+// as 10^-range(1).
+void BM_Evaluate(benchmark::State& state) {
+    auto const& data = holdout();
+    auto const model = bench::make_model<features>();
+    classifier::EvaluationOptions options;
+    options.threads = static_cast<std::size_t>(state.range(0));
+    options.auc_error = 1.0;
+    for (std::int64_t i = 0; i < state.range(1); ++i) {
+        options.auc_error /= 10.0;
+    }
+    classifier::Evaluation result;
+    for (auto _ : state) {
+        classifier::evaluate(model, std::span<Set::value_type const>(data), options, result);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(rows));
+    state.counters["auc_error"] = result.auc_error;
+}
+
+} // namespace
+
+BENCHMARK(BM_EvaluateByClassify)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Evaluate)
+    ->Args({1, 3})
+    ->Args({1, 6})
+    ->Args({0, 3})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
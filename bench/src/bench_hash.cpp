@@ -0,0 +1,90 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/feature_hasher.h>
+#include <classifier/kernels_hash.h>
+#include <classifier/model.h>
+
+#include "synthetic.h"
+
+namespace {
+
+constexpr std::size_t features_per_row = 40;
+
+std::vector<classifier::KeyFeature> make_key_features(std::size_t count) {
+    std::vector<classifier::KeyFeature> features(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        features[i] = {i * 0x9e3779b97f4a7c15ull, 1.0f};
+    }
+    return features;
+}
+
+void BM_HashKeys(benchmark::State& state) {
+    auto isa = static_cast<classifier::kernels::HashIsa>(state.range(0));
+    if (isa > classifier::kernels::active_hash_isa()) {
+        state.SkipWithError("ISA not supported on this machine");
+        return;
+    }
+    std::vector<std::uint64_t> keys;
+    for (auto const& feature : make_key_features(256)) {
+        keys.push_back(feature.key);
+    }
+    std::array<classifier::kernels::HashSlot, 256> slots;
+    for (auto _ : state) {
+        classifier::kernels::hash_keys(keys.data(), keys.size(), 1, 1 << 20, slots.data(), isa);
+        benchmark::DoNotOptimize(slots.data());
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// Builds the feature vector for one request and scores it, the path a request
+// handler takes per record.
+template <std::size_t N>
+void BM_HashAndClassify(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    classifier::FeatureHasher<N> hasher;
+    std::vector<std::string> names;
+    for (std::size_t i = 0; i < features_per_row; ++i) {
+        names.push_back("feature_" + std::to_string(i) + "=value_" + std::to_string(i * 7));
+    }
+    std::vector<classifier::StringFeature> features;
+    for (auto const& name : names) {
+        features.push_back({name, 1.0f});
+    }
+
+    std::array<float, N> row;
+    for (auto _ : state) {
+        hasher.hash(features, row);
+        benchmark::DoNotOptimize(model.classify(row));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <std::size_t N>
+void BM_HashBatch(benchmark::State& state) {
+    constexpr std::size_t rows = 256;
+    classifier::FeatureHasher<N> hasher;
+    auto features = make_key_features(rows * features_per_row);
+    std::vector<std::size_t> offsets(rows + 1);
+    for (std::size_t r = 0; r <= rows; ++r) {
+        offsets[r] = r * features_per_row;
+    }
+    std::vector<float> out(rows * N);
+    for (auto _ : state) {
+        hasher.hash_batch(features, offsets, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+
+} // namespace
+
+BENCHMARK(BM_HashKeys)->DenseRange(0, 1);
+BENCHMARK(BM_HashAndClassify<128>);
+BENCHMARK(BM_HashAndClassify<1024>);
+BENCHMARK(BM_HashBatch<128>);
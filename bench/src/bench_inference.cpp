@@ -0,0 +1,79 @@
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/arena.h>
+#include <classifier/inference.h>
+#include <classifier/model.h>
+
+#include "synthetic.h"
+
+namespace {
+
+constexpr std::size_t request_rows = 32;
+constexpr std::size_t requests = 256;
+
+// What a service does without an arena: a fresh result vector per request.
+template <std::size_t N>
+void BM_RequestAllocatingVector(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    auto features = bench::make_features<N>(request_rows * requests);
+
+    std::size_t q = 0;
+    for (auto _ : state) {
+        std::vector<classifier::Result> results(request_rows);
+        model.classify_batch(std::span(features).subspan(q * request_rows * N, request_rows * N),
+                             results);
+        benchmark::DoNotOptimize(results.data());
+        q = (q + 1) % requests;
+    }
+    state.SetItemsProcessed(state.iterations() * request_rows);
+}
+
+template <std::size_t N>
+void BM_RequestArena(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    auto features = bench::make_features<N>(request_rows * requests);
+    classifier::Arena arena(64 * 1024);
+
+    std::size_t q = 0;
+    for (auto _ : state) {
+        arena.reset();
+        std::span<classifier::Result> results;
+        classifier::classify_batch(
+            model, std::span<float const>(features).subspan(q * request_rows * N, request_rows * N),
+            arena, results);
+        benchmark::DoNotOptimize(results.data());
+        q = (q + 1) % requests;
+    }
+    state.SetItemsProcessed(state.iterations() * request_rows);
+}
+
+template <std::size_t N>
+void BM_RequestExplainTop5(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    auto features = bench::make_features<N>(request_rows * requests);
+    classifier::Arena arena(256 * 1024);
+
+    std::size_t q = 0;
+    for (auto _ : state) {
+        arena.reset();
+        std::span<classifier::Explanation> explanations;
+        classifier::explain_batch(
+            model, std::span<float const>(features).subspan(q * request_rows * N, request_rows * N),
+            5, arena, explanations);
+        benchmark::DoNotOptimize(explanations.data());
+        q = (q + 1) % requests;
+    }
+    state.SetItemsProcessed(state.iterations() * request_rows);
+}
+
+} // namespace
+
+BENCHMARK(BM_RequestAllocatingVector<16>);
+BENCHMARK(BM_RequestAllocatingVector<128>);
+BENCHMARK(BM_RequestArena<16>);
+BENCHMARK(BM_RequestArena<128>);
+BENCHMARK(BM_RequestExplainTop5<128>);
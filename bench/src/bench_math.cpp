@@ -0,0 +1,139 @@
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/kernels.h>
+#include <classifier/kernels_fixed.h>
+#include <classifier/math.h>
+#include <classifier/sigmoid.h>
+
+#include "synthetic.h"
+
+namespace {
+
+template <std::size_t N>
+void BM_DotArray(benchmark::State& state) {
+    auto values = bench::make_features<N>(2);
+    std::array<float, N> a;
+    std::array<float, N> b;
+    std::copy_n(values.begin(), N, a.begin());
+    std::copy_n(values.begin() + N, N, b.begin());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        float result = classifier::math::dot(a, b);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+// The unrolled small-N kernel; compare against BM_DotArray at the same N.
+template <std::size_t N>
+void BM_DotFixed(benchmark::State& state) {
+    auto values = bench::make_features<N>(2);
+    std::array<float, N> a;
+    std::array<float, N> b;
+    std::copy_n(values.begin(), N, a.begin());
+    std::copy_n(values.begin() + N, N, b.begin());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        float result = classifier::kernels::dot_fixed<N>(a.data(), b.data());
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+template <std::size_t N>
+void BM_DotRange(benchmark::State& state) {
+    auto values = bench::make_features<N>(2);
+    std::vector<float> a(values.begin(), values.begin() + N);
+    std::vector<float> b(values.begin() + N, values.end());
+
+    for (auto _ : state) {
+        float result = 0.0f;
+        auto error = classifier::math::dot(a, b, result);
+        benchmark::DoNotOptimize(error);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+void BM_Sigmoid(benchmark::State& state) {
+    auto inputs = bench::make_features<1>(1024);
+    for (auto _ : state) {
+        for (float x : inputs) {
+            benchmark::DoNotOptimize(classifier::math::sigmoid(x));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+
+void BM_SigmoidVectorized(benchmark::State& state) {
+    auto inputs = bench::make_features<1>(1024);
+    std::vector<float> values(inputs.size());
+    for (auto _ : state) {
+        values = inputs;
+        classifier::kernels::sigmoid_inplace(values.data(), values.size());
+        benchmark::DoNotOptimize(values.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+
+template <classifier::SigmoidPolicy S>
+void BM_SigmoidPolicy(benchmark::State& state) {
+    auto inputs = bench::make_features<1>(1024);
+    for (auto _ : state) {
+        for (float x : inputs) {
+            benchmark::DoNotOptimize(S::apply(x));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+
+template <classifier::SigmoidPolicy S>
+void BM_SigmoidPolicyBatch(benchmark::State& state) {
+    auto inputs = bench::make_features<1>(1024);
+    std::vector<float> values(inputs.size());
+    for (auto _ : state) {
+        values = inputs;
+        S::apply_inplace(values.data(), values.size());
+        benchmark::DoNotOptimize(values.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+
+} // namespace
+
+BENCHMARK(BM_DotArray<2>);
+BENCHMARK(BM_DotArray<8>);
+BENCHMARK(BM_DotArray<13>);
+BENCHMARK(BM_DotArray<16>);
+BENCHMARK(BM_DotArray<32>);
+BENCHMARK(BM_DotArray<128>);
+BENCHMARK(BM_DotArray<1024>);
+
+BENCHMARK(BM_DotFixed<2>);
+BENCHMARK(BM_DotFixed<8>);
+BENCHMARK(BM_DotFixed<13>);
+BENCHMARK(BM_DotFixed<16>);
+BENCHMARK(BM_DotFixed<32>);
+
+BENCHMARK(BM_DotRange<2>);
+BENCHMARK(BM_DotRange<16>);
+BENCHMARK(BM_DotRange<128>);
+BENCHMARK(BM_DotRange<1024>);
+
+BENCHMARK(BM_Sigmoid);
+BENCHMARK(BM_SigmoidVectorized);
+
+BENCHMARK(BM_SigmoidPolicy<classifier::ExactSigmoid>);
+BENCHMARK(BM_SigmoidPolicy<classifier::RationalSigmoid>);
+BENCHMARK(BM_SigmoidPolicy<classifier::TableSigmoid>);
+BENCHMARK(BM_SigmoidPolicyBatch<classifier::ExactSigmoid>);
+BENCHMARK(BM_SigmoidPolicyBatch<classifier::RationalSigmoid>);
+BENCHMARK(BM_SigmoidPolicyBatch<classifier::TableSigmoid>);
@@ -0,0 +1,89 @@
+// Built twice, as bench_metrics_off and bench_metrics_on (CLASSIFIER_METRICS
+// = 0 / 1), so the bench_metrics_overhead target can compare the hot paths
+// with and without instrumentation.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/model.h>
+#include <classifier/trainer.h>
+
+#include "synthetic.h"
+
+namespace {
+
+constexpr std::size_t rows = 4096;
+
+template <std::size_t N>
+void BM_MetricsClassify(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    auto values = bench::make_features<N>(rows);
+    std::vector<std::array<float, N>> features(rows);
+    for (std::size_t r = 0; r < rows; ++r) {
+        std::copy_n(values.begin() + r * N, N, features[r].begin());
+    }
+
+    std::size_t r = 0;
+    for (auto _ : state) {
+        auto result = model.classify(features[r]);
+        benchmark::DoNotOptimize(result);
+        r = (r + 1) % rows;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// range(0) rows per call.
+template <std::size_t N>
+void BM_MetricsScoreBatch(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    auto batch = static_cast<std::size_t>(state.range(0));
+    auto features = bench::make_features<N>(batch);
+    std::vector<float> scores(batch);
+
+    for (auto _ : state) {
+        model.score_batch(features, scores);
+        benchmark::DoNotOptimize(scores.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <std::size_t N>
+void BM_MetricsTrainEpoch(benchmark::State& state) {
+    auto data = bench::make_training_set<N>(10000);
+    classifier::Model<N> model;
+    classifier::Trainer<N> trainer(model);
+
+    for (auto _ : state) {
+        trainer.train(data, 0.1f, 1);
+        benchmark::DoNotOptimize(model);
+    }
+}
+
+template <std::size_t N>
+void BM_MetricsDeserialize(benchmark::State& state) {
+    std::ostringstream os;
+    bench::make_model<N>().serialize(os);
+    std::string const bytes = os.str();
+    classifier::Model<N> model;
+
+    for (auto _ : state) {
+        std::istringstream is(bytes);
+        auto error = model.deserialize(is);
+        benchmark::DoNotOptimize(error);
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_MetricsClassify<16>);
+BENCHMARK(BM_MetricsClassify<128>);
+BENCHMARK(BM_MetricsScoreBatch<16>)->Arg(16)->Arg(256);
+BENCHMARK(BM_MetricsTrainEpoch<16>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MetricsDeserialize<128>);
@@ -0,0 +1,68 @@
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/model.h>
+#include <classifier/sigmoid.h>
+
+#include "synthetic.h"
+
+namespace {
+
+constexpr std::size_t batch_rows = 4096;
+
+template <std::size_t N, classifier::SigmoidPolicy S = classifier::ExactSigmoid>
+void BM_ModelClassify(benchmark::State& state) {
+    auto source = bench::make_model<N>();
+    classifier::Model<N, S> model;
+    for (std::size_t i = 0; i < N; ++i) {
+        model.set_weight(i, source.weight(i));
+    }
+    model.set_bias(source.bias());
+    auto values = bench::make_features<N>(batch_rows);
+    std::vector<std::array<float, N>> rows(batch_rows);
+    for (std::size_t r = 0; r < batch_rows; ++r) {
+        std::copy_n(values.begin() + r * N, N, rows[r].begin());
+    }
+
+    std::size_t r = 0;
+    for (auto _ : state) {
+        auto result = model.classify(rows[r]);
+        benchmark::DoNotOptimize(result);
+        r = (r + 1) % batch_rows;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <std::size_t N>
+void BM_ModelClassifyBatch(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    auto features = bench::make_features<N>(batch_rows);
+    std::vector<classifier::Result> results(batch_rows);
+
+    for (auto _ : state) {
+        model.classify_batch(features, results);
+        benchmark::DoNotOptimize(results.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * batch_rows);
+    state.SetBytesProcessed(state.iterations() * batch_rows * N * sizeof(float));
+}
+
+} // namespace
+
+BENCHMARK(BM_ModelClassify<2>);
+BENCHMARK(BM_ModelClassify<8>);
+BENCHMARK(BM_ModelClassify<16>);
+BENCHMARK(BM_ModelClassify<32>);
+BENCHMARK(BM_ModelClassify<128>);
+BENCHMARK(BM_ModelClassify<1024>);
+BENCHMARK(BM_ModelClassify<16, classifier::RationalSigmoid>);
+BENCHMARK(BM_ModelClassify<16, classifier::TableSigmoid>);
+
+BENCHMARK(BM_ModelClassifyBatch<2>);
+BENCHMARK(BM_ModelClassifyBatch<16>);
+BENCHMARK(BM_ModelClassifyBatch<128>);
+BENCHMARK(BM_ModelClassifyBatch<1024>);
@@ -0,0 +1,95 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/model.h>
+#include <classifier/model_bank.h>
+
+#include "synthetic.h"
+
+namespace {
+
+constexpr std::size_t features = 32;
+constexpr std::size_t batch_rows = 256;
+
+std::vector<classifier::Model<features>> tenants(std::size_t count) {
+    std::vector<classifier::Model<features>> models;
+    for (std::size_t m = 0; m < count; ++m) {
+        models.push_back(bench::make_model<features>(m));
+    }
+    return models;
+}
+
+// range(0) models scored one by one against the same feature vector.
+void BM_ScoreEachModel(benchmark::State& state) {
+    auto const models = tenants(static_cast<std::size_t>(state.range(0)));
+    auto const rows = bench::make_features<features>(1);
+    std::array<float, features> x;
+    std::copy(rows.begin(), rows.end(), x.begin());
+    std::vector<float> scores(models.size());
+    for (auto _ : state) {
+        for (std::size_t m = 0; m < models.size(); ++m) {
+            scores[m] = models[m].classify(x).confidence;
+        }
+        benchmark::DoNotOptimize(scores.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ModelBankScore(benchmark::State& state) {
+    classifier::ModelBank<features> bank;
+    for (auto const& model : tenants(static_cast<std::size_t>(state.range(0)))) {
+        bank.add(model);
+    }
+    auto const rows = bench::make_features<features>(1);
+    std::array<float, features> x;
+    std::copy(rows.begin(), rows.end(), x.begin());
+    std::vector<float> scores(bank.size());
+    for (auto _ : state) {
+        bank.score(x, scores);
+        benchmark::DoNotOptimize(scores.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// A batch of rows against every model: Model::score_batch per model against
+// one ModelBank::score_batch. Items are (row, model) scores.
+void BM_ScoreBatchEachModel(benchmark::State& state) {
+    auto const models = tenants(static_cast<std::size_t>(state.range(0)));
+    auto const rows = bench::make_features<features>(batch_rows);
+    std::vector<float> scores(batch_rows * models.size());
+    for (auto _ : state) {
+        for (std::size_t m = 0; m < models.size(); ++m) {
+            models[m].score_batch(rows, std::span<float>(scores).subspan(m * batch_rows,
+                                                                         batch_rows));
+        }
+        benchmark::DoNotOptimize(scores.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) *
+                            static_cast<std::int64_t>(batch_rows));
+}
+
+void BM_ModelBankScoreBatch(benchmark::State& state) {
+    classifier::ModelBank<features> bank;
+    for (auto const& model : tenants(static_cast<std::size_t>(state.range(0)))) {
+        bank.add(model);
+    }
+    auto const rows = bench::make_features<features>(batch_rows);
+    std::vector<float> scores(batch_rows * bank.size());
+    for (auto _ : state) {
+        bank.score_batch(rows, scores);
+        benchmark::DoNotOptimize(scores.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) *
+                            static_cast<std::int64_t>(batch_rows));
+}
+
+} // namespace
+
+BENCHMARK(BM_ScoreEachModel)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(BM_ModelBankScore)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(BM_ScoreBatchEachModel)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(BM_ModelBankScoreBatch)->Arg(16)->Arg(64)->Arg(256);
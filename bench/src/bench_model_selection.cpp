@@ -0,0 +1,58 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/model_selection.h>
+#include <classifier/trainer.h>
+
+#include "synthetic.h"
+
+namespace {
+
+constexpr std::size_t features = 16;
+
+using Set = classifier::Trainer<features>::TrainingSet;
+
+Set const& training_set() {
+    static Set const data = bench::make_training_set<features>(20000);
+    return data;
+}
+
+// Candidates of uneven cost (10 to 80 epochs), which is what the work
+// stealing is for: a static split would leave threads idle behind the one
+// that drew the long trainings.
+std::vector<classifier::Hyperparameters> candidates() {
+    classifier::SearchGrid space;
+    space.learning_rates = {0.05f, 0.5f};
+    space.epochs = {10, 20, 40, 80};
+    space.regularizations = {classifier::Regularization::l2};
+    space.regularization_strengths = {0.0f, 1e-3f};
+    return classifier::grid(space);
+}
+
+// One iteration is a full 5-fold search over 16 candidates (80 trainings)
+// plus the refit, on range(0) threads (0 = all hardware threads). Items/s
+// counts trainings.
+void BM_CrossValidate(benchmark::State& state) {
+    auto const& data = training_set();
+    auto const grid = candidates();
+    classifier::CrossValidationOptions options;
+    options.folds = 5;
+    options.threads = static_cast<std::size_t>(state.range(0));
+
+    classifier::SearchResult<features> result;
+    for (auto _ : state) {
+        classifier::cross_validate<features>(data, grid, options, result);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(grid.size() * options.folds));
+    state.counters["best_log_loss"] = result.scores[result.best].mean_log_loss;
+    state.counters["best_auc"] = result.scores[result.best].mean_auc;
+}
+
+} // namespace
+
+BENCHMARK(BM_CrossValidate)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/model.h>
+#include <classifier/multiclass_model.h>
+
+#include "synthetic.h"
+
+namespace {
+
+constexpr std::size_t batch_rows = 1024;
+constexpr std::size_t classes = 50;
+
+template <std::size_t N>
+std::vector<std::array<float, N>> make_rows() {
+    auto values = bench::make_features<N>(batch_rows);
+    std::vector<std::array<float, N>> rows(batch_rows);
+    for (std::size_t r = 0; r < batch_rows; ++r) {
+        std::copy_n(values.begin() + r * N, N, rows[r].begin());
+    }
+    return rows;
+}
+
+// The baseline being replaced: one binary model per class, each re-reading
+// the features, with the most confident one winning.
+template <std::size_t N>
+void BM_SeparateModelsArgmax(benchmark::State& state) {
+    std::vector<classifier::Model<N>> models;
+    for (std::size_t c = 0; c < classes; ++c) {
+        models.push_back(bench::make_model<N>(c + 10));
+    }
+    auto rows = make_rows<N>();
+
+    std::size_t r = 0;
+    for (auto _ : state) {
+        std::size_t best = 0;
+        float best_z = -1.0f;
+        for (std::size_t c = 0; c < classes; ++c) {
+            auto result = models[c].classify(rows[r]);
+            float z = result.prediction == classifier::Prediction::positive ? result.confidence
+                                                                             : -result.confidence;
+            if (z > best_z) {
+                best_z = z;
+                best = c;
+            }
+        }
+        benchmark::DoNotOptimize(best);
+        r = (r + 1) % batch_rows;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <std::size_t N>
+void BM_MulticlassClassify(benchmark::State& state) {
+    std::array<classifier::Model<N>, classes> models;
+    for (std::size_t c = 0; c < classes; ++c) {
+        models[c] = bench::make_model<N>(c + 10);
+    }
+    auto model = classifier::MulticlassModel<classes, N>::template one_vs_rest<
+        classifier::ExactSigmoid>(models);
+    auto rows = make_rows<N>();
+
+    std::size_t r = 0;
+    for (auto _ : state) {
+        auto result = model.classify(rows[r]);
+        benchmark::DoNotOptimize(result);
+        r = (r + 1) % batch_rows;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <std::size_t N>
+void BM_MulticlassClassifyBatch(benchmark::State& state) {
+    classifier::MulticlassModel<classes, N> model;
+    auto source = bench::make_features<N>(classes, 7);
+    for (std::size_t c = 0; c < classes; ++c) {
+        for (std::size_t i = 0; i < N; ++i) {
+            model.set_weight(c, i, 0.1f * source[c * N + i]);
+        }
+    }
+    auto features = bench::make_features<N>(batch_rows);
+    std::vector<classifier::MulticlassResult> results(batch_rows);
+
+    for (auto _ : state) {
+        model.classify_batch(features, results);
+        benchmark::DoNotOptimize(results.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * batch_rows);
+}
+
+} // namespace
+
+BENCHMARK(BM_SeparateModelsArgmax<16>);
+BENCHMARK(BM_SeparateModelsArgmax<128>);
+BENCHMARK(BM_SeparateModelsArgmax<1024>);
+BENCHMARK(BM_MulticlassClassify<16>);
+BENCHMARK(BM_MulticlassClassify<128>);
+BENCHMARK(BM_MulticlassClassify<1024>);
+BENCHMARK(BM_MulticlassClassifyBatch<128>);
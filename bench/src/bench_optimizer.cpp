@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/math.h>
+#include <classifier/model.h>
+#include <classifier/optimizer.h>
+#include <classifier/trainer.h>
+
+#include "synthetic.h"
+
+namespace {
+
+constexpr std::size_t features = 64;
+constexpr std::size_t rows = 20000;
+constexpr std::size_t max_epochs = 100;
+// The data has 5% label noise; the loss plateaus around 0.32.
+constexpr double target_loss = 0.33;
+
+using Set = classifier::Trainer<features>::TrainingSet;
+
+Set const& training_set() {
+    static Set const data = bench::make_training_set<features>(rows);
+    return data;
+}
+
+double log_loss(classifier::Model<features> const& model, Set const& data) {
+    double total = 0.0;
+    for (auto const& sample : data) {
+        float z = model.bias();
+        for (std::size_t i = 0; i < features; ++i) {
+            z += model.weight(i) * sample[i];
+        }
+        double p = std::clamp(static_cast<double>(classifier::math::sigmoid(z)), 1e-7, 1.0 - 1e-7);
+        total -= sample[features] > 0.5f ? std::log(p) : std::log(1.0 - p);
+    }
+    return total / static_cast<double>(data.size());
+}
+
+// A reasonable base rate for each optimizer on this data; adaptive ones take
+// larger values because they normalize the step per coordinate.
+template <typename O>
+constexpr float learning_rate = 0.1f;
+template <>
+constexpr float learning_rate<classifier::AdaGrad> = 0.5f;
+template <>
+constexpr float learning_rate<classifier::Adam> = 0.01f;
+template <>
+constexpr float learning_rate<classifier::Ftrl> = 0.5f;
+
+// One iteration trains a fresh model one epoch at a time until the training
+// log-loss reaches the target. The "epochs" counter is the comparison that
+// matters (max_epochs + 1 means never); wall time per iteration also
+// reflects each optimizer's per-step cost.
+template <typename O>
+void BM_EpochsToTargetLoss(benchmark::State& state) {
+    auto const& data = training_set();
+    classifier::SgdOptions options;
+    options.learning_rate = learning_rate<O>;
+    options.epochs = 1;
+    options.batch_size = 256;
+
+    std::size_t epochs = 0;
+    double loss = 0.0;
+    for (auto _ : state) {
+        classifier::Model<features> model;
+        classifier::Trainer<features> trainer(model);
+        O optimizer;
+        for (epochs = 1; epochs <= max_epochs; ++epochs) {
+            options.seed = epochs;
+            trainer.train_sgd(data, options, optimizer);
+            loss = log_loss(model, data);
+            if (loss <= target_loss) {
+                break;
+            }
+        }
+    }
+    state.counters["epochs"] = static_cast<double>(epochs);
+    state.counters["loss"] = loss;
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_EpochsToTargetLoss, classifier::GradientDescent)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_EpochsToTargetLoss, classifier::Momentum)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_EpochsToTargetLoss, classifier::Nesterov)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_EpochsToTargetLoss, classifier::AdaGrad)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_EpochsToTargetLoss, classifier::Adam)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_EpochsToTargetLoss, classifier::Ftrl)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,44 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/quantized_model.h>
+
+#include "synthetic.h"
+
+namespace {
+
+constexpr std::size_t batch_rows = 4096;
+
+template <std::size_t N>
+void BM_QuantizedClassifyBatch(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    auto calibration = bench::make_training_set<N>(256);
+    classifier::QuantizedModel<N> quantized;
+    classifier::QuantizedModel<N>::quantize(model, calibration, quantized);
+
+    auto values = bench::make_features<N>(batch_rows);
+    std::vector<std::uint8_t> features(values.size());
+    for (std::size_t r = 0; r < batch_rows; ++r) {
+        quantized.quantize_features(std::span<float const, N>(values.data() + r * N, N),
+                                    std::span<std::uint8_t, N>(features.data() + r * N, N));
+    }
+    std::vector<classifier::Result> results(batch_rows);
+
+    for (auto _ : state) {
+        quantized.classify_batch(features, results);
+        benchmark::DoNotOptimize(results.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * batch_rows);
+    state.SetBytesProcessed(state.iterations() * features.size());
+}
+
+} // namespace
+
+BENCHMARK(BM_QuantizedClassifyBatch<16>);
+BENCHMARK(BM_QuantizedClassifyBatch<128>);
+BENCHMARK(BM_QuantizedClassifyBatch<1024>);
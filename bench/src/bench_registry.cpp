@@ -0,0 +1,83 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/latency_histogram.h>
+#include <classifier/model.h>
+#include <classifier/model_registry.h>
+
+#include "synthetic.h"
+
+namespace {
+
+classifier::ModelRegistry<classifier::Model<16>>& shared_registry() {
+    static classifier::ModelRegistry<classifier::Model<16>> registry(256);
+    static bool const published = (registry.publish("ctr", bench::make_model<16>()), true);
+    (void)published;
+    return registry;
+}
+
+// Snapshot plus classify per iteration; compare with BM_ModelClassify<16> for
+// the cost of the registry read path, and across thread counts for scaling.
+void BM_RegistrySnapshotClassify(benchmark::State& state) {
+    auto& registry = shared_registry();
+    auto reader = registry.reader();
+    std::array<float, 16> features;
+    features.fill(0.25f);
+    for (auto _ : state) {
+        auto snapshot = reader.snapshot("ctr");
+        benchmark::DoNotOptimize(snapshot->classify(features));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Per-read latency of snapshot plus classify, with range(0) = 0 for a quiet
+// registry and 1 for a writer publishing a new version every 100us. Reports
+// percentiles from a LatencyHistogram; p99 should match between the two, as
+// a swap costs readers nothing beyond the next snapshot's pointer load. Each
+// read is timed on its own, so the figures include clock overhead.
+void BM_RegistryReadLatency(benchmark::State& state) {
+    classifier::ModelRegistry<classifier::Model<16>> registry(4);
+    registry.publish("ctr", bench::make_model<16>());
+    auto reader = registry.reader();
+    std::array<float, 16> features;
+    features.fill(0.25f);
+
+    std::atomic<bool> done{false};
+    std::thread publisher;
+    if (state.range(0) != 0) {
+        publisher = std::thread([&] {
+            auto model = bench::make_model<16>();
+            while (!done.load(std::memory_order_relaxed)) {
+                registry.publish("ctr", model);
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+    }
+
+    classifier::LatencyHistogram histogram;
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        auto snapshot = reader.snapshot("ctr");
+        benchmark::DoNotOptimize(snapshot->classify(features));
+        histogram.record(std::chrono::steady_clock::now() - start);
+    }
+
+    done = true;
+    if (publisher.joinable()) {
+        publisher.join();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["p50_ns"] = static_cast<double>(histogram.percentile(0.50).count());
+    state.counters["p99_ns"] = static_cast<double>(histogram.percentile(0.99).count());
+    state.counters["p999_ns"] = static_cast<double>(histogram.percentile(0.999).count());
+}
+
+} // namespace
+
+BENCHMARK(BM_RegistrySnapshotClassify)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_RegistryReadLatency)->Arg(0)->Arg(1)->UseRealTime();
@@ -0,0 +1,108 @@
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/model.h>
+#include <classifier/model_file.h>
+#include <classifier/trainer.h>
+
+#include "synthetic.h"
+
+namespace {
+
+template <std::size_t N>
+void BM_ModelSerialize(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    std::string buffer;
+    for (auto _ : state) {
+        std::ostringstream os(std::move(buffer), std::ios::binary);
+        model.serialize(os);
+        buffer = std::move(os).str();
+        buffer.clear();
+    }
+    state.SetBytesProcessed(state.iterations() * (sizeof(std::size_t) + sizeof(float) * (N + 1)));
+}
+
+template <std::size_t N>
+void BM_ModelDeserialize(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    std::ostringstream os(std::ios::binary);
+    model.serialize(os);
+    std::string bytes = os.str();
+
+    classifier::Model<N> loaded;
+    for (auto _ : state) {
+        std::istringstream is(bytes, std::ios::binary);
+        benchmark::DoNotOptimize(loaded.deserialize(is));
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+template <std::size_t N>
+void BM_TrainingDataDeserialize(benchmark::State& state) {
+    auto data = bench::make_training_set<N>(static_cast<std::size_t>(state.range(0)));
+    std::ostringstream os(std::ios::binary);
+    std::size_t cols = N + 1;
+    std::size_t rows = data.size();
+    os.write(reinterpret_cast<char const*>(&cols), sizeof(cols));
+    os.write(reinterpret_cast<char const*>(&rows), sizeof(rows));
+    os.write(reinterpret_cast<char const*>(data.data()),
+             static_cast<std::streamsize>(sizeof(data[0]) * rows));
+    std::string bytes = os.str();
+
+    typename classifier::Trainer<N>::TrainingSet loaded;
+    for (auto _ : state) {
+        std::istringstream is(bytes, std::ios::binary);
+        benchmark::DoNotOptimize(classifier::Trainer<N>::deserialize_training_data(is, loaded));
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+template <std::size_t N>
+void BM_ModelFileRead(benchmark::State& state) {
+    auto model = bench::make_model<N>();
+    std::ostringstream os(std::ios::binary);
+    classifier::write_model_file(os, model);
+    std::string bytes = os.str();
+
+    classifier::Model<N> loaded;
+    for (auto _ : state) {
+        std::istringstream is(bytes, std::ios::binary);
+        benchmark::DoNotOptimize(classifier::read_model_file(is, loaded));
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+// Opening a 4M-weight (16 MiB) model in place; range(0) is the Verify mode,
+// so the header-only case shows the cost of refusing a corrupt header.
+void BM_MappedModelOpen(benchmark::State& state) {
+    constexpr std::size_t dimension = std::size_t(1) << 22;
+    auto path = std::filesystem::temp_directory_path() / "classifier_bench_model.clmf";
+    {
+        std::vector<float> weights(dimension, 0.5f);
+        std::ofstream os(path, std::ios::binary);
+        classifier::write_model_file(os, weights, 0.0f);
+    }
+
+    auto verify = static_cast<classifier::Verify>(state.range(0));
+    classifier::MappedModel model;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.open(path.c_str(), verify));
+        model.close();
+    }
+    state.SetBytesProcessed(state.iterations() * dimension * sizeof(float));
+    std::filesystem::remove(path);
+}
+
+} // namespace
+
+BENCHMARK(BM_ModelSerialize<1024>);
+BENCHMARK(BM_ModelDeserialize<1024>);
+BENCHMARK(BM_TrainingDataDeserialize<16>)->Arg(100'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ModelFileRead<1024>);
+BENCHMARK(BM_MappedModelOpen)->DenseRange(0, 1);
@@ -0,0 +1,51 @@
+#include <cstddef>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/sparse_model.h>
+#include <classifier/sparse_trainer.h>
+
+#include "synthetic.h"
+
+namespace {
+
+classifier::CsrTrainingSet const& cached_sparse_set() {
+    static auto const data = bench::make_sparse_training_set(100'000, 1u << 20, 50);
+    return data;
+}
+
+// One iteration is one SGD epoch over 100k rows of 50 non-zeros in a 2^20
+// feature space; the regularized variants should cost about the same.
+void BM_SparseTrainEpoch(benchmark::State& state) {
+    auto const& data = cached_sparse_set();
+    classifier::SparseModel model(data.dimension);
+    classifier::SparseTrainer trainer(model);
+
+    classifier::SparseSgdOptions options;
+    options.epochs = 1;
+    options.regularization = static_cast<classifier::Regularization>(state.range(0));
+    options.regularization_strength = 1e-6f;
+    for (auto _ : state) {
+        trainer.train(data, options);
+        benchmark::DoNotOptimize(model.weights().data());
+    }
+    state.SetItemsProcessed(state.iterations() * data.rows());
+}
+
+void BM_SparseClassify(benchmark::State& state) {
+    auto const& data = cached_sparse_set();
+    classifier::SparseModel model(data.dimension);
+    classifier::Result result;
+    std::size_t r = 0;
+    for (auto _ : state) {
+        model.classify(data.row(r), result);
+        benchmark::DoNotOptimize(result);
+        r = r + 1 == data.rows() ? 0 : r + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_SparseTrainEpoch)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SparseClassify);
@@ -0,0 +1,134 @@
+#include <cstddef>
+#include <map>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+#include <classifier/model.h>
+#include <classifier/trainer.h>
+
+#include "synthetic.h"
+
+namespace {
+
+template <std::size_t N>
+typename classifier::Trainer<N>::TrainingSet const& cached_training_set(std::size_t rows) {
+    static std::map<std::size_t, typename classifier::Trainer<N>::TrainingSet> cache;
+    auto it = cache.find(rows);
+    if (it == cache.end()) {
+        it = cache.emplace(rows, bench::make_training_set<N>(rows)).first;
+    }
+    return it->second;
+}
+
+// One iteration is one full-batch epoch, so items/s is rows per second and
+// iterations/s is epochs per second.
+template <std::size_t N>
+void BM_TrainEpoch(benchmark::State& state) {
+    auto const& data = cached_training_set<N>(static_cast<std::size_t>(state.range(0)));
+    classifier::Model<N> model;
+    classifier::Trainer<N> trainer(model);
+
+    for (auto _ : state) {
+        trainer.train(data, 0.1f, 1);
+        benchmark::DoNotOptimize(model);
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+    state.counters["epochs_per_second"] =
+        benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// One iteration is one Hogwild epoch over range(0) rows on range(1) threads;
+// compare against BM_TrainEpoch for the single-threaded baseline.
+template <std::size_t N>
+void BM_TrainHogwild(benchmark::State& state) {
+    auto const& data = cached_training_set<N>(static_cast<std::size_t>(state.range(0)));
+    classifier::Model<N> model;
+    classifier::Trainer<N> trainer(model);
+
+    classifier::HogwildOptions options;
+    options.epochs = 1;
+    options.threads = static_cast<std::size_t>(state.range(1));
+    for (auto _ : state) {
+        trainer.train_hogwild(data, options);
+        benchmark::DoNotOptimize(model);
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+    state.counters["threads"] = static_cast<double>(options.threads);
+}
+
+// BM_TrainHogwild on rows with range(1) of N features set, the sparse
+// updates Hogwild is meant for: threads rarely write the same weights, so
+// unlike the dense case throughput should keep scaling with range(2)
+// threads. Compare against range(2) = 1.
+template <std::size_t N>
+void BM_TrainHogwildSparse(benchmark::State& state) {
+    static std::map<std::pair<std::size_t, std::size_t>,
+                    typename classifier::Trainer<N>::TrainingSet> cache;
+    auto key = std::pair(static_cast<std::size_t>(state.range(0)),
+                         static_cast<std::size_t>(state.range(1)));
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, bench::make_low_density_training_set<N>(key.first, key.second))
+                 .first;
+    }
+    auto const& data = it->second;
+    classifier::Model<N> model;
+    classifier::Trainer<N> trainer(model);
+
+    classifier::HogwildOptions options;
+    options.epochs = 1;
+    options.threads = static_cast<std::size_t>(state.range(2));
+    for (auto _ : state) {
+        trainer.train_hogwild(data, options);
+        benchmark::DoNotOptimize(model);
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+    state.counters["threads"] = static_cast<double>(options.threads);
+}
+
+// One iteration is one mini-batch SGD epoch over range(0) rows; range(1)
+// selects no instrumentation (0) or a LossHistory observer (1), so the pair
+// shows what measuring the loss curve costs.
+template <std::size_t N>
+void BM_TrainSgdObserved(benchmark::State& state) {
+    auto const& data = cached_training_set<N>(static_cast<std::size_t>(state.range(0)));
+    classifier::Model<N> model;
+    classifier::Trainer<N> trainer(model);
+    classifier::GradientDescent optimizer;
+    classifier::LossHistory history;
+
+    classifier::SgdOptions options;
+    options.epochs = 1;
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            trainer.train_sgd(data, options, optimizer);
+        } else {
+            trainer.train_sgd(data, options, optimizer, history);
+        }
+        benchmark::DoNotOptimize(model);
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+} // namespace
+
+BENCHMARK(BM_TrainEpoch<4>)->RangeMultiplier(10)->Range(1'000, 10'000'000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TrainEpoch<16>)->RangeMultiplier(10)->Range(1'000, 1'000'000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TrainEpoch<128>)->RangeMultiplier(10)->Range(1'000, 100'000)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_TrainHogwild<4>)->ArgsProduct({{1'000'000}, {1, 2, 4, 8, 16, 32, 64}})
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TrainHogwild<128>)->ArgsProduct({{100'000}, {1, 2, 4, 8, 16, 32, 64}})
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_TrainHogwildSparse<512>)->ArgsProduct({{20'000}, {8}, {1, 2, 4, 8, 16, 32, 64}})
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_TrainSgdObserved<4>)->ArgsProduct({{100'000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TrainSgdObserved<128>)->ArgsProduct({{100'000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
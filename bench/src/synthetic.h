@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <classifier/model.h>
+#include <classifier/sparse_trainer.h>
+#include <classifier/trainer.h>
+
+namespace bench {
+
+// Linearly separable-ish data with label noise, deterministic for a given
+// seed so runs are comparable against a stored baseline.
+template <std::size_t N>
+typename classifier::Trainer<N>::TrainingSet make_training_set(std::size_t rows,
+                                                               std::uint64_t seed = 1) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<float> feature(0.0f, 1.0f);
+    std::uniform_real_distribution<float> noise(0.0f, 1.0f);
+
+    std::array<float, N> truth;
+    for (auto& w : truth) {
+        w = feature(rng);
+    }
+
+    typename classifier::Trainer<N>::TrainingSet data(rows);
+    for (auto& sample : data) {
+        float z = 0.0f;
+        for (std::size_t i = 0; i < N; ++i) {
+            sample[i] = feature(rng);
+            z += truth[i] * sample[i];
+        }
+        bool positive = z > 0.0f;
+        if (noise(rng) < 0.05f) {
+            positive = !positive;
+        }
+        sample[N] = positive ? 1.0f : 0.0f;
+    }
+    return data;
+}
+
+// The same, but with only `nnz` random features of each row set, so
+// trainers that skip zero features touch a few weights per sample.
+template <std::size_t N>
+typename classifier::Trainer<N>::TrainingSet make_low_density_training_set(
+    std::size_t rows, std::size_t nnz, std::uint64_t seed = 5) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<float> weight(0.0f, 1.0f);
+    std::array<float, N> truth;
+    for (auto& w : truth) {
+        w = weight(rng);
+    }
+
+    typename classifier::Trainer<N>::TrainingSet data(rows);
+    for (auto& sample : data) {
+        sample.fill(0.0f);
+        float z = 0.0f;
+        for (std::size_t k = 0; k < nnz; ++k) {
+            std::size_t i = rng() % N;
+            sample[i] = 1.0f;
+            z += truth[i];
+        }
+        sample[N] = z > 0.0f ? 1.0f : 0.0f;
+    }
+    return data;
+}
+
+template <std::size_t N>
+std::vector<float> make_features(std::size_t rows, std::uint64_t seed = 2) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<float> feature(0.0f, 1.0f);
+    std::vector<float> values(rows * N);
+    for (auto& v : values) {
+        v = feature(rng);
+    }
+    return values;
+}
+
+template <std::size_t N>
+classifier::Model<N> make_model(std::uint64_t seed = 3) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<float> weight(0.0f, 0.1f);
+    classifier::Model<N> model;
+    for (std::size_t i = 0; i < N; ++i) {
+        model.set_weight(i, weight(rng));
+    }
+    model.set_bias(weight(rng));
+    return model;
+}
+
+// CSR rows with `nnz` distinct-ish random indices out of `dimension`, all
+// values 1, labelled by the sign of a hidden weight vector.
+inline classifier::CsrTrainingSet make_sparse_training_set(std::size_t rows,
+                                                           std::uint32_t dimension,
+                                                           std::size_t nnz,
+                                                           std::uint64_t seed = 4) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<float> weight(0.0f, 1.0f);
+    std::vector<float> truth(dimension);
+    for (auto& w : truth) {
+        w = weight(rng);
+    }
+
+    classifier::CsrTrainingSet data;
+    data.dimension = dimension;
+    std::vector<classifier::SparseFeature> row(nnz);
+    for (std::size_t r = 0; r < rows; ++r) {
+        float z = 0.0f;
+        for (auto& feature : row) {
+            feature = {static_cast<std::uint32_t>(rng() % dimension), 1.0f};
+            z += truth[feature.index];
+        }
+        data.add_row(row, z > 0.0f ? 1.0f : 0.0f);
+    }
+    return data;
+}
+
+} // namespace bench
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+
+#include "classifier/aligned.h"
+
+namespace classifier {
+
+// Bump allocator over one block of memory, for request-scoped scratch space
+// and outputs. The block is either owned (allocated once, in the
+// constructor) or supplied by the caller; allocation never touches the heap
+// and fails by returning an empty span. Every allocation starts on a cache
+// line. Nothing is freed individually: rewind to a mark, or reset between
+// requests. One arena per thread.
+class Arena {
+public:
+    // Position to rewind to; allocations made after it are released together.
+    struct Mark {
+        std::size_t offset;
+    };
+
+    explicit Arena(std::size_t capacity)
+        : owned_(std::make_unique<Block[]>(blocks_for(capacity))),
+          data_(reinterpret_cast<std::byte*>(owned_.get())),
+          capacity_(blocks_for(capacity) * cache_line_size) {}
+
+    // Uses `storage` without taking ownership; it must outlive the arena.
+    explicit Arena(std::span<std::byte> storage) noexcept
+        : data_(storage.data()), capacity_(storage.size()) {}
+
+    Arena(Arena const&) = delete;
+    Arena& operator=(Arena const&) = delete;
+
+    // `count` default-initialized Ts (uninitialized for trivial types), or an
+    // empty span when the arena cannot fit them. Nothing is destroyed, hence
+    // the trivially destructible requirement.
+    template <typename T>
+        requires std::is_nothrow_default_constructible_v<T> && std::is_trivially_destructible_v<T>
+    std::span<T> allocate(std::size_t count) noexcept {
+        static_assert(alignof(T) <= cache_line_size);
+        auto base = reinterpret_cast<std::uintptr_t>(data_);
+        std::size_t begin = ((base + used_ + cache_line_size - 1) & ~(cache_line_size - 1)) - base;
+        if (begin > capacity_ || count > (capacity_ - begin) / sizeof(T)) {
+            return {};
+        }
+        used_ = begin + count * sizeof(T);
+        high_water_ = std::max(high_water_, used_);
+        T* first = reinterpret_cast<T*>(data_ + begin);
+        std::uninitialized_default_construct_n(first, count);
+        return {first, count};
+    }
+
+    Mark mark() const noexcept { return {used_}; }
+    void rewind(Mark mark) noexcept { used_ = std::min(used_, mark.offset); }
+    void reset() noexcept { used_ = 0; }
+
+    std::size_t used() const noexcept { return used_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+    // Peak usage since construction, for sizing the arena.
+    std::size_t high_water() const noexcept { return high_water_; }
+
+private:
+    struct alignas(cache_line_size) Block {
+        std::byte bytes[cache_line_size];
+    };
+
+    static std::size_t blocks_for(std::size_t bytes) noexcept {
+        return (bytes + cache_line_size - 1) / cache_line_size;
+    }
+
+    std::unique_ptr<Block[]> owned_;
+    std::byte* data_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t used_ = 0;
+    std::size_t high_water_ = 0;
+};
+
+} // namespace classifier
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "classifier/aligned.h"
+
+namespace classifier {
+
+// Structure-of-arrays training set: one column per feature plus a label
+// column, all in one allocation. Columns are padded to a multiple of 16
+// floats so every column starts on a cache line.
+template <std::size_t N>
+class ColumnarTrainingSet {
+public:
+    ColumnarTrainingSet() noexcept = default;
+
+    explicit ColumnarTrainingSet(std::size_t rows)
+        : rows_(rows), stride_((rows + 15) & ~std::size_t(15)), values_(stride_ * (N + 1), 0.0f) {}
+
+    static ColumnarTrainingSet from(std::span<std::array<float, N + 1> const> samples) {
+        ColumnarTrainingSet result(samples.size());
+        for (std::size_t c = 0; c <= N; ++c) {
+            float* column = result.values_.data() + c * result.stride_;
+            for (std::size_t r = 0; r < samples.size(); ++r) {
+                column[r] = samples[r][c];
+            }
+        }
+        return result;
+    }
+
+    std::size_t rows() const noexcept { return rows_; }
+    bool empty() const noexcept { return rows_ == 0; }
+
+    std::span<float const> feature(std::size_t index) const noexcept {
+        return {values_.data() + index * stride_, rows_};
+    }
+    std::span<float> feature(std::size_t index) noexcept {
+        return {values_.data() + index * stride_, rows_};
+    }
+
+    std::span<float const> labels() const noexcept { return feature(N); }
+    std::span<float> labels() noexcept { return feature(N); }
+
+private:
+    std::size_t rows_ = 0;
+    std::size_t stride_ = 0;
+    AlignedVector<float> values_;
+};
+
+} // namespace classifier
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/sigmoid.h"
+
+namespace classifier {
+
+// Model<N> with only its nonzero weights kept, as (index, value) pairs in
+// index order: the storage and scoring form for L1/FTRL-trained models whose
+// weights are mostly exactly zero. Scores match the dense model up to
+// floating-point summation order.
+template <std::size_t N, SigmoidPolicy Sigmoid = ExactSigmoid>
+class CompactModel {
+public:
+    CompactModel() noexcept = default;
+
+    explicit CompactModel(Model<N, Sigmoid> const& model) : bias_(model.bias()) {
+        for (std::size_t i = 0; i < N; ++i) {
+            if (model.weight(i) != 0.0f) {
+                indices_.push_back(static_cast<std::uint32_t>(i));
+                values_.push_back(model.weight(i));
+            }
+        }
+    }
+
+    Result classify(std::array<float, N> const& features) const noexcept {
+        if constexpr (N == 0) {
+            return {Prediction::unknown, 0.0f};
+        } else {
+            float z = bias_;
+            for (std::size_t j = 0; j < indices_.size(); ++j) {
+                z += values_[j] * features[indices_[j]];
+            }
+            float score = Sigmoid::apply(z);
+            if (score >= 0.5f) {
+                return {Prediction::positive, score};
+            }
+            return {Prediction::negative, 1.0f - score};
+        }
+    }
+
+    // Expands back into a dense model.
+    void to(Model<N, Sigmoid>& model) const noexcept {
+        for (std::size_t i = 0; i < N; ++i) {
+            model.set_weight(i, 0.0f);
+        }
+        for (std::size_t j = 0; j < indices_.size(); ++j) {
+            model.set_weight(indices_[j], values_[j]);
+        }
+        model.set_bias(bias_);
+    }
+
+    std::size_t nonzero_count() const noexcept { return indices_.size(); }
+    std::span<std::uint32_t const> indices() const noexcept { return indices_; }
+    std::span<float const> values() const noexcept { return values_; }
+    float bias() const noexcept { return bias_; }
+
+    // Layout: "CLCM" magic and version (uint32), N and the nonzero count
+    // (size_t), the indices (uint32), the values (float) and the bias.
+    Error serialize(std::ostream& os) const noexcept {
+        std::uint32_t header[2] = {magic, version};
+        std::size_t shape[2] = {N, indices_.size()};
+        os.write(reinterpret_cast<char const*>(header), sizeof(header));
+        os.write(reinterpret_cast<char const*>(shape), sizeof(shape));
+        os.write(reinterpret_cast<char const*>(indices_.data()),
+                 static_cast<std::streamsize>(sizeof(std::uint32_t) * indices_.size()));
+        os.write(reinterpret_cast<char const*>(values_.data()),
+                 static_cast<std::streamsize>(sizeof(float) * values_.size()));
+        os.write(reinterpret_cast<char const*>(&bias_), sizeof(bias_));
+        if (!os) {
+            return Error::io_failed;
+        }
+        return Error::none;
+    }
+
+    // Indices must be strictly increasing and below N.
+    Error deserialize(std::istream& is) noexcept {
+        std::uint32_t header[2] = {};
+        std::size_t shape[2] = {};
+        is.read(reinterpret_cast<char*>(header), sizeof(header));
+        is.read(reinterpret_cast<char*>(shape), sizeof(shape));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (header[0] != magic || header[1] != version) {
+            return Error::invalid_format;
+        }
+        if (shape[0] != N) {
+            return Error::dimension_mismatch;
+        }
+        if (shape[1] > N) {
+            return Error::invalid_format;
+        }
+
+        std::vector<std::uint32_t> indices(shape[1]);
+        std::vector<float> values(shape[1]);
+        float bias = 0.0f;
+        is.read(reinterpret_cast<char*>(indices.data()),
+                static_cast<std::streamsize>(sizeof(std::uint32_t) * indices.size()));
+        is.read(reinterpret_cast<char*>(values.data()),
+                static_cast<std::streamsize>(sizeof(float) * values.size()));
+        is.read(reinterpret_cast<char*>(&bias), sizeof(bias));
+        if (!is) {
+            return Error::io_failed;
+        }
+        for (std::size_t j = 0; j < indices.size(); ++j) {
+            if (indices[j] >= N || (j > 0 && indices[j] <= indices[j - 1])) {
+                return Error::invalid_format;
+            }
+        }
+
+        indices_ = std::move(indices);
+        values_ = std::move(values);
+        bias_ = bias;
+        return Error::none;
+    }
+
+private:
+    static constexpr std::uint32_t magic = 0x4d434c43; // "CLCM"
+    static constexpr std::uint32_t version = 1;
+
+    std::vector<std::uint32_t> indices_;
+    std::vector<float> values_;
+    float bias_ = 0.0f;
+};
+
+} // namespace classifier
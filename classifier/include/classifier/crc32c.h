@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "classifier/kernels.h"
+
+namespace classifier {
+
+namespace detail {
+
+// Reflected Castagnoli polynomial, as used by iSCSI, ext4 and SSE4.2 crc32.
+inline constexpr std::uint32_t crc32c_polynomial = 0x82f63b78u;
+
+constexpr std::array<std::uint32_t, 256> make_crc32c_table() noexcept {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (crc & 1u ? crc32c_polynomial : 0u);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+inline constexpr auto crc32c_table = make_crc32c_table();
+
+inline std::uint32_t crc32c_scalar(std::uint32_t crc, unsigned char const* p,
+                                   std::size_t size) noexcept {
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = (crc >> 8) ^ crc32c_table[(crc ^ p[i]) & 0xffu];
+    }
+    return crc;
+}
+
+#if CLASSIFIER_X86_DISPATCH
+
+__attribute__((target("sse4.2"))) inline std::uint32_t crc32c_sse42(std::uint32_t crc,
+                                                                    unsigned char const* p,
+                                                                    std::size_t size) noexcept {
+    std::size_t i = 0;
+#if defined(__x86_64__)
+    std::uint64_t c = crc;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        c = _mm_crc32_u64(c, word);
+    }
+    auto c32 = static_cast<std::uint32_t>(c);
+#else
+    // 32-bit x86 has no 64-bit crc32 instruction.
+    std::uint32_t c32 = crc;
+    for (; i + 4 <= size; i += 4) {
+        std::uint32_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        c32 = _mm_crc32_u32(c32, word);
+    }
+#endif
+    for (; i < size; ++i) {
+        c32 = _mm_crc32_u8(c32, p[i]);
+    }
+    return c32;
+}
+
+inline bool has_sse42() noexcept {
+    static bool const supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.2") != 0;
+    }();
+    return supported;
+}
+
+#endif
+
+} // namespace detail
+
+// CRC32C of `size` bytes, continuing from `crc` (the CRC of the bytes before
+// them, 0 for none).
+inline std::uint32_t crc32c(void const* data, std::size_t size, std::uint32_t crc = 0) noexcept {
+    auto const* p = static_cast<unsigned char const*>(data);
+    crc = ~crc;
+#if CLASSIFIER_X86_DISPATCH
+    if (detail::has_sse42()) {
+        return ~detail::crc32c_sse42(crc, p, size);
+    }
+#endif
+    return ~detail::crc32c_scalar(crc, p, size);
+}
+
+} // namespace classifier
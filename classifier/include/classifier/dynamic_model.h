@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <istream>
+#include <numeric>
+#include <ostream>
+#include <span>
+#include <utility>
+
+#include "classifier/aligned.h"
+#include "classifier/kernels.h"
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/stream_bounds.h"
+
+namespace classifier {
+
+namespace detail {
+
+// Calls fn.template operator()<N>() when n is one of Ns, and
+// fn.template operator()<std::dynamic_extent>() otherwise, so callers can
+// write one loop body that gets constant trip counts for the listed sizes.
+template <std::size_t... Ns, typename F>
+auto with_extent(std::size_t n, F&& fn) {
+    using R = decltype(fn.template operator()<std::dynamic_extent>());
+    R result{};
+    bool matched = ((n == Ns ? (result = fn.template operator()<Ns>(), true) : false) || ...);
+    if (!matched) {
+        result = fn.template operator()<std::dynamic_extent>();
+    }
+    return result;
+}
+
+} // namespace detail
+
+// Runtime-dimension counterpart of Model<N>, reading and writing the same
+// on-disk layout. Dimensions listed in Ns use fixed-size loops.
+template <std::size_t... Ns>
+class BasicDynamicModel {
+public:
+    BasicDynamicModel() noexcept : bias_(0.0f) {}
+    explicit BasicDynamicModel(std::size_t n) : weights_(n, 0.0f), bias_(0.0f) {}
+
+    template <std::size_t N>
+    static BasicDynamicModel from(Model<N> const& model) {
+        BasicDynamicModel result(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            result.weights_[i] = model.weight(i);
+        }
+        result.bias_ = model.bias();
+        return result;
+    }
+
+    template <std::size_t N>
+    Error to(Model<N>& model) const noexcept {
+        if (weights_.size() != N) {
+            return Error::dimension_mismatch;
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            model.set_weight(i, weights_[i]);
+        }
+        model.set_bias(bias_);
+        return Error::none;
+    }
+
+    Error classify(std::span<float const> features, Result& result) const noexcept {
+        if (features.size() != weights_.size()) {
+            return Error::size_mismatch;
+        }
+        if (weights_.empty()) {
+            result = {Prediction::unknown, 0.0f};
+            return Error::none;
+        }
+        float z = detail::with_extent<Ns...>(weights_.size(), [&]<std::size_t E>() {
+            if constexpr (E == std::dynamic_extent) {
+                return std::inner_product(weights_.begin(), weights_.end(), features.begin(),
+                                          0.0f);
+            } else {
+                return math::dot(std::span<float const, E>(weights_.data(), E),
+                                 std::span<float const, E>(features.data(), E));
+            }
+        });
+        float score = math::sigmoid(z + bias_);
+        if (score >= 0.5f) {
+            result = {Prediction::positive, score};
+        } else {
+            result = {Prediction::negative, 1.0f - score};
+        }
+        return Error::none;
+    }
+
+    Error score_batch(std::span<float const> features, std::span<float> scores) const noexcept {
+        if (features.size() != scores.size() * weights_.size()) {
+            return Error::size_mismatch;
+        }
+        if (weights_.empty()) {
+            std::fill(scores.begin(), scores.end(), 0.0f);
+        } else {
+            kernels::score_rows(weights_.data(), weights_.size(), bias_, features.data(),
+                                scores.size(), scores.data());
+        }
+        return Error::none;
+    }
+
+    float weight(std::size_t index) const noexcept { return weights_[index]; }
+    void set_weight(std::size_t index, float value) noexcept { weights_[index] = value; }
+    std::size_t weight_count() const noexcept { return weights_.size(); }
+    std::span<float const> weights() const noexcept { return weights_; }
+    std::span<float> weights() noexcept { return weights_; }
+
+    float bias() const noexcept { return bias_; }
+    void set_bias(float value) noexcept { bias_ = value; }
+
+    Error serialize(std::ostream& os) const noexcept {
+        std::size_t n = weights_.size();
+        os.write(reinterpret_cast<char const*>(&n), sizeof(n));
+        os.write(reinterpret_cast<char const*>(weights_.data()), sizeof(float) * n);
+        os.write(reinterpret_cast<char const*>(&bias_), sizeof(bias_));
+        if (!os) {
+            return Error::io_failed;
+        }
+        return Error::none;
+    }
+
+    Error deserialize(std::istream& is) noexcept {
+        std::size_t n = 0;
+        is.read(reinterpret_cast<char*>(&n), sizeof(n));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (!detail::fits_in_stream(is, n, sizeof(float))) {
+            return Error::io_failed;
+        }
+        AlignedVector<float> weights(n);
+        float bias = 0.0f;
+        is.read(reinterpret_cast<char*>(weights.data()), sizeof(float) * n);
+        is.read(reinterpret_cast<char*>(&bias), sizeof(bias));
+        if (!is) {
+            return Error::io_failed;
+        }
+        weights_ = std::move(weights);
+        bias_ = bias;
+        return Error::none;
+    }
+
+private:
+    AlignedVector<float> weights_;
+    float bias_;
+};
+
+// Dimensions that DynamicModel and DynamicTrainer compile fixed-size paths for.
+template <template <std::size_t...> class T>
+using WithDefaultDimensions = T<1, 2, 3, 4, 8, 16, 32, 64, 128>;
+
+using DynamicModel = WithDefaultDimensions<BasicDynamicModel>;
+
+} // namespace classifier
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <istream>
+#include <limits>
+#include <span>
+
+#include "classifier/aligned.h"
+#include "classifier/dynamic_model.h"
+#include "classifier/math.h"
+#include "classifier/stream_bounds.h"
+#include "classifier/trainer.h"
+
+namespace classifier {
+
+// Row-major samples of `cols` floats each, the label in the last column, in
+// the same layout deserialize_training_data reads from disk.
+struct DynamicTrainingSet {
+    std::size_t cols = 0;
+    AlignedVector<float> values;
+
+    std::size_t rows() const noexcept { return cols == 0 ? 0 : values.size() / cols; }
+    bool empty() const noexcept { return values.empty(); }
+    std::span<float const> row(std::size_t r) const noexcept {
+        return {values.data() + r * cols, cols};
+    }
+};
+
+template <std::size_t... Ns>
+class BasicDynamicTrainer {
+public:
+    explicit BasicDynamicTrainer(BasicDynamicModel<Ns...>& model) noexcept : model_(model) {}
+
+    static Error deserialize_training_data(std::istream& is, DynamicTrainingSet& out) noexcept {
+        std::size_t cols = 0;
+        is.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (cols == 0) {
+            return Error::dimension_mismatch;
+        }
+
+        std::size_t rows = 0;
+        is.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (rows > std::numeric_limits<std::size_t>::max() / sizeof(float) / cols ||
+            !detail::fits_in_stream(is, rows * cols, sizeof(float))) {
+            return Error::io_failed;
+        }
+
+        out.cols = cols;
+        out.values.resize(rows * cols);
+        is.read(reinterpret_cast<char*>(out.values.data()), sizeof(float) * rows * cols);
+        if (!is) {
+            return Error::io_failed;
+        }
+        return Error::none;
+    }
+
+    Error train(DynamicTrainingSet const& data, float learning_rate = 0.1f,
+                std::size_t epochs = 100,
+                Regularization regularization = Regularization::none,
+                float regularization_strength = 0.0f) noexcept {
+        if (data.empty()) {
+            return Error::empty_training_set;
+        }
+        if (data.cols != model_.weight_count() + 1) {
+            return Error::dimension_mismatch;
+        }
+        if (regularization_strength < 0.0f) {
+            return Error::invalid_regularization_strength;
+        }
+
+        return detail::with_extent<Ns...>(model_.weight_count(), [&]<std::size_t E>() {
+            train_epochs<E>(data, learning_rate, epochs, regularization, regularization_strength);
+            return Error::none;
+        });
+    }
+
+private:
+    // Mirrors Trainer<N>::train step for step; with E fixed the loops below
+    // have the same constant trip counts as the templated trainer.
+    template <std::size_t E>
+    void train_epochs(DynamicTrainingSet const& data, float learning_rate, std::size_t epochs,
+                      Regularization regularization, float regularization_strength) noexcept {
+        std::size_t const n = E == std::dynamic_extent ? model_.weight_count() : E;
+        std::size_t const rows = data.rows();
+        float* weights = model_.weights().data();
+        AlignedVector<float> weight_gradients(n);
+
+        for (std::size_t epoch = 0; epoch < epochs; ++epoch) {
+            std::fill(weight_gradients.begin(), weight_gradients.end(), 0.0f);
+            float bias_gradient = 0.0f;
+
+            for (std::size_t r = 0; r < rows; ++r) {
+                float const* sample = data.values.data() + r * data.cols;
+                float label = sample[n];
+
+                float z = 0.0f;
+                for (std::size_t i = 0; i < n; ++i) {
+                    z += weights[i] * sample[i];
+                }
+                z += model_.bias();
+
+                float error = math::sigmoid(z) - label;
+                for (std::size_t i = 0; i < n; ++i) {
+                    weight_gradients[i] += error * sample[i];
+                }
+                bias_gradient += error;
+            }
+
+            float m = static_cast<float>(rows);
+            for (std::size_t i = 0; i < n; ++i) {
+                float gradient = weight_gradients[i] / m;
+
+                if (regularization == Regularization::l2) {
+                    gradient += regularization_strength * weights[i];
+                } else if (regularization == Regularization::l1) {
+                    if (weights[i] > 0.0f) {
+                        gradient += regularization_strength;
+                    } else if (weights[i] < 0.0f) {
+                        gradient -= regularization_strength;
+                    }
+                }
+
+                weights[i] -= learning_rate * gradient;
+            }
+            model_.set_bias(model_.bias() - learning_rate * bias_gradient / m);
+        }
+    }
+
+    BasicDynamicModel<Ns...>& model_;
+};
+
+using DynamicTrainer = WithDefaultDimensions<BasicDynamicTrainer>;
+
+} // namespace classifier
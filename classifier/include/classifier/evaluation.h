@@ -0,0 +1,504 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "classifier/kernels.h"
+#include "classifier/kernels_fixed.h"
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/sigmoid.h"
+#include "classifier/thread_pool.h"
+#include "classifier/trainer.h"
+
+namespace classifier {
+
+struct EvaluationOptions {
+    // Rows whose probability is at or above this are predicted positive.
+    float threshold = 0.5f;
+    // Equal-width probability bins for the reliability curve.
+    std::size_t calibration_bins = 10;
+    // Largest absolute error allowed in the reported AUC. When the margin
+    // histogram alone cannot guarantee it, a second pass ranks the rows of
+    // the widest-open bins exactly; 0 does that for every mixed bin.
+    double auc_error = 1e-3;
+    // Rows read per chunk from a stream; two chunks are held at once.
+    std::size_t chunk_rows = 65536;
+    // 0 uses one thread per hardware thread.
+    std::size_t threads = 0;
+};
+
+struct CalibrationBin {
+    float lower;
+    float upper;
+    std::uint64_t count;
+    // Mean predicted probability and mean label of the rows in the bin; NaN
+    // when it is empty.
+    double mean_probability;
+    double mean_label;
+};
+
+// Labels above 0.5 count as positive for the ranking metrics. Precision,
+// recall and AUC are NaN when their denominator is empty.
+struct Evaluation {
+    std::uint64_t rows = 0;
+    std::uint64_t positives = 0;
+    double log_loss = 0.0;
+    double accuracy = 0.0;
+    double precision = 0.0;
+    double recall = 0.0;
+    double auc = 0.0;
+    // Worst-case distance between `auc` and the exact rank-sum AUC of the
+    // margins, at most EvaluationOptions::auc_error.
+    double auc_error = 0.0;
+    std::vector<CalibrationBin> calibration;
+    // Rows left out of `calibration` and the AUC because their margin was
+    // NaN, e.g. from a NaN feature. The other metrics still count them.
+    std::uint64_t unscored = 0;
+};
+
+namespace detail {
+
+// Order-preserving histogram of margins z = w.x + b. |z| is bucketed by its
+// float exponent and top mantissa_bits mantissa bits, so each bin spans
+// 1/256 of its magnitude; |z| below 2^min_exponent shares the middle bin
+// and from 2^max_exponent, where the sigmoid is saturated, the outer ones.
+// AUC only depends on the order of the margins, so the bins can be ranked
+// against each other exactly and only pairs within a bin are uncertain.
+class MarginHistogram {
+public:
+    static constexpr unsigned mantissa_bits = 8;
+    static constexpr int min_exponent = -16;
+    static constexpr int max_exponent = 7;
+    static constexpr std::size_t half = std::size_t(max_exponent - min_exponent) << mantissa_bits;
+    static constexpr std::size_t bin_count = 2 * half + 1;
+
+    MarginHistogram() : positives_(bin_count), negatives_(bin_count) {}
+
+    static std::size_t bin_of(float z) noexcept {
+        constexpr std::uint32_t low = std::uint32_t(127 + min_exponent) << 23;
+        std::uint32_t bits = std::bit_cast<std::uint32_t>(z) & 0x7fffffffu;
+        std::size_t offset = 0;
+        if (bits >= low) {
+            offset = std::min<std::size_t>(((bits - low) >> (23 - mantissa_bits)) + 1, half);
+        }
+        return z < 0.0f ? half - offset : half + offset;
+    }
+
+    void add(std::size_t bin, bool positive) noexcept {
+        ++(positive ? positives_ : negatives_)[bin];
+    }
+
+    void merge(MarginHistogram const& other) noexcept {
+        for (std::size_t b = 0; b < bin_count; ++b) {
+            positives_[b] += other.positives_[b];
+            negatives_[b] += other.negatives_[b];
+        }
+    }
+
+    std::uint64_t positives(std::size_t bin) const noexcept { return positives_[bin]; }
+    std::uint64_t negatives(std::size_t bin) const noexcept { return negatives_[bin]; }
+
+private:
+    std::vector<std::uint64_t> positives_;
+    std::vector<std::uint64_t> negatives_;
+};
+
+// One participant's running sums. Aligned so neighbours in a vector do not
+// share the cache line their counters live on.
+struct alignas(64) EvaluationTotals {
+    explicit EvaluationTotals(std::size_t calibration_bins)
+        : calibration_counts(calibration_bins), calibration_probabilities(calibration_bins),
+          calibration_labels(calibration_bins) {}
+
+    void merge(EvaluationTotals const& other) noexcept {
+        rows += other.rows;
+        positives += other.positives;
+        predicted_positives += other.predicted_positives;
+        true_positives += other.true_positives;
+        correct += other.correct;
+        unscored += other.unscored;
+        loss += other.loss;
+        for (std::size_t b = 0; b < calibration_counts.size(); ++b) {
+            calibration_counts[b] += other.calibration_counts[b];
+            calibration_probabilities[b] += other.calibration_probabilities[b];
+            calibration_labels[b] += other.calibration_labels[b];
+        }
+        margins.merge(other.margins);
+    }
+
+    std::uint64_t rows = 0;
+    std::uint64_t positives = 0;
+    std::uint64_t predicted_positives = 0;
+    std::uint64_t true_positives = 0;
+    std::uint64_t correct = 0;
+    std::uint64_t unscored = 0;
+    double loss = 0.0;
+    std::vector<std::uint64_t> calibration_counts;
+    std::vector<double> calibration_probabilities;
+    std::vector<double> calibration_labels;
+    MarginHistogram margins;
+};
+
+template <std::size_t N>
+using EvaluationSample = typename Trainer<N>::Sample;
+
+// Rows already in memory, handed over whole to each pass.
+template <std::size_t N>
+struct SampleSource {
+    template <typename F>
+    Error for_each_chunk(F&& fn) noexcept {
+        fn(samples);
+        return Error::none;
+    }
+
+    std::span<EvaluationSample<N> const> samples;
+};
+
+// A [cols][rows][floats...] stream positioned after its header. The first
+// pass reads on from there; later passes seek back to the first row, so only
+// they need a seekable stream. Each pass reads the next chunk on a second
+// thread while the current one is evaluated.
+template <std::size_t N>
+struct StreamSource {
+    template <typename F>
+    Error for_each_chunk(F&& fn) noexcept {
+        if (passes++ > 0) {
+            if (start == std::istream::pos_type(-1)) {
+                return Error::io_failed;
+            }
+            is.clear();
+            is.seekg(start);
+            if (!is) {
+                return Error::io_failed;
+            }
+        }
+        std::size_t count = std::min(chunk_rows, rows);
+        std::vector<EvaluationSample<N>> current(count);
+        std::vector<EvaluationSample<N>> next(count);
+        if (!read(current, count)) {
+            return Error::io_failed;
+        }
+        for (std::size_t done = 0; done < rows;) {
+            std::size_t next_count = std::min(chunk_rows, rows - done - count);
+            bool next_ok = true;
+            std::thread reader;
+            if (next_count > 0) {
+                reader = std::thread([&] { next_ok = read(next, next_count); });
+            }
+            fn(std::span<EvaluationSample<N> const>(current.data(), count));
+            if (reader.joinable()) {
+                reader.join();
+            }
+            if (!next_ok) {
+                return Error::io_failed;
+            }
+            done += count;
+            std::swap(current, next);
+            count = next_count;
+        }
+        return Error::none;
+    }
+
+    bool read(std::vector<EvaluationSample<N>>& buffer, std::size_t count) noexcept {
+        is.read(reinterpret_cast<char*>(buffer.data()),
+                static_cast<std::streamsize>(sizeof(EvaluationSample<N>) * count));
+        return static_cast<bool>(is);
+    }
+
+    std::istream& is;
+    std::istream::pos_type start;
+    std::size_t rows;
+    std::size_t chunk_rows;
+    std::size_t passes = 0;
+};
+
+// Margins of `count` rows of a sample block, row stride N + 1.
+template <std::size_t N, SigmoidPolicy Sigmoid>
+void margins(Model<N, Sigmoid> const& model, EvaluationSample<N> const* rows,
+             std::size_t count, float* out) noexcept {
+    float const* weights = model.weights().data();
+    for (std::size_t i = 0; i < count; ++i) {
+        if constexpr (N <= kernels::unroll_limit) {
+            out[i] = kernels::dot_fixed<N>(weights, rows[i].data()) + model.bias();
+        } else {
+            out[i] = kernels::dot(weights, rows[i].data(), N) + model.bias();
+        }
+    }
+}
+
+// Splits each chunk evenly over the pool's participants, each of which
+// calls fn(rows, t) on its slice.
+template <typename Source, typename F>
+Error parallel_pass(Source& source, ThreadPool& pool, F&& fn) noexcept {
+    return source.for_each_chunk([&](auto chunk) {
+        pool.run([&](std::size_t t) {
+            std::size_t begin = chunk.size() * t / pool.size();
+            std::size_t end = chunk.size() * (t + 1) / pool.size();
+            fn(chunk.subspan(begin, end - begin), t);
+        });
+    });
+}
+
+template <std::size_t N, SigmoidPolicy Sigmoid, typename Source>
+Error evaluate(Model<N, Sigmoid> const& model, Source& source, std::size_t rows,
+               EvaluationOptions const& options, Evaluation& result) noexcept {
+    if (rows == 0) {
+        return Error::empty_training_set;
+    }
+    if (options.calibration_bins == 0) {
+        return Error::invalid_bin_count;
+    }
+
+    std::size_t threads = options.threads == 0 ? ThreadPool::default_size() : options.threads;
+    ThreadPool pool(std::min(threads, rows));
+    std::vector<EvaluationTotals> totals;
+    totals.reserve(pool.size());
+    for (std::size_t t = 0; t < pool.size(); ++t) {
+        totals.emplace_back(options.calibration_bins);
+    }
+
+    std::size_t const bins = options.calibration_bins;
+    Error error = parallel_pass(source, pool, [&](auto slice, std::size_t t) {
+        EvaluationTotals& sums = totals[t];
+        float z[kernels::detail::block_rows];
+        float p[kernels::detail::block_rows];
+        float s[kernels::detail::block_rows];
+        for (std::size_t r = 0; r < slice.size(); r += std::size(z)) {
+            std::size_t count = std::min(std::size(z), slice.size() - r);
+            margins(model, slice.data() + r, count, z);
+            std::copy_n(z, count, p);
+            Sigmoid::apply_inplace(p, count);
+            // The log-loss max(z, 0) - z y + log1p(exp(-|z|)) with the last
+            // term summed over the block as -log of the product of
+            // sigmoid(|z|), each in [0.5, 1]: one log per block instead of
+            // an exp and a log1p per row, within 1e-6 per row.
+            for (std::size_t i = 0; i < count; ++i) {
+                s[i] = std::abs(z[i]);
+            }
+            kernels::sigmoid_inplace(s, count);
+            double linear = 0.0;
+            double product = 1.0;
+            for (std::size_t i = 0; i < count; ++i) {
+                float label = slice[r + i][N];
+                bool positive = label > 0.5f;
+                bool predicted = p[i] >= options.threshold;
+                sums.positives += positive;
+                sums.predicted_positives += predicted;
+                sums.true_positives += positive && predicted;
+                sums.correct += positive == predicted;
+                linear += std::max(z[i], 0.0f) - z[i] * label;
+                product *= s[i];
+                // NaN has no bin: converting it to an index is undefined, and
+                // it has no place in the margin order.
+                if (std::isnan(z[i]) || std::isnan(p[i])) {
+                    ++sums.unscored;
+                    continue;
+                }
+                auto bin = std::min(static_cast<std::size_t>(p[i] * static_cast<float>(bins)),
+                                    bins - 1);
+                ++sums.calibration_counts[bin];
+                sums.calibration_probabilities[bin] += p[i];
+                sums.calibration_labels[bin] += label;
+                sums.margins.add(MarginHistogram::bin_of(z[i]), positive);
+            }
+            sums.loss += linear - std::log(product);
+            sums.rows += count;
+        }
+    });
+    if (error != Error::none) {
+        return error;
+    }
+    for (std::size_t t = 1; t < totals.size(); ++t) {
+        totals[0].merge(totals[t]);
+    }
+    EvaluationTotals const& sums = totals[0];
+    MarginHistogram const& histogram = sums.margins;
+
+    auto ratio = [](double num, double den) {
+        return den == 0.0 ? std::numeric_limits<double>::quiet_NaN() : num / den;
+    };
+    double const n = static_cast<double>(sums.rows);
+    double const positives = static_cast<double>(sums.positives);
+    result.rows = sums.rows;
+    result.positives = sums.positives;
+    result.log_loss = sums.loss / n;
+    result.accuracy = static_cast<double>(sums.correct) / n;
+    result.precision = ratio(static_cast<double>(sums.true_positives),
+                             static_cast<double>(sums.predicted_positives));
+    result.recall = ratio(static_cast<double>(sums.true_positives), positives);
+    result.unscored = sums.unscored;
+    result.calibration.clear();
+    for (std::size_t b = 0; b < bins; ++b) {
+        double count = static_cast<double>(sums.calibration_counts[b]);
+        result.calibration.push_back({static_cast<float>(b) / static_cast<float>(bins),
+                                      static_cast<float>(b + 1) / static_cast<float>(bins),
+                                      sums.calibration_counts[b],
+                                      ratio(sums.calibration_probabilities[b], count),
+                                      ratio(sums.calibration_labels[b], count)});
+    }
+
+    // Pairs split across bins are ranked exactly; the positive-negative
+    // pairs inside a bin are counted as half-won, which is off by at most
+    // half of them. The bins holding the most such pairs are ranked exactly
+    // from a second pass until the rest fit in the error budget. Only the
+    // rows in the histogram take part, so unscored ones are left out.
+    double ranked_positives = 0.0;
+    double ranked_negatives = 0.0;
+    for (std::size_t b = 0; b < MarginHistogram::bin_count; ++b) {
+        ranked_positives += static_cast<double>(histogram.positives(b));
+        ranked_negatives += static_cast<double>(histogram.negatives(b));
+    }
+    double const pairs = ranked_positives * ranked_negatives;
+    if (pairs == 0.0) {
+        result.auc = std::numeric_limits<double>::quiet_NaN();
+        result.auc_error = 0.0;
+        return Error::none;
+    }
+    std::vector<std::size_t> open;
+    double slack = 0.0;
+    for (std::size_t b = 0; b < MarginHistogram::bin_count; ++b) {
+        if (histogram.positives(b) > 0 && histogram.negatives(b) > 0) {
+            open.push_back(b);
+            slack += 0.5 * static_cast<double>(histogram.positives(b)) *
+                     static_cast<double>(histogram.negatives(b)) / pairs;
+        }
+    }
+    auto mixed = [&](std::size_t b) {
+        return static_cast<double>(histogram.positives(b)) *
+               static_cast<double>(histogram.negatives(b));
+    };
+    std::sort(open.begin(), open.end(),
+              [&](std::size_t a, std::size_t b) { return mixed(a) > mixed(b); });
+    std::vector<bool> refine(MarginHistogram::bin_count, false);
+    std::size_t refined = 0;
+    for (; refined < open.size() && slack > options.auc_error; ++refined) {
+        refine[open[refined]] = true;
+        slack -= 0.5 * mixed(open[refined]) / pairs;
+    }
+    slack = refined == open.size() ? 0.0 : std::max(slack, 0.0);
+
+    // Wins within each refined bin, from the exact margins of its rows.
+    std::vector<double> exact_wins(MarginHistogram::bin_count, 0.0);
+    if (refined > 0) {
+        std::vector<std::vector<std::pair<float, bool>>> scored(pool.size());
+        error = parallel_pass(source, pool, [&](auto slice, std::size_t t) {
+            float z[kernels::detail::block_rows];
+            for (std::size_t r = 0; r < slice.size(); r += std::size(z)) {
+                std::size_t count = std::min(std::size(z), slice.size() - r);
+                margins(model, slice.data() + r, count, z);
+                for (std::size_t i = 0; i < count; ++i) {
+                    if (!std::isnan(z[i]) && refine[MarginHistogram::bin_of(z[i])]) {
+                        scored[t].emplace_back(z[i], slice[r + i][N] > 0.5f);
+                    }
+                }
+            }
+        });
+        if (error != Error::none) {
+            return error;
+        }
+        for (std::size_t t = 1; t < scored.size(); ++t) {
+            scored[0].insert(scored[0].end(), scored[t].begin(), scored[t].end());
+        }
+        auto& all = scored[0];
+        std::sort(all.begin(), all.end(),
+                  [](auto const& a, auto const& b) { return a.first < b.first; });
+        double below = 0.0;
+        std::size_t current = MarginHistogram::bin_count;
+        for (std::size_t i = 0; i < all.size();) {
+            std::size_t bin = MarginHistogram::bin_of(all[i].first);
+            if (bin != current) {
+                current = bin;
+                below = 0.0;
+            }
+            std::size_t j = i;
+            double tied_positives = 0.0;
+            double tied_negatives = 0.0;
+            for (; j < all.size() && all[j].first == all[i].first; ++j) {
+                (all[j].second ? tied_positives : tied_negatives) += 1.0;
+            }
+            exact_wins[bin] += tied_positives * (below + 0.5 * tied_negatives);
+            below += tied_negatives;
+            i = j;
+        }
+    }
+
+    double wins = 0.0;
+    double below = 0.0;
+    for (std::size_t b = 0; b < MarginHistogram::bin_count; ++b) {
+        double bin_positives = static_cast<double>(histogram.positives(b));
+        double bin_negatives = static_cast<double>(histogram.negatives(b));
+        wins += bin_positives * below;
+        wins += refine[b] ? exact_wins[b] : 0.5 * bin_positives * bin_negatives;
+        below += bin_negatives;
+    }
+    result.auc = wins / pairs;
+    result.auc_error = slack;
+    return Error::none;
+}
+
+} // namespace detail
+
+// Log-loss, accuracy, precision and recall at a threshold, ROC AUC and a
+// calibration table for `model` over labelled rows, in one parallel pass
+// (two if the AUC needs refining). Each participant keeps its own sums and
+// margin histogram, merged at the end, so memory does not grow with the row
+// count apart from the rows of refined AUC bins. MappedTrainingData rows
+// can be passed as samples().
+template <std::size_t N, SigmoidPolicy Sigmoid>
+Error evaluate(Model<N, Sigmoid> const& model,
+               std::span<typename Trainer<N>::Sample const> data,
+               EvaluationOptions const& options, Evaluation& result) noexcept {
+    detail::SampleSource<N> source{data};
+    return detail::evaluate(model, source, data.size(), options, result);
+}
+
+// The same over a [cols][rows][floats...] stream, the layout
+// Trainer::deserialize_training_data and StreamingTrainer read, holding two
+// chunks of options.chunk_rows rows at a time. The stream is read once from
+// its current position; only when the AUC needs refining is it read a second
+// time, and then it must be seekable or evaluate() returns io_failed.
+template <std::size_t N, SigmoidPolicy Sigmoid>
+Error evaluate(Model<N, Sigmoid> const& model, std::istream& is,
+               EvaluationOptions const& options, Evaluation& result) noexcept {
+    if (options.chunk_rows == 0) {
+        return Error::invalid_batch_size;
+    }
+    std::size_t cols = 0;
+    is.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+    if (!is) {
+        return Error::io_failed;
+    }
+    if (cols != N + 1) {
+        return Error::dimension_mismatch;
+    }
+    std::size_t rows = 0;
+    is.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+    if (!is) {
+        return Error::io_failed;
+    }
+    detail::StreamSource<N> source{is, is.tellg(), rows, options.chunk_rows};
+    return detail::evaluate(model, source, rows, options, result);
+}
+
+template <std::size_t N, SigmoidPolicy Sigmoid>
+Error evaluate(Model<N, Sigmoid> const& model, char const* path,
+               EvaluationOptions const& options, Evaluation& result) noexcept {
+    std::ifstream is(path, std::ios::binary);
+    if (!is) {
+        return Error::io_failed;
+    }
+    return evaluate(model, is, options, result);
+}
+
+} // namespace classifier
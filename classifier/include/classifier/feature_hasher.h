@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "classifier/kernels.h"
+#include "classifier/kernels_hash.h"
+#include "classifier/math.h"
+
+namespace classifier {
+
+struct KeyFeature {
+    std::uint64_t key;
+    float value;
+};
+
+struct StringFeature {
+    std::string_view name;
+    float value;
+};
+
+template <typename F>
+concept HashableFeature = std::same_as<F, KeyFeature> || std::same_as<F, StringFeature>;
+
+// A span, vector, array or any other contiguous run of one feature type.
+template <typename R>
+concept FeatureRange = std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&
+                       HashableFeature<std::ranges::range_value_t<R>>;
+
+// Signed feature hashing into N buckets: each feature adds +value or -value
+// to one bucket, both chosen by a seeded 64-bit hash, so collisions cancel in
+// expectation instead of biasing the bucket. Integer keys are hashed a block
+// at a time with the vectorized kernel, then scattered. Nothing allocates; output
+// goes straight into the arrays Model<N> and Trainer<N> take.
+template <std::size_t N>
+class FeatureHasher {
+public:
+    static_assert(N > 0 && N <= std::numeric_limits<std::uint32_t>::max());
+
+    using Sample = std::array<float, N + 1>;
+
+    explicit FeatureHasher(std::uint64_t seed = 0) noexcept : seed_(seed) {}
+
+    std::uint64_t seed() const noexcept { return seed_; }
+
+    // Overwrites `out` with the hashed features.
+    template <FeatureRange R>
+    void hash(R const& features, std::span<float, N> out) const noexcept {
+        std::fill(out.begin(), out.end(), 0.0f);
+        accumulate(std::ranges::data(features), std::ranges::size(features), out.data());
+    }
+
+    // Fills a training sample in place: the hashed features and the label.
+    template <FeatureRange R>
+    void hash_sample(R const& features, float label, Sample& out) const noexcept {
+        hash(features, std::span<float, N>(out.data(), N));
+        out[N] = label;
+    }
+
+    // Row r is features[offsets[r], offsets[r + 1]); writes offsets.size() - 1
+    // row-major rows of N to `out`, ready for Model<N>::classify_batch.
+    template <FeatureRange R>
+    Error hash_batch(R const& range, std::span<std::size_t const> offsets,
+                     std::span<float> out) const noexcept {
+        std::span features(std::ranges::data(range), std::ranges::size(range));
+        if (offsets.empty() || offsets.front() != 0 || offsets.back() > features.size() ||
+            out.size() != (offsets.size() - 1) * N) {
+            return Error::size_mismatch;
+        }
+        for (std::size_t r = 1; r < offsets.size(); ++r) {
+            if (offsets[r] < offsets[r - 1]) {
+                return Error::size_mismatch;
+            }
+        }
+
+        std::fill(out.begin(), out.end(), 0.0f);
+        kernels::HashSlot slots[block];
+        std::size_t row = 0;
+        for (std::size_t begin = 0; begin < offsets.back(); begin += block) {
+            std::size_t count = std::min(block, offsets.back() - begin);
+            hash_block(features.data() + begin, count, slots);
+            for (std::size_t i = 0; i < count; ++i) {
+                while (offsets[row + 1] <= begin + i) {
+                    ++row;
+                }
+                scatter(slots[i], features[begin + i].value, out.data() + row * N);
+            }
+        }
+        return Error::none;
+    }
+
+private:
+    static constexpr std::size_t block = 256;
+
+    template <typename F>
+    void accumulate(F const* features, std::size_t count, float* out) const noexcept {
+        kernels::HashSlot slots[block];
+        for (std::size_t begin = 0; begin < count; begin += block) {
+            std::size_t len = std::min(block, count - begin);
+            hash_block(features + begin, len, slots);
+            for (std::size_t i = 0; i < len; ++i) {
+                scatter(slots[i], features[begin + i].value, out);
+            }
+        }
+    }
+
+    template <typename F>
+    void hash_block(F const* features, std::size_t count, kernels::HashSlot* out) const noexcept {
+        if constexpr (std::is_same_v<F, KeyFeature>) {
+            // The kernel reads contiguous keys, so gather them first; count
+            // never exceeds block.
+            std::uint64_t keys[block];
+            for (std::size_t i = 0; i < count; ++i) {
+                keys[i] = features[i].key;
+            }
+            kernels::hash_keys(keys, count, seed_, static_cast<std::uint32_t>(N), out);
+        } else {
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = kernels::slot(kernels::hash_string(features[i].name, seed_),
+                                       static_cast<std::uint32_t>(N));
+            }
+        }
+    }
+
+    static void scatter(kernels::HashSlot slot, float value, float* row) noexcept {
+        row[slot.bucket] += std::bit_cast<float>(std::bit_cast<std::uint32_t>(value) ^ slot.sign);
+    }
+
+    std::uint64_t seed_;
+};
+
+} // namespace classifier
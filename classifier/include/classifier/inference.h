@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+
+#include "classifier/arena.h"
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/multiclass_model.h"
+#include "classifier/sigmoid.h"
+
+namespace classifier {
+
+// Request-scoped inference: every output and every piece of scratch space
+// comes from a caller-owned Arena, so none of these calls touch the heap.
+// Outputs stay valid until the arena is rewound or reset. A full arena is
+// reported as Error::arena_exhausted, with the arena left as it was.
+
+// One feature's share of the logit, weight(index) * x[index].
+struct Contribution {
+    std::size_t index;
+    float value;
+};
+
+// A prediction and its largest contributions by magnitude, largest first.
+struct Explanation {
+    Result result;
+    std::span<Contribution const> contributions;
+};
+
+namespace detail {
+
+template <std::size_t N>
+bool row_count(std::span<float const> features, std::size_t& rows) noexcept {
+    static_assert(N > 0, "rows of zero features cannot be counted");
+    rows = features.size() / N;
+    return rows * N == features.size();
+}
+
+// Writes the k largest |weight(i) * x[i]| of one row to `out`, using
+// `scratch` (N entries) for the ranking. Ties go to the lower index.
+template <std::size_t N, SigmoidPolicy Sigmoid>
+void top_contributions(Model<N, Sigmoid> const& model, float const* x,
+                       std::span<Contribution> scratch, std::span<Contribution> out) noexcept {
+    for (std::size_t i = 0; i < N; ++i) {
+        scratch[i] = {i, model.weight(i) * x[i]};
+    }
+    auto larger = [](Contribution const& a, Contribution const& b) {
+        float ma = std::abs(a.value);
+        float mb = std::abs(b.value);
+        return ma != mb ? ma > mb : a.index < b.index;
+    };
+    auto middle = scratch.begin() + static_cast<std::ptrdiff_t>(out.size());
+    std::partial_sort(scratch.begin(), middle, scratch.end(), larger);
+    std::copy(scratch.begin(), middle, out.begin());
+}
+
+} // namespace detail
+
+// Positive-class probabilities of each row of N features.
+template <std::size_t N, SigmoidPolicy Sigmoid>
+Error score_batch(Model<N, Sigmoid> const& model, std::span<float const> features, Arena& arena,
+                  std::span<float>& scores) noexcept {
+    std::size_t rows = 0;
+    if (!detail::row_count<N>(features, rows)) {
+        return Error::size_mismatch;
+    }
+    auto out = arena.allocate<float>(rows);
+    if (out.size() != rows) {
+        return Error::arena_exhausted;
+    }
+    model.score_batch(features, out);
+    scores = out;
+    return Error::none;
+}
+
+template <std::size_t N, SigmoidPolicy Sigmoid>
+Error classify_batch(Model<N, Sigmoid> const& model, std::span<float const> features, Arena& arena,
+                     std::span<Result>& results) noexcept {
+    std::size_t rows = 0;
+    if (!detail::row_count<N>(features, rows)) {
+        return Error::size_mismatch;
+    }
+    auto out = arena.allocate<Result>(rows);
+    if (out.size() != rows) {
+        return Error::arena_exhausted;
+    }
+    model.classify_batch(features, out);
+    results = out;
+    return Error::none;
+}
+
+// The prediction for each row of N features with its top min(k, N)
+// contributions. The ranking scratch space is taken from the arena after the
+// outputs and handed back before returning.
+template <std::size_t N, SigmoidPolicy Sigmoid>
+Error explain_batch(Model<N, Sigmoid> const& model, std::span<float const> features,
+                    std::size_t k, Arena& arena, std::span<Explanation>& explanations) noexcept {
+    std::size_t rows = 0;
+    if (!detail::row_count<N>(features, rows)) {
+        return Error::size_mismatch;
+    }
+    k = std::min(k, N);
+
+    Arena::Mark start = arena.mark();
+    auto out = arena.allocate<Explanation>(rows);
+    auto contributions = arena.allocate<Contribution>(rows * k);
+    Arena::Mark scratch_start = arena.mark();
+    auto scratch = arena.allocate<Contribution>(N);
+    if (out.size() != rows || contributions.size() != rows * k || scratch.size() != N) {
+        arena.rewind(start);
+        return Error::arena_exhausted;
+    }
+
+    for (std::size_t r = 0; r < rows; ++r) {
+        auto row = features.subspan(r * N, N);
+        auto top = contributions.subspan(r * k, k);
+        model.classify_batch(row, std::span(&out[r].result, 1));
+        detail::top_contributions(model, row.data(), scratch, top);
+        out[r].contributions = top;
+    }
+    arena.rewind(scratch_start);
+    explanations = out;
+    return Error::none;
+}
+
+// explain_batch() for a single row.
+template <std::size_t N, SigmoidPolicy Sigmoid>
+Error explain(Model<N, Sigmoid> const& model, std::array<float, N> const& features, std::size_t k,
+              Arena& arena, Explanation& explanation) noexcept {
+    std::span<Explanation> out;
+    if (Error error = explain_batch(model, features, k, arena, out); error != Error::none) {
+        return error;
+    }
+    explanation = out[0];
+    return Error::none;
+}
+
+template <std::size_t K, std::size_t N>
+Error classify_batch(MulticlassModel<K, N> const& model, std::span<float const> features,
+                     Arena& arena, std::span<MulticlassResult>& results) noexcept {
+    std::size_t rows = 0;
+    if (!detail::row_count<N>(features, rows)) {
+        return Error::size_mismatch;
+    }
+    auto out = arena.allocate<MulticlassResult>(rows);
+    if (out.size() != rows) {
+        return Error::arena_exhausted;
+    }
+    model.classify_batch(features, out);
+    results = out;
+    return Error::none;
+}
+
+// Row-major rows x K class probabilities.
+template <std::size_t K, std::size_t N>
+Error probabilities_batch(MulticlassModel<K, N> const& model, std::span<float const> features,
+                          Arena& arena, std::span<float>& probabilities) noexcept {
+    std::size_t rows = 0;
+    if (!detail::row_count<N>(features, rows)) {
+        return Error::size_mismatch;
+    }
+    auto out = arena.allocate<float>(rows * K);
+    if (out.size() != rows * K) {
+        return Error::arena_exhausted;
+    }
+    for (std::size_t r = 0; r < rows; ++r) {
+        model.probabilities(features.subspan(r * N).template first<N>(),
+                            out.subspan(r * K).template first<K>());
+    }
+    probabilities = out;
+    return Error::none;
+}
+
+} // namespace classifier
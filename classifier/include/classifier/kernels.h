@@ -0,0 +1,709 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+
+#include "classifier/math.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CLASSIFIER_X86_DISPATCH 1
+#include <immintrin.h>
+#define CLASSIFIER_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define CLASSIFIER_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#else
+#define CLASSIFIER_X86_DISPATCH 0
+#endif
+
+namespace classifier::kernels {
+
+enum class Isa { scalar, avx2, avx512 };
+
+inline Isa detect_isa() noexcept {
+#if CLASSIFIER_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") &&
+        __builtin_cpu_supports("fma")) {
+        return Isa::avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return Isa::avx2;
+    }
+#endif
+    return Isa::scalar;
+}
+
+inline Isa active_isa() noexcept {
+    static Isa const isa = detect_isa();
+    return isa;
+}
+
+namespace detail {
+
+// Rows are scored in blocks small enough that the linear outputs are still in
+// L1 when the sigmoid pass runs over them.
+inline constexpr std::size_t block_rows = 256;
+
+inline void linear_rows_scalar(float const* weights, std::size_t n, float bias,
+                               float const* rows, std::size_t count, float* out) noexcept {
+    for (std::size_t r = 0; r < count; ++r) {
+        float const* row = rows + r * n;
+        out[r] = std::inner_product(weights, weights + n, row, 0.0f) + bias;
+    }
+}
+
+inline void sigmoid_scalar(float* values, std::size_t count) noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] = math::sigmoid(values[i]);
+    }
+}
+
+inline void linear_classes_scalar(float const* weights, std::size_t ldk, std::size_t n,
+                                  float const* bias, float const* x, float* out) noexcept {
+    std::copy(bias, bias + ldk, out);
+    for (std::size_t i = 0; i < n; ++i) {
+        float const* row = weights + i * ldk;
+        for (std::size_t c = 0; c < ldk; ++c) {
+            out[c] += x[i] * row[c];
+        }
+    }
+}
+
+inline void linear_classes_rows_scalar(float const* weights, std::size_t ldk, std::size_t n,
+                                       float const* bias, float const* rows, std::size_t count,
+                                       std::size_t columns, float* out,
+                                       std::size_t ldo) noexcept {
+    for (std::size_t r = 0; r < count; ++r) {
+        float const* x = rows + r * n;
+        float* y = out + r * ldo;
+        std::copy(bias, bias + columns, y);
+        for (std::size_t i = 0; i < n; ++i) {
+            float const* row = weights + i * ldk;
+            for (std::size_t c = 0; c < columns; ++c) {
+                y[c] += x[i] * row[c];
+            }
+        }
+    }
+}
+
+#if CLASSIFIER_X86_DISPATCH
+
+// Cephes-style expf: range reduction to [-ln2/2, ln2/2] followed by a degree-5
+// polynomial, relative error around 2 ulp over the clamped input range.
+CLASSIFIER_TARGET_AVX2 inline __m256 exp_avx2(__m256 x) noexcept {
+    __m256 const hi = _mm256_set1_ps(88.3762626647949f);
+    __m256 const lo = _mm256_set1_ps(-88.3762626647949f);
+    __m256 const log2e = _mm256_set1_ps(1.44269504088896341f);
+    __m256 const c1 = _mm256_set1_ps(0.693359375f);
+    __m256 const c2 = _mm256_set1_ps(-2.12194440e-4f);
+
+    // max/min return their second operand when either is NaN, so x goes
+    // second to keep a NaN input NaN, as in the scalar path.
+    x = _mm256_min_ps(hi, _mm256_max_ps(lo, x));
+    __m256 fx = _mm256_floor_ps(_mm256_fmadd_ps(x, log2e, _mm256_set1_ps(0.5f)));
+    x = _mm256_fnmadd_ps(fx, c1, x);
+    x = _mm256_fnmadd_ps(fx, c2, x);
+
+    __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.3981999507e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(8.3334519073e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(4.1665795894e-2f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.6666665459e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(5.0000001201e-1f));
+    y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+    __m256i n = _mm256_cvttps_epi32(fx);
+    n = _mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(n));
+}
+
+CLASSIFIER_TARGET_AVX2 inline __m256 sigmoid_avx2(__m256 x) noexcept {
+    __m256 const one = _mm256_set1_ps(1.0f);
+    __m256 e = exp_avx2(_mm256_sub_ps(_mm256_setzero_ps(), x));
+    return _mm256_div_ps(one, _mm256_add_ps(one, e));
+}
+
+CLASSIFIER_TARGET_AVX2 inline void sigmoid_avx2(float* values, std::size_t count) noexcept {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(values + i, sigmoid_avx2(_mm256_loadu_ps(values + i)));
+    }
+    sigmoid_scalar(values + i, count - i);
+}
+
+// 0.5 + 0.5 * tanh(x / 2) with the [7/6] continued-fraction tanh, clamped
+// where the approximation crosses +-1. See RationalSigmoid for the error bound.
+CLASSIFIER_TARGET_AVX2 inline void sigmoid_rational_avx2(float* values, std::size_t count) noexcept {
+    __m256 const limit = _mm256_set1_ps(4.97f);
+    __m256 const half = _mm256_set1_ps(0.5f);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 t = _mm256_mul_ps(_mm256_loadu_ps(values + i), half);
+        t = _mm256_min_ps(limit, _mm256_max_ps(_mm256_sub_ps(_mm256_setzero_ps(), limit), t));
+        __m256 t2 = _mm256_mul_ps(t, t);
+        __m256 p = _mm256_add_ps(t2, _mm256_set1_ps(378.0f));
+        p = _mm256_fmadd_ps(p, t2, _mm256_set1_ps(17325.0f));
+        p = _mm256_fmadd_ps(p, t2, _mm256_set1_ps(135135.0f));
+        p = _mm256_mul_ps(p, t);
+        __m256 q = _mm256_fmadd_ps(t2, _mm256_set1_ps(28.0f), _mm256_set1_ps(3150.0f));
+        q = _mm256_fmadd_ps(q, t2, _mm256_set1_ps(62370.0f));
+        q = _mm256_fmadd_ps(q, t2, _mm256_set1_ps(135135.0f));
+        _mm256_storeu_ps(values + i, _mm256_fmadd_ps(_mm256_div_ps(p, q), half, half));
+    }
+    for (; i < count; ++i) {
+        values[i] = math::sigmoid_rational(values[i]);
+    }
+}
+
+CLASSIFIER_TARGET_AVX2 inline __m256i tail_mask_avx2(std::size_t remaining) noexcept {
+    __m256i const lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(remaining)), lanes);
+}
+
+// Horizontal sums of eight accumulators, lane r of the result holding the sum
+// of acc[r].
+CLASSIFIER_TARGET_AVX2 inline __m256 reduce8_avx2(__m256 const* acc) noexcept {
+    __m256 s01 = _mm256_hadd_ps(acc[0], acc[1]);
+    __m256 s23 = _mm256_hadd_ps(acc[2], acc[3]);
+    __m256 s45 = _mm256_hadd_ps(acc[4], acc[5]);
+    __m256 s67 = _mm256_hadd_ps(acc[6], acc[7]);
+    __m256 s0123 = _mm256_hadd_ps(s01, s23);
+    __m256 s4567 = _mm256_hadd_ps(s45, s67);
+    return _mm256_add_ps(_mm256_permute2f128_ps(s0123, s4567, 0x20),
+                         _mm256_permute2f128_ps(s0123, s4567, 0x31));
+}
+
+CLASSIFIER_TARGET_AVX2 inline float reduce1_avx2(__m256 v) noexcept {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+template <bool ApplySigmoid>
+CLASSIFIER_TARGET_AVX2 void rows_avx2(float const* weights, std::size_t n, float bias,
+                                      float const* rows, std::size_t count,
+                                      float* out) noexcept {
+    std::size_t const full = n & ~std::size_t(7);
+    __m256i const mask = tail_mask_avx2(n - full);
+    __m256 const b = _mm256_set1_ps(bias);
+
+    std::size_t r = 0;
+    for (; r + 8 <= count; r += 8) {
+        float const* x0 = rows + r * n;
+        float const* x1 = x0 + n;
+        float const* x2 = x1 + n;
+        float const* x3 = x2 + n;
+        float const* x4 = x3 + n;
+        float const* x5 = x4 + n;
+        float const* x6 = x5 + n;
+        float const* x7 = x6 + n;
+        __m256 acc[8] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(),
+                         _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(),
+                         _mm256_setzero_ps(), _mm256_setzero_ps()};
+        std::size_t k = 0;
+        for (; k < full; k += 8) {
+            __m256 w = _mm256_loadu_ps(weights + k);
+            acc[0] = _mm256_fmadd_ps(w, _mm256_loadu_ps(x0 + k), acc[0]);
+            acc[1] = _mm256_fmadd_ps(w, _mm256_loadu_ps(x1 + k), acc[1]);
+            acc[2] = _mm256_fmadd_ps(w, _mm256_loadu_ps(x2 + k), acc[2]);
+            acc[3] = _mm256_fmadd_ps(w, _mm256_loadu_ps(x3 + k), acc[3]);
+            acc[4] = _mm256_fmadd_ps(w, _mm256_loadu_ps(x4 + k), acc[4]);
+            acc[5] = _mm256_fmadd_ps(w, _mm256_loadu_ps(x5 + k), acc[5]);
+            acc[6] = _mm256_fmadd_ps(w, _mm256_loadu_ps(x6 + k), acc[6]);
+            acc[7] = _mm256_fmadd_ps(w, _mm256_loadu_ps(x7 + k), acc[7]);
+        }
+        if (k < n) {
+            __m256 w = _mm256_maskload_ps(weights + k, mask);
+            acc[0] = _mm256_fmadd_ps(w, _mm256_maskload_ps(x0 + k, mask), acc[0]);
+            acc[1] = _mm256_fmadd_ps(w, _mm256_maskload_ps(x1 + k, mask), acc[1]);
+            acc[2] = _mm256_fmadd_ps(w, _mm256_maskload_ps(x2 + k, mask), acc[2]);
+            acc[3] = _mm256_fmadd_ps(w, _mm256_maskload_ps(x3 + k, mask), acc[3]);
+            acc[4] = _mm256_fmadd_ps(w, _mm256_maskload_ps(x4 + k, mask), acc[4]);
+            acc[5] = _mm256_fmadd_ps(w, _mm256_maskload_ps(x5 + k, mask), acc[5]);
+            acc[6] = _mm256_fmadd_ps(w, _mm256_maskload_ps(x6 + k, mask), acc[6]);
+            acc[7] = _mm256_fmadd_ps(w, _mm256_maskload_ps(x7 + k, mask), acc[7]);
+        }
+        __m256 z = _mm256_add_ps(reduce8_avx2(acc), b);
+        if constexpr (ApplySigmoid) {
+            z = sigmoid_avx2(z);
+        }
+        _mm256_storeu_ps(out + r, z);
+    }
+
+    for (; r < count; ++r) {
+        float const* row = rows + r * n;
+        __m256 acc = _mm256_setzero_ps();
+        std::size_t k = 0;
+        for (; k < full; k += 8) {
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(weights + k), _mm256_loadu_ps(row + k), acc);
+        }
+        if (k < n) {
+            acc = _mm256_fmadd_ps(_mm256_maskload_ps(weights + k, mask),
+                                  _mm256_maskload_ps(row + k, mask), acc);
+        }
+        float z = reduce1_avx2(acc) + bias;
+        out[r] = ApplySigmoid ? math::sigmoid(z) : z;
+    }
+}
+
+CLASSIFIER_TARGET_AVX512 inline __m256 fold_avx512(__m512 v) noexcept {
+    __m256 lo = _mm512_castps512_ps256(v);
+    __m256 hi = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1));
+    return _mm256_add_ps(lo, hi);
+}
+
+template <bool ApplySigmoid>
+CLASSIFIER_TARGET_AVX512 void rows_avx512(float const* weights, std::size_t n, float bias,
+                                          float const* rows, std::size_t count,
+                                          float* out) noexcept {
+    std::size_t const full = n & ~std::size_t(15);
+    __mmask16 const mask = static_cast<__mmask16>((1u << (n - full)) - 1u);
+    __m256 const b = _mm256_set1_ps(bias);
+
+    std::size_t r = 0;
+    for (; r + 8 <= count; r += 8) {
+        float const* x0 = rows + r * n;
+        float const* x1 = x0 + n;
+        float const* x2 = x1 + n;
+        float const* x3 = x2 + n;
+        float const* x4 = x3 + n;
+        float const* x5 = x4 + n;
+        float const* x6 = x5 + n;
+        float const* x7 = x6 + n;
+        __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps();
+        __m512 a2 = _mm512_setzero_ps(), a3 = _mm512_setzero_ps();
+        __m512 a4 = _mm512_setzero_ps(), a5 = _mm512_setzero_ps();
+        __m512 a6 = _mm512_setzero_ps(), a7 = _mm512_setzero_ps();
+        std::size_t k = 0;
+        for (; k < full; k += 16) {
+            __m512 w = _mm512_loadu_ps(weights + k);
+            a0 = _mm512_fmadd_ps(w, _mm512_loadu_ps(x0 + k), a0);
+            a1 = _mm512_fmadd_ps(w, _mm512_loadu_ps(x1 + k), a1);
+            a2 = _mm512_fmadd_ps(w, _mm512_loadu_ps(x2 + k), a2);
+            a3 = _mm512_fmadd_ps(w, _mm512_loadu_ps(x3 + k), a3);
+            a4 = _mm512_fmadd_ps(w, _mm512_loadu_ps(x4 + k), a4);
+            a5 = _mm512_fmadd_ps(w, _mm512_loadu_ps(x5 + k), a5);
+            a6 = _mm512_fmadd_ps(w, _mm512_loadu_ps(x6 + k), a6);
+            a7 = _mm512_fmadd_ps(w, _mm512_loadu_ps(x7 + k), a7);
+        }
+        if (k < n) {
+            __m512 w = _mm512_maskz_loadu_ps(mask, weights + k);
+            a0 = _mm512_fmadd_ps(w, _mm512_maskz_loadu_ps(mask, x0 + k), a0);
+            a1 = _mm512_fmadd_ps(w, _mm512_maskz_loadu_ps(mask, x1 + k), a1);
+            a2 = _mm512_fmadd_ps(w, _mm512_maskz_loadu_ps(mask, x2 + k), a2);
+            a3 = _mm512_fmadd_ps(w, _mm512_maskz_loadu_ps(mask, x3 + k), a3);
+            a4 = _mm512_fmadd_ps(w, _mm512_maskz_loadu_ps(mask, x4 + k), a4);
+            a5 = _mm512_fmadd_ps(w, _mm512_maskz_loadu_ps(mask, x5 + k), a5);
+            a6 = _mm512_fmadd_ps(w, _mm512_maskz_loadu_ps(mask, x6 + k), a6);
+            a7 = _mm512_fmadd_ps(w, _mm512_maskz_loadu_ps(mask, x7 + k), a7);
+        }
+        __m256 halves[8] = {fold_avx512(a0), fold_avx512(a1), fold_avx512(a2), fold_avx512(a3),
+                            fold_avx512(a4), fold_avx512(a5), fold_avx512(a6), fold_avx512(a7)};
+        __m256 z = _mm256_add_ps(reduce8_avx2(halves), b);
+        if constexpr (ApplySigmoid) {
+            z = sigmoid_avx2(z);
+        }
+        _mm256_storeu_ps(out + r, z);
+    }
+
+    for (; r < count; ++r) {
+        float const* row = rows + r * n;
+        __m512 acc = _mm512_setzero_ps();
+        std::size_t k = 0;
+        for (; k < full; k += 16) {
+            acc = _mm512_fmadd_ps(_mm512_loadu_ps(weights + k), _mm512_loadu_ps(row + k), acc);
+        }
+        if (k < n) {
+            acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, weights + k),
+                                  _mm512_maskz_loadu_ps(mask, row + k), acc);
+        }
+        float z = reduce1_avx2(fold_avx512(acc)) + bias;
+        out[r] = ApplySigmoid ? math::sigmoid(z) : z;
+    }
+}
+
+// V accumulators of 8 classes stay in registers for the whole pass over the
+// features; each feature is broadcast once and multiplied into every class.
+template <int V>
+CLASSIFIER_TARGET_AVX2 void linear_classes_avx2(float const* weights, std::size_t ldk,
+                                                std::size_t n, float const* bias,
+                                                float const* x, float* out) noexcept {
+    __m256 acc[V];
+#pragma GCC unroll 8
+    for (int v = 0; v < V; ++v) {
+        acc[v] = _mm256_loadu_ps(bias + 8 * v);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        __m256 xi = _mm256_set1_ps(x[i]);
+        float const* row = weights + i * ldk;
+#pragma GCC unroll 8
+        for (int v = 0; v < V; ++v) {
+            acc[v] = _mm256_fmadd_ps(xi, _mm256_loadu_ps(row + 8 * v), acc[v]);
+        }
+    }
+#pragma GCC unroll 8
+    for (int v = 0; v < V; ++v) {
+        _mm256_storeu_ps(out + 8 * v, acc[v]);
+    }
+}
+
+template <int V>
+CLASSIFIER_TARGET_AVX512 void linear_classes_avx512(float const* weights, std::size_t ldk,
+                                                    std::size_t n, float const* bias,
+                                                    float const* x, float* out) noexcept {
+    __m512 acc[V];
+#pragma GCC unroll 8
+    for (int v = 0; v < V; ++v) {
+        acc[v] = _mm512_loadu_ps(bias + 16 * v);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        __m512 xi = _mm512_set1_ps(x[i]);
+        float const* row = weights + i * ldk;
+#pragma GCC unroll 8
+        for (int v = 0; v < V; ++v) {
+            acc[v] = _mm512_fmadd_ps(xi, _mm512_loadu_ps(row + 16 * v), acc[v]);
+        }
+    }
+#pragma GCC unroll 8
+    for (int v = 0; v < V; ++v) {
+        _mm512_storeu_ps(out + 16 * v, acc[v]);
+    }
+}
+
+// Register block of R rows by V vectors of columns: each feature's V weight
+// vectors are loaded once and multiplied into all R rows. Only the first
+// `columns` outputs of each row are stored.
+template <int R, int V>
+CLASSIFIER_TARGET_AVX2 void linear_classes_rows_avx2(float const* weights, std::size_t ldk,
+                                                     std::size_t n, float const* bias,
+                                                     float const* rows, std::size_t columns,
+                                                     float* out, std::size_t ldo) noexcept {
+    __m256 acc[R][V];
+#pragma GCC unroll 8
+    for (int r = 0; r < R; ++r) {
+#pragma GCC unroll 8
+        for (int v = 0; v < V; ++v) {
+            acc[r][v] = _mm256_loadu_ps(bias + 8 * v);
+        }
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        __m256 w[V];
+#pragma GCC unroll 8
+        for (int v = 0; v < V; ++v) {
+            w[v] = _mm256_loadu_ps(weights + i * ldk + 8 * v);
+        }
+#pragma GCC unroll 8
+        for (int r = 0; r < R; ++r) {
+            __m256 xi = _mm256_set1_ps(rows[r * n + i]);
+#pragma GCC unroll 8
+            for (int v = 0; v < V; ++v) {
+                acc[r][v] = _mm256_fmadd_ps(xi, w[v], acc[r][v]);
+            }
+        }
+    }
+#pragma GCC unroll 8
+    for (int v = 0; v < V; ++v) {
+        std::size_t c = 8 * static_cast<std::size_t>(v);
+        __m256i mask = tail_mask_avx2(columns > c ? std::min<std::size_t>(columns - c, 8) : 0);
+#pragma GCC unroll 8
+        for (int r = 0; r < R; ++r) {
+            _mm256_maskstore_ps(out + r * ldo + c, mask, acc[r][v]);
+        }
+    }
+}
+
+template <int R, int V>
+CLASSIFIER_TARGET_AVX512 void linear_classes_rows_avx512(float const* weights, std::size_t ldk,
+                                                         std::size_t n, float const* bias,
+                                                         float const* rows, std::size_t columns,
+                                                         float* out, std::size_t ldo) noexcept {
+    __m512 acc[R][V];
+#pragma GCC unroll 8
+    for (int r = 0; r < R; ++r) {
+#pragma GCC unroll 8
+        for (int v = 0; v < V; ++v) {
+            acc[r][v] = _mm512_loadu_ps(bias + 16 * v);
+        }
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        __m512 w[V];
+#pragma GCC unroll 8
+        for (int v = 0; v < V; ++v) {
+            w[v] = _mm512_loadu_ps(weights + i * ldk + 16 * v);
+        }
+#pragma GCC unroll 8
+        for (int r = 0; r < R; ++r) {
+            __m512 xi = _mm512_set1_ps(rows[r * n + i]);
+#pragma GCC unroll 8
+            for (int v = 0; v < V; ++v) {
+                acc[r][v] = _mm512_fmadd_ps(xi, w[v], acc[r][v]);
+            }
+        }
+    }
+#pragma GCC unroll 8
+    for (int v = 0; v < V; ++v) {
+        std::size_t c = 16 * static_cast<std::size_t>(v);
+        std::size_t valid = columns > c ? std::min<std::size_t>(columns - c, 16) : 0;
+        auto mask = static_cast<__mmask16>((1u << valid) - 1);
+#pragma GCC unroll 8
+        for (int r = 0; r < R; ++r) {
+            _mm512_mask_storeu_ps(out + r * ldo + c, mask, acc[r][v]);
+        }
+    }
+}
+
+// Splits the columns into blocks of up to eight registers and runs one pass
+// over the features per block.
+template <int Width, typename Block>
+void linear_classes_blocked(std::size_t ldk, Block&& block) noexcept {
+    for (std::size_t c = 0; c < ldk; c += 8 * Width) {
+        switch (std::min<std::size_t>(8, (ldk - c) / Width)) {
+        case 1: block.template operator()<1>(c); break;
+        case 2: block.template operator()<2>(c); break;
+        case 3: block.template operator()<3>(c); break;
+        case 4: block.template operator()<4>(c); break;
+        case 5: block.template operator()<5>(c); break;
+        case 6: block.template operator()<6>(c); break;
+        case 7: block.template operator()<7>(c); break;
+        default: block.template operator()<8>(c); break;
+        }
+    }
+}
+
+// Column blocks of up to MaxV vectors, each run over all rows: four rows at
+// a time while they last, then one at a time. A block's weights stay in L1
+// across the rows.
+template <int Width, int MaxV, typename Block>
+void linear_classes_rows_blocked(std::size_t columns, std::size_t count, Block&& block) noexcept {
+    for (std::size_t c = 0; c < columns; c += MaxV * Width) {
+        std::size_t vectors = std::min<std::size_t>(MaxV, (columns - c + Width - 1) / Width);
+        auto rows = [&]<int V>() {
+            std::size_t r = 0;
+            for (; r + 4 <= count; r += 4) {
+                block.template operator()<4, V>(c, r);
+            }
+            for (; r < count; ++r) {
+                block.template operator()<1, V>(c, r);
+            }
+        };
+        switch (vectors) {
+        case 1: rows.template operator()<1>(); break;
+        case 2: rows.template operator()<(MaxV < 2 ? MaxV : 2)>(); break;
+        case 3: rows.template operator()<(MaxV < 3 ? MaxV : 3)>(); break;
+        default: rows.template operator()<MaxV>(); break;
+        }
+    }
+}
+
+CLASSIFIER_TARGET_AVX2 inline void softmax_avx2(float* values, std::size_t count) noexcept {
+    float max = *std::max_element(values, values + count);
+    __m256 const vmax = _mm256_set1_ps(max);
+    __m256 vsum = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 e = exp_avx2(_mm256_sub_ps(_mm256_loadu_ps(values + i), vmax));
+        _mm256_storeu_ps(values + i, e);
+        vsum = _mm256_add_ps(vsum, e);
+    }
+    float sum = reduce1_avx2(vsum);
+    for (; i < count; ++i) {
+        values[i] = std::exp(values[i] - max);
+        sum += values[i];
+    }
+    __m256 const inv = _mm256_set1_ps(1.0f / sum);
+    for (i = 0; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(values + i, _mm256_mul_ps(_mm256_loadu_ps(values + i), inv));
+    }
+    for (; i < count; ++i) {
+        values[i] /= sum;
+    }
+}
+
+CLASSIFIER_TARGET_AVX2 inline void axpy_avx2(float a, float const* x, float* y,
+                                           std::size_t count) noexcept {
+    __m256 const va = _mm256_set1_ps(a);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    }
+    for (; i < count; ++i) {
+        y[i] += a * x[i];
+    }
+}
+
+#endif
+
+template <bool ApplySigmoid>
+void rows_dispatch(float const* weights, std::size_t n, float bias, float const* rows,
+                   std::size_t count, float* out, Isa isa) noexcept {
+#if CLASSIFIER_X86_DISPATCH
+    // Below a full 512-bit register of features the masked zmm path loses to ymm.
+    if (isa == Isa::avx512 && n >= 16) {
+        rows_avx512<ApplySigmoid>(weights, n, bias, rows, count, out);
+        return;
+    }
+    if (isa != Isa::scalar) {
+        rows_avx2<ApplySigmoid>(weights, n, bias, rows, count, out);
+        return;
+    }
+#else
+    (void)isa;
+#endif
+    for (std::size_t r = 0; r < count; r += block_rows) {
+        std::size_t len = std::min(block_rows, count - r);
+        linear_rows_scalar(weights, n, bias, rows + r * n, len, out + r);
+        if constexpr (ApplySigmoid) {
+            sigmoid_scalar(out + r, len);
+        }
+    }
+}
+
+} // namespace detail
+
+// out[r] = dot(weights, rows[r]) + bias for `count` contiguous rows of `n` floats.
+inline void linear_rows(float const* weights, std::size_t n, float bias, float const* rows,
+                        std::size_t count, float* out, Isa isa = active_isa()) noexcept {
+    detail::rows_dispatch<false>(weights, n, bias, rows, count, out, isa);
+}
+
+// out[r] = sigmoid(dot(weights, rows[r]) + bias).
+inline void score_rows(float const* weights, std::size_t n, float bias, float const* rows,
+                       std::size_t count, float* out, Isa isa = active_isa()) noexcept {
+    detail::rows_dispatch<true>(weights, n, bias, rows, count, out, isa);
+}
+
+inline float dot(float const* a, float const* b, std::size_t count,
+                 Isa isa = active_isa()) noexcept {
+    float result = 0.0f;
+    detail::rows_dispatch<false>(a, count, 0.0f, b, 1, &result, isa);
+    return result;
+}
+
+// y[i] += a * x[i].
+inline void axpy(float a, float const* x, float* y, std::size_t count,
+                 Isa isa = active_isa()) noexcept {
+#if CLASSIFIER_X86_DISPATCH
+    if (isa != Isa::scalar) {
+        detail::axpy_avx2(a, x, y, count);
+        return;
+    }
+#else
+    (void)isa;
+#endif
+    for (std::size_t i = 0; i < count; ++i) {
+        y[i] += a * x[i];
+    }
+}
+
+// out[c] = bias[c] + sum_i x[i] * weights[i * ldk + c] for every c < ldk:
+// all classes' logits in one pass over the features, with the weights stored
+// feature-major. ldk must be a multiple of 16.
+inline void linear_classes(float const* weights, std::size_t ldk, std::size_t n,
+                           float const* bias, float const* x, float* out,
+                           Isa isa = active_isa()) noexcept {
+#if CLASSIFIER_X86_DISPATCH
+    if (isa == Isa::avx512) {
+        detail::linear_classes_blocked<16>(ldk, [&]<int V>(std::size_t c) {
+            detail::linear_classes_avx512<V>(weights + c, ldk, n, bias + c, x, out + c);
+        });
+        return;
+    }
+    if (isa != Isa::scalar) {
+        detail::linear_classes_blocked<8>(ldk, [&]<int V>(std::size_t c) {
+            detail::linear_classes_avx2<V>(weights + c, ldk, n, bias + c, x, out + c);
+        });
+        return;
+    }
+#else
+    (void)isa;
+#endif
+    detail::linear_classes_scalar(weights, ldk, n, bias, x, out);
+}
+
+// out[r * ldo + c] = bias[c] + sum_i rows[r * n + i] * weights[i * ldk + c]
+// for r < count and c < columns: linear_classes over a batch of rows, with
+// only the first `columns` outputs of each row written. ldk must be a
+// multiple of 16 and columns at most ldk.
+inline void linear_classes_rows(float const* weights, std::size_t ldk, std::size_t n,
+                                float const* bias, float const* rows, std::size_t count,
+                                std::size_t columns, float* out, std::size_t ldo,
+                                Isa isa = active_isa()) noexcept {
+#if CLASSIFIER_X86_DISPATCH
+    if (isa == Isa::avx512) {
+        detail::linear_classes_rows_blocked<16, 4>(
+            columns, count, [&]<int R, int V>(std::size_t c, std::size_t r) {
+                detail::linear_classes_rows_avx512<R, V>(weights + c, ldk, n, bias + c,
+                                                         rows + r * n, columns - c,
+                                                         out + r * ldo + c, ldo);
+            });
+        return;
+    }
+    if (isa != Isa::scalar) {
+        detail::linear_classes_rows_blocked<8, 2>(
+            columns, count, [&]<int R, int V>(std::size_t c, std::size_t r) {
+                detail::linear_classes_rows_avx2<R, V>(weights + c, ldk, n, bias + c,
+                                                       rows + r * n, columns - c,
+                                                       out + r * ldo + c, ldo);
+            });
+        return;
+    }
+#else
+    (void)isa;
+#endif
+    detail::linear_classes_rows_scalar(weights, ldk, n, bias, rows, count, columns, out, ldo);
+}
+
+// values = exp(values - max) / sum(exp(values - max)).
+inline void softmax_inplace(float* values, std::size_t count, Isa isa = active_isa()) noexcept {
+    if (count == 0) {
+        return;
+    }
+#if CLASSIFIER_X86_DISPATCH
+    if (isa != Isa::scalar) {
+        detail::softmax_avx2(values, count);
+        return;
+    }
+#else
+    (void)isa;
+#endif
+    float max = *std::max_element(values, values + count);
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] = std::exp(values[i] - max);
+        sum += values[i];
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] /= sum;
+    }
+}
+
+inline void sigmoid_rational_inplace(float* values, std::size_t count,
+                                     Isa isa = active_isa()) noexcept {
+#if CLASSIFIER_X86_DISPATCH
+    if (isa != Isa::scalar) {
+        detail::sigmoid_rational_avx2(values, count);
+        return;
+    }
+#else
+    (void)isa;
+#endif
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] = math::sigmoid_rational(values[i]);
+    }
+}
+
+inline void sigmoid_inplace(float* values, std::size_t count, Isa isa = active_isa()) noexcept {
+#if CLASSIFIER_X86_DISPATCH
+    if (isa != Isa::scalar) {
+        detail::sigmoid_avx2(values, count);
+        return;
+    }
+#else
+    (void)isa;
+#endif
+    detail::sigmoid_scalar(values, count);
+}
+
+} // namespace classifier::kernels
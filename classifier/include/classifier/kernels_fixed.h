@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// Kernels for a feature count known at compile time and small enough to
+// unroll completely. Every loop below is expanded into straight-line code,
+// the tail of N that does not fill a vector is peeled at compile time rather
+// than tested for at run time, and the vector width is chosen from N. The
+// summation order depends only on N and the compile-time ISA.
+namespace classifier::kernels {
+
+// Feature counts up to this use the fixed kernels; larger models go through
+// the runtime-dispatched ones in kernels.h.
+inline constexpr std::size_t unroll_limit = 32;
+
+// Widest float vector the compiler may use unconditionally: the fixed
+// kernels are inlined into callers built for the baseline ISA, so there is
+// no runtime dispatch to reach wider units. Without GCC vector extensions
+// everything stays scalar.
+#if !defined(__GNUC__)
+inline constexpr std::size_t native_lanes = 1;
+#elif defined(__AVX__)
+inline constexpr std::size_t native_lanes = 8;
+#else
+inline constexpr std::size_t native_lanes = 4;
+#endif
+
+// Vector width for an N-element kernel: the native width once N fills it,
+// 4 lanes for 4 <= N < native_lanes, scalar below that.
+template <std::size_t N>
+inline constexpr std::size_t fixed_lanes =
+    N >= native_lanes ? native_lanes : (N >= 4 && native_lanes >= 4 ? 4 : 1);
+
+// Calls f(std::integral_constant<std::size_t, I>{}) for I = 0..Count-1.
+template <std::size_t Count, typename F>
+[[gnu::always_inline]] inline void unrolled(F&& f) noexcept {
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (f(std::integral_constant<std::size_t, I>{}), ...);
+    }(std::make_index_sequence<Count>{});
+}
+
+namespace detail {
+
+template <std::size_t Lanes>
+using FloatVector [[gnu::vector_size(Lanes * sizeof(float))]] = float;
+
+} // namespace detail
+
+// `Lanes` is fixed_lanes<N> for this build; the tests pin it to cover each
+// width whatever ISA they are built for, since GCC lowers a vector wider than
+// the target to narrower operations.
+template <std::size_t N, std::size_t Lanes = fixed_lanes<N>>
+[[gnu::always_inline]] inline float dot_fixed(float const* a, float const* b) noexcept {
+    static_assert(Lanes == 1 || Lanes == 4 || Lanes == 8);
+    constexpr std::size_t lanes = Lanes;
+    constexpr std::size_t vectors = N / lanes;
+    constexpr std::size_t body = vectors * lanes;
+
+    if constexpr (lanes == 1) {
+        float sum = 0.0f;
+        unrolled<N>([&](auto i) { sum += a[i] * b[i]; });
+        return sum;
+    } else {
+        using Vector = detail::FloatVector<lanes>;
+        // Two accumulators once there are enough vectors to hide the add
+        // latency.
+        constexpr std::size_t registers = vectors >= 2 ? 2 : 1;
+        Vector acc[registers] = {};
+        // Loaded in place rather than through a helper returning Vector, so
+        // no function passes a vector wider than the target by value.
+        unrolled<vectors>([&](auto v) {
+            Vector x;
+            Vector y;
+            std::memcpy(&x, a + v * lanes, sizeof(x));
+            std::memcpy(&y, b + v * lanes, sizeof(y));
+            acc[v % registers] += x * y;
+        });
+        if constexpr (registers == 2) {
+            acc[0] += acc[1];
+        }
+
+        // Halving tree across the lanes, then the peeled tail.
+        float lane[lanes];
+        std::memcpy(lane, &acc[0], sizeof(lane));
+        if constexpr (lanes >= 8) {
+            unrolled<4>([&](auto j) { lane[j] += lane[j + 4]; });
+        }
+        float sum = (lane[0] + lane[2]) + (lane[1] + lane[3]);
+        unrolled<N - body>([&](auto j) { sum += a[body + j] * b[body + j]; });
+        return sum;
+    }
+}
+
+// y[i] += a * x[i].
+template <std::size_t N>
+[[gnu::always_inline]] inline void axpy_fixed(float a, float const* x, float* y) noexcept {
+    unrolled<N>([&](auto i) { y[i] += a * x[i]; });
+}
+
+} // namespace classifier::kernels
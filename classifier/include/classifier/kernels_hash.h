@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "classifier/kernels.h"
+
+#if CLASSIFIER_X86_DISPATCH
+#define CLASSIFIER_TARGET_AVX512_DQ __attribute__((target("avx512f,avx512dq")))
+#endif
+
+namespace classifier::kernels {
+
+// Hashed position of one feature: the bucket it lands in and the sign bit to
+// xor into its value.
+struct HashSlot {
+    std::uint32_t bucket;
+    std::uint32_t sign;
+};
+
+// MurmurHash3's 64-bit finalizer.
+constexpr std::uint64_t mix64(std::uint64_t h) noexcept {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// MurmurHash64A over the bytes of `s`.
+inline std::uint64_t hash_string(std::string_view s, std::uint64_t seed) noexcept {
+    constexpr std::uint64_t m = 0xc6a4a7935bd1e995ull;
+    constexpr int r = 47;
+    std::uint64_t h = seed ^ (s.size() * m);
+
+    std::size_t i = 0;
+    for (; i + 8 <= s.size(); i += 8) {
+        std::uint64_t k;
+        std::memcpy(&k, s.data() + i, sizeof(k));
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+    if (i < s.size()) {
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, s.data() + i, s.size() - i);
+        h ^= tail;
+        h *= m;
+    }
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+// The high half picks the bucket by multiply-shift range reduction, which
+// needs no division and works for any bucket count; bit 31 picks the sign.
+constexpr HashSlot slot(std::uint64_t h, std::uint32_t buckets) noexcept {
+    return {static_cast<std::uint32_t>(((h >> 32) * buckets) >> 32),
+            static_cast<std::uint32_t>(h) & 0x80000000u};
+}
+
+enum class HashIsa { scalar, avx512dq };
+
+inline HashIsa detect_hash_isa() noexcept {
+#if CLASSIFIER_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+        return HashIsa::avx512dq;
+    }
+#endif
+    return HashIsa::scalar;
+}
+
+inline HashIsa active_hash_isa() noexcept {
+    static HashIsa const isa = detect_hash_isa();
+    return isa;
+}
+
+namespace detail {
+
+inline void hash_keys_scalar(std::uint64_t const* keys, std::size_t count, std::uint64_t seed,
+                             std::uint32_t buckets, HashSlot* out) noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = slot(mix64(keys[i] ^ seed), buckets);
+    }
+}
+
+#if CLASSIFIER_X86_DISPATCH
+
+// Needs a native 64-bit multiply (vpmullq); emulating it with AVX2 32-bit
+// products measured no faster than the scalar loop, so there is no AVX2 path.
+CLASSIFIER_TARGET_AVX512_DQ inline void hash_keys_avx512dq(std::uint64_t const* keys,
+                                                           std::size_t count,
+                                                           std::uint64_t seed,
+                                                           std::uint32_t buckets,
+                                                           HashSlot* out) noexcept {
+    __m512i const seed_v = _mm512_set1_epi64(static_cast<long long>(seed));
+    __m512i const buckets_v = _mm512_set1_epi64(buckets);
+    __m512i const m1 = _mm512_set1_epi64(static_cast<long long>(0xff51afd7ed558ccdull));
+    __m512i const m2 = _mm512_set1_epi64(static_cast<long long>(0xc4ceb9fe1a85ec53ull));
+    __m512i const sign_mask = _mm512_set1_epi64(0x80000000ll);
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512i h = _mm512_xor_si512(_mm512_loadu_si512(keys + i), seed_v);
+        h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+        h = _mm512_mullo_epi64(h, m1);
+        h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+        h = _mm512_mullo_epi64(h, m2);
+        h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+
+        // Each 64-bit lane becomes one HashSlot: bucket in the low dword,
+        // sign in the high dword.
+        __m512i bucket = _mm512_srli_epi64(_mm512_mul_epu32(_mm512_srli_epi64(h, 32), buckets_v), 32);
+        __m512i sign = _mm512_slli_epi64(_mm512_and_si512(h, sign_mask), 32);
+        _mm512_storeu_si512(out + i, _mm512_or_si512(bucket, sign));
+    }
+    hash_keys_scalar(keys + i, count - i, seed, buckets, out + i);
+}
+
+#endif
+
+} // namespace detail
+
+// Hashes `count` contiguous keys into slots over `buckets` buckets.
+inline void hash_keys(std::uint64_t const* keys, std::size_t count, std::uint64_t seed,
+                      std::uint32_t buckets, HashSlot* out,
+                      HashIsa isa = active_hash_isa()) noexcept {
+    static_assert(sizeof(HashSlot) == sizeof(std::uint64_t));
+#if CLASSIFIER_X86_DISPATCH
+    if (isa == HashIsa::avx512dq) {
+        detail::hash_keys_avx512dq(keys, count, seed, buckets, out);
+        return;
+    }
+#else
+    (void)isa;
+#endif
+    detail::hash_keys_scalar(keys, count, seed, buckets, out);
+}
+
+} // namespace classifier::kernels
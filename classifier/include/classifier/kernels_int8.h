@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "classifier/kernels.h"
+
+#if CLASSIFIER_X86_DISPATCH
+#define CLASSIFIER_TARGET_AVX_VNNI __attribute__((target("avxvnni,avx2")))
+#define CLASSIFIER_TARGET_AVX512_VNNI __attribute__((target("avx512vnni,avx512bw,avx512f,avx2")))
+#endif
+
+namespace classifier::kernels {
+
+enum class Int8Isa { scalar, avx2, avx_vnni, avx512_vnni };
+
+inline Int8Isa detect_int8_isa() noexcept {
+#if CLASSIFIER_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512bw")) {
+        return Int8Isa::avx512_vnni;
+    }
+    if (__builtin_cpu_supports("avxvnni")) {
+        return Int8Isa::avx_vnni;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Int8Isa::avx2;
+    }
+#endif
+    return Int8Isa::scalar;
+}
+
+inline Int8Isa active_int8_isa() noexcept {
+    static Int8Isa const isa = detect_int8_isa();
+    return isa;
+}
+
+// Exact integer dot product of unsigned 8-bit activations with signed 8-bit
+// weights, plus the activation sum needed for zero-point correction.
+struct DotU8S8 {
+    std::int32_t dot;
+    std::int32_t activation_sum;
+};
+
+namespace detail {
+
+inline DotU8S8 dot_u8s8_scalar(std::uint8_t const* x, std::int8_t const* w,
+                               std::size_t n) noexcept {
+    DotU8S8 result{0, 0};
+    for (std::size_t i = 0; i < n; ++i) {
+        result.dot += static_cast<std::int32_t>(x[i]) * static_cast<std::int32_t>(w[i]);
+        result.activation_sum += x[i];
+    }
+    return result;
+}
+
+#if CLASSIFIER_X86_DISPATCH
+
+CLASSIFIER_TARGET_AVX2 inline std::int32_t hsum_epi32_avx2(__m256i v) noexcept {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+// The SAD partial sums fit in 32 bits, so the low half of the 64-bit total
+// is the whole result; _mm_cvtsi128_si64 would not build on i386.
+CLASSIFIER_TARGET_AVX2 inline std::int32_t hsum_epi64_avx2(__m256i v) noexcept {
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi64(s, _mm_unpackhi_epi64(s, s));
+    return _mm_cvtsi128_si32(s);
+}
+
+// pmaddubsw saturates its int16 pair sums for full-range u8 x s8 inputs, so
+// the fallback widens both operands to int16 and uses pmaddwd, which is exact.
+CLASSIFIER_TARGET_AVX2 inline DotU8S8 dot_u8s8_avx2(std::uint8_t const* x, std::int8_t const* w,
+                                                   std::size_t n) noexcept {
+    __m256i acc = _mm256_setzero_si256();
+    __m256i sums = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i xv = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(x + i));
+        __m256i wv = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(w + i));
+        __m256i x_lo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(xv));
+        __m256i x_hi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(xv, 1));
+        __m256i w_lo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(wv));
+        __m256i w_hi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(wv, 1));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(x_lo, w_lo));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(x_hi, w_hi));
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(xv, _mm256_setzero_si256()));
+    }
+    DotU8S8 tail = dot_u8s8_scalar(x + i, w + i, n - i);
+    return {hsum_epi32_avx2(acc) + tail.dot, hsum_epi64_avx2(sums) + tail.activation_sum};
+}
+
+CLASSIFIER_TARGET_AVX_VNNI inline DotU8S8 dot_u8s8_avx_vnni(std::uint8_t const* x,
+                                                           std::int8_t const* w,
+                                                           std::size_t n) noexcept {
+    __m256i acc = _mm256_setzero_si256();
+    __m256i sums = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i xv = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(x + i));
+        __m256i wv = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(w + i));
+        acc = _mm256_dpbusd_avx_epi32(acc, xv, wv);
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(xv, _mm256_setzero_si256()));
+    }
+    DotU8S8 tail = dot_u8s8_scalar(x + i, w + i, n - i);
+    return {hsum_epi32_avx2(acc) + tail.dot, hsum_epi64_avx2(sums) + tail.activation_sum};
+}
+
+CLASSIFIER_TARGET_AVX512_VNNI inline DotU8S8 dot_u8s8_avx512_vnni(std::uint8_t const* x,
+                                                                 std::int8_t const* w,
+                                                                 std::size_t n) noexcept {
+    __m512i acc = _mm512_setzero_si512();
+    __m512i sums = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i xv = _mm512_loadu_si512(x + i);
+        __m512i wv = _mm512_loadu_si512(w + i);
+        acc = _mm512_dpbusd_epi32(acc, xv, wv);
+        sums = _mm512_add_epi64(sums, _mm512_sad_epu8(xv, _mm512_setzero_si512()));
+    }
+    if (i < n) {
+        __mmask64 mask = (__mmask64(1) << (n - i)) - 1;
+        __m512i xv = _mm512_maskz_loadu_epi8(mask, x + i);
+        __m512i wv = _mm512_maskz_loadu_epi8(mask, w + i);
+        acc = _mm512_dpbusd_epi32(acc, xv, wv);
+        sums = _mm512_add_epi64(sums, _mm512_sad_epu8(xv, _mm512_setzero_si512()));
+    }
+    return {_mm512_reduce_add_epi32(acc), static_cast<std::int32_t>(_mm512_reduce_add_epi64(sums))};
+}
+
+#endif
+
+} // namespace detail
+
+inline DotU8S8 dot_u8s8(std::uint8_t const* x, std::int8_t const* w, std::size_t n,
+                        Int8Isa isa = active_int8_isa()) noexcept {
+#if CLASSIFIER_X86_DISPATCH
+    switch (isa) {
+    case Int8Isa::avx512_vnni: return detail::dot_u8s8_avx512_vnni(x, w, n);
+    case Int8Isa::avx_vnni: return detail::dot_u8s8_avx_vnni(x, w, n);
+    case Int8Isa::avx2: return detail::dot_u8s8_avx2(x, w, n);
+    case Int8Isa::scalar: break;
+    }
+#else
+    (void)isa;
+#endif
+    return detail::dot_u8s8_scalar(x, w, n);
+}
+
+} // namespace classifier::kernels
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "classifier/relaxed.h"
+
+namespace classifier {
+
+// Log-linear histogram of durations in nanoseconds, after HdrHistogram:
+// values below 2^sub_bucket_bits are counted exactly and every power-of-two
+// range above is split into 2^sub_bucket_bits equal buckets, so a reported
+// value is within 1/32 (3.1%) of the recorded one. Values from
+// 2^max_value_bits ns (about 18 minutes) up land in the last bucket.
+//
+// record() is meant for a single writing thread and costs one relaxed load
+// and store per field, no read-modify-write. snapshot() may run on any
+// thread at the same time and returns a consistent-enough copy: each field
+// is read atomically, though a record() in flight may be half counted.
+class LatencyHistogram {
+public:
+    static constexpr unsigned sub_bucket_bits = 5;
+    static constexpr unsigned max_value_bits = 40;
+    static constexpr std::size_t sub_buckets = std::size_t(1) << sub_bucket_bits;
+    static constexpr std::size_t bucket_count =
+        (max_value_bits - sub_bucket_bits + 1) * sub_buckets;
+
+    void record(std::chrono::nanoseconds duration) noexcept {
+        record(static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0)));
+    }
+
+    void record(std::uint64_t nanoseconds) noexcept {
+        detail::relaxed_add(counts_[bucket_of(nanoseconds)], 1);
+        detail::relaxed_add(count_, 1);
+        detail::relaxed_add(sum_, nanoseconds);
+        if (nanoseconds > detail::relaxed_load(max_)) {
+            detail::relaxed_store(max_, nanoseconds);
+        }
+    }
+
+    LatencyHistogram snapshot() const noexcept {
+        LatencyHistogram copy;
+        for (std::size_t b = 0; b < bucket_count; ++b) {
+            copy.counts_[b] = detail::relaxed_load(counts_[b]);
+        }
+        copy.count_ = detail::relaxed_load(count_);
+        copy.sum_ = detail::relaxed_load(sum_);
+        copy.max_ = detail::relaxed_load(max_);
+        return copy;
+    }
+
+    // Adds another histogram's counts, e.g. to combine per-thread shards.
+    // Neither side may be recording concurrently; merge snapshots instead.
+    void merge(LatencyHistogram const& other) noexcept {
+        for (std::size_t b = 0; b < bucket_count; ++b) {
+            counts_[b] += other.counts_[b];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    void reset() noexcept { *this = LatencyHistogram{}; }
+
+    std::uint64_t count() const noexcept { return count_; }
+    std::chrono::nanoseconds max() const noexcept { return to_duration(max_); }
+    std::chrono::nanoseconds mean() const noexcept {
+        return to_duration(count_ == 0 ? 0 : sum_ / count_);
+    }
+
+    // The smallest bucket bound at or below which a fraction q of the
+    // values lie, capped at the largest value recorded. Zero when empty.
+    std::chrono::nanoseconds percentile(double q) const noexcept {
+        if (count_ == 0) {
+            return std::chrono::nanoseconds(0);
+        }
+        auto rank = static_cast<std::uint64_t>(std::clamp(q, 0.0, 1.0) *
+                                               static_cast<double>(count_));
+        rank = std::clamp<std::uint64_t>(rank, 1, count_);
+        std::uint64_t seen = 0;
+        for (std::size_t b = 0; b < bucket_count; ++b) {
+            seen += counts_[b];
+            if (seen >= rank) {
+                return to_duration(std::min(upper_bound(b), max_));
+            }
+        }
+        return to_duration(max_);
+    }
+
+    static std::size_t bucket_of(std::uint64_t value) noexcept {
+        if (value < sub_buckets) {
+            return static_cast<std::size_t>(value);
+        }
+        unsigned magnitude = static_cast<unsigned>(std::bit_width(value)) - 1;
+        if (magnitude >= max_value_bits) {
+            return bucket_count - 1;
+        }
+        unsigned shift = magnitude - sub_bucket_bits;
+        return (shift + 1) * sub_buckets + static_cast<std::size_t>((value >> shift) - sub_buckets);
+    }
+
+    // Largest value that falls in bucket b.
+    static std::uint64_t upper_bound(std::size_t b) noexcept {
+        if (b < sub_buckets) {
+            return b;
+        }
+        std::size_t shift = b / sub_buckets - 1;
+        std::uint64_t low = (sub_buckets + b % sub_buckets) << shift;
+        return low + (std::uint64_t(1) << shift) - 1;
+    }
+
+private:
+    static std::chrono::nanoseconds to_duration(std::uint64_t value) noexcept {
+        return std::chrono::nanoseconds(static_cast<std::int64_t>(value));
+    }
+
+    alignas(64) std::array<std::uint64_t, bucket_count> counts_{};
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+    std::uint64_t max_ = 0;
+};
+
+} // namespace classifier
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <utility>
+
+#include "classifier/math.h"
+#include "classifier/trainer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CLASSIFIER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define CLASSIFIER_HAS_MMAP 0
+#endif
+
+namespace classifier {
+
+enum class AccessPattern { normal, sequential, random, will_need };
+
+// Read-only, zero-copy view of a [cols][rows][floats...] training data file,
+// usable wherever Trainer<N> takes its samples.
+template <std::size_t N>
+class MappedTrainingData {
+public:
+    using Sample = typename Trainer<N>::Sample;
+    static_assert(sizeof(Sample) == sizeof(float) * (N + 1));
+
+    MappedTrainingData() noexcept = default;
+    ~MappedTrainingData() { close(); }
+
+    MappedTrainingData(MappedTrainingData&& other) noexcept
+        : mapping_(std::exchange(other.mapping_, nullptr)),
+          length_(std::exchange(other.length_, 0)),
+          rows_(std::exchange(other.rows_, 0)) {}
+
+    MappedTrainingData& operator=(MappedTrainingData&& other) noexcept {
+        if (this != &other) {
+            close();
+            mapping_ = std::exchange(other.mapping_, nullptr);
+            length_ = std::exchange(other.length_, 0);
+            rows_ = std::exchange(other.rows_, 0);
+        }
+        return *this;
+    }
+
+    MappedTrainingData(MappedTrainingData const&) = delete;
+    MappedTrainingData& operator=(MappedTrainingData const&) = delete;
+
+    Error open(char const* path, AccessPattern pattern = AccessPattern::sequential) noexcept {
+        close();
+#if CLASSIFIER_HAS_MMAP
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return Error::io_failed;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return Error::io_failed;
+        }
+        std::size_t length = static_cast<std::size_t>(st.st_size);
+        if (length < header_size) {
+            ::close(fd);
+            return Error::io_failed;
+        }
+
+        std::size_t header[2] = {};
+        if (::pread(fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            ::close(fd);
+            return Error::io_failed;
+        }
+        if (header[0] != N + 1) {
+            ::close(fd);
+            return Error::dimension_mismatch;
+        }
+        std::size_t rows = header[1];
+        if (rows > (length - header_size) / sizeof(Sample) ||
+            header_size + rows * sizeof(Sample) != length) {
+            ::close(fd);
+            return Error::io_failed;
+        }
+
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return Error::io_failed;
+        }
+        mapping_ = mapping;
+        length_ = length;
+        rows_ = rows;
+        advise(pattern);
+        return Error::none;
+#else
+        (void)path;
+        (void)pattern;
+        return Error::io_failed;
+#endif
+    }
+
+    Error advise(AccessPattern pattern) noexcept {
+#if CLASSIFIER_HAS_MMAP
+        if (mapping_ == nullptr) {
+            return Error::io_failed;
+        }
+        int advice = MADV_NORMAL;
+        switch (pattern) {
+        case AccessPattern::normal: advice = MADV_NORMAL; break;
+        case AccessPattern::sequential: advice = MADV_SEQUENTIAL; break;
+        case AccessPattern::random: advice = MADV_RANDOM; break;
+        case AccessPattern::will_need: advice = MADV_WILLNEED; break;
+        }
+        if (::madvise(mapping_, length_, advice) != 0) {
+            return Error::io_failed;
+        }
+        return Error::none;
+#else
+        (void)pattern;
+        return Error::io_failed;
+#endif
+    }
+
+    void close() noexcept {
+#if CLASSIFIER_HAS_MMAP
+        if (mapping_ != nullptr) {
+            ::munmap(mapping_, length_);
+        }
+#endif
+        mapping_ = nullptr;
+        length_ = 0;
+        rows_ = 0;
+    }
+
+    bool is_open() const noexcept { return mapping_ != nullptr; }
+
+    std::span<Sample const> samples() const noexcept {
+        if (mapping_ == nullptr) {
+            return {};
+        }
+        auto const* bytes = static_cast<unsigned char const*>(mapping_) + header_size;
+        return {reinterpret_cast<Sample const*>(bytes), rows_};
+    }
+
+private:
+    static constexpr std::size_t header_size = 2 * sizeof(std::size_t);
+
+    void* mapping_ = nullptr;
+    std::size_t length_ = 0;
+    std::size_t rows_ = 0;
+};
+
+} // namespace classifier
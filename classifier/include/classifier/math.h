@@ -1,11 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <concepts>
 #include <cstddef>
 #include <numeric>
 #include <ranges>
+#include <span>
 
 namespace classifier {
 
@@ -16,6 +18,16 @@ enum class Error {
     io_failed,
     empty_training_set,
     invalid_regularization_strength,
+    invalid_batch_size,
+    invalid_format,
+    invalid_label,
+    arena_exhausted,
+    invalid_validation_fraction,
+    invalid_fold_count,
+    empty_search_space,
+    invalid_bin_count,
+    unknown_model,
+    invalid_decay,
 };
 
 namespace math {
@@ -25,6 +37,25 @@ T sigmoid(T x) noexcept {
     return T(1) / (T(1) + std::exp(-x));
 }
 
+// Logistic function through a [7/6] continued-fraction tanh:
+// sigmoid(x) = 0.5 + 0.5 * tanh(x / 2). Branch-free and division-only, so it
+// vectorizes; absolute error stays below 5e-5 for every float input.
+template <std::floating_point T>
+T sigmoid_rational(T x) noexcept {
+    T t = std::clamp(x * T(0.5), T(-4.97), T(4.97));
+    T t2 = t * t;
+    T p = t * (T(135135) + t2 * (T(17325) + t2 * (T(378) + t2)));
+    T q = T(135135) + t2 * (T(62370) + t2 * (T(3150) + t2 * T(28)));
+    return T(0.5) + T(0.5) * (p / q);
+}
+
+// Log-loss of logit z against label y in [0, 1], i.e. -log(sigmoid(z)) for
+// y = 1 and -log(1 - sigmoid(z)) for y = 0, without overflow for large |z|.
+template <std::floating_point T>
+T logistic_loss(T z, T y) noexcept {
+    return std::max(z, T(0)) - z * y + std::log1p(std::exp(-std::abs(z)));
+}
+
 template <std::ranges::sized_range A, std::ranges::sized_range B>
     requires std::floating_point<std::ranges::range_value_t<A>> &&
              std::same_as<std::ranges::range_value_t<A>, std::ranges::range_value_t<B>>
@@ -43,5 +74,11 @@ T dot(std::array<T, N> const& a, std::array<T, N> const& b) noexcept {
     return std::inner_product(a.begin(), a.end(), b.begin(), T(0));
 }
 
+template <std::floating_point T, std::size_t N>
+    requires(N != std::dynamic_extent)
+T dot(std::span<T const, N> a, std::span<T const, N> b) noexcept {
+    return std::inner_product(a.begin(), a.end(), b.begin(), T(0));
+}
+
 } // namespace math
 } // namespace classifier
@@ -0,0 +1,430 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "classifier/latency_histogram.h"
+#include "classifier/relaxed.h"
+
+// Optional instrumentation of the scoring and training hot paths. Build with
+// CLASSIFIER_METRICS=1 (the CLASSIFIER_ENABLE_METRICS CMake option) to turn
+// it on. Otherwise every hook below is an empty inline type or function and
+// compiles away, and snapshot() comes back empty. Every translation unit of
+// a program must agree on the setting. CLASSIFIER_METRICS_FORCE_OFF=1 wins
+// over CLASSIFIER_METRICS, for targets that must stay uninstrumented when
+// the option turns the layer on for everything linking the library.
+#ifndef CLASSIFIER_METRICS
+#define CLASSIFIER_METRICS 0
+#endif
+#if defined(CLASSIFIER_METRICS_FORCE_OFF) && CLASSIFIER_METRICS_FORCE_OFF
+#undef CLASSIFIER_METRICS
+#define CLASSIFIER_METRICS 0
+#endif
+
+// Scoring calls record their latency once every 2^shift calls per model and
+// thread; reading the clock on every call would cost more than a small
+// model's classify().
+#ifndef CLASSIFIER_METRICS_SAMPLE_SHIFT
+#define CLASSIFIER_METRICS_SAMPLE_SHIFT 8
+#endif
+
+namespace classifier::metrics {
+
+inline constexpr bool enabled = CLASSIFIER_METRICS != 0;
+
+// Scoring counters and latencies are kept per model id. Models start at id
+// 0, "default"; register_model() hands out the others.
+using ModelId = std::uint16_t;
+inline constexpr std::size_t max_models = 64;
+
+struct ModelMetrics {
+    ModelId id;
+    std::string name;
+    // Calls to classify, score_batch and classify_batch, and the rows they
+    // scored.
+    std::uint64_t calls;
+    std::uint64_t rows;
+    // Sampled per-call latency; see CLASSIFIER_METRICS_SAMPLE_SHIFT.
+    LatencyHistogram latency;
+};
+
+struct ReadMetrics {
+    std::uint64_t calls;
+    std::uint64_t bytes;
+    LatencyHistogram latency;
+};
+
+struct MetricsSnapshot {
+    // Models with any calls, by id.
+    std::vector<ModelMetrics> models;
+    // Model::deserialize and Trainer::deserialize_training_data.
+    ReadMetrics model_reads;
+    ReadMetrics training_data_reads;
+    // Wall time of every training epoch, across trainers and algorithms.
+    LatencyHistogram epochs;
+};
+
+#if CLASSIFIER_METRICS
+
+namespace detail {
+
+enum class ReadSource { model, training_data };
+
+// A thread's scoring counters: classify() calls, each one row, and batch
+// calls and their rows. They live in TLS rather than in the Shard so the
+// unsampled scoring path is a TLS-relative load and store with no shard
+// lookup; the thread's Shard points at them and folds them into its own
+// retired totals when the thread exits.
+struct ScoringCounters {
+    std::array<std::uint64_t, max_models> single_calls{};
+    std::array<std::uint64_t, max_models> batch_calls{};
+    std::array<std::uint64_t, max_models> batch_rows{};
+};
+
+inline constinit thread_local ScoringCounters scoring_counters{};
+
+// One thread's counters. Only the owning thread writes, with relaxed
+// atomic_ref stores; snapshot() reads from any thread. A shard outlives its
+// thread and is handed to the next thread that starts recording, so counts
+// are never lost and thread churn does not grow memory.
+struct alignas(64) Shard {
+    // The owning thread's scoring_counters, null while the shard is idle,
+    // and the counts of the threads that held it before.
+    ScoringCounters* live = nullptr;
+    ScoringCounters retired;
+    // Allocated on a model's first sampled call on this thread.
+    std::array<std::atomic<LatencyHistogram*>, max_models> latency{};
+    // The scoring call being timed on this thread.
+    ModelId sample_id = 0;
+    std::chrono::steady_clock::time_point sample_started;
+    std::array<std::uint64_t, 2> read_calls{};
+    std::array<std::uint64_t, 2> read_bytes{};
+    std::array<LatencyHistogram, 2> read_latency;
+    LatencyHistogram epochs;
+
+    ~Shard() {
+        for (auto& histogram : latency) {
+            delete histogram.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// Only the owning thread writes a shard's or its TLS counters.
+using classifier::detail::relaxed_add;
+using classifier::detail::relaxed_load;
+using classifier::detail::relaxed_store;
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<Shard*> idle;
+    std::array<std::string, max_models> names{"default"};
+};
+
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+inline constinit thread_local Shard* current_shard = nullptr;
+
+// Gives the shard back when its thread exits, with the thread's scoring
+// counts moved into it. The mutex keeps snapshot() off the TLS counters
+// while they are folded in.
+struct ShardLease {
+    Shard* shard = nullptr;
+
+    ~ShardLease() {
+        if (shard != nullptr) {
+            current_shard = nullptr;
+            std::lock_guard lock(registry().mutex);
+            for (std::size_t id = 0; id < max_models; ++id) {
+                shard->retired.single_calls[id] += scoring_counters.single_calls[id];
+                shard->retired.batch_calls[id] += scoring_counters.batch_calls[id];
+                shard->retired.batch_rows[id] += scoring_counters.batch_rows[id];
+            }
+            shard->live = nullptr;
+            registry().idle.push_back(shard);
+        }
+    }
+};
+
+[[gnu::noinline]] inline Shard& acquire_shard() {
+    thread_local ShardLease lease;
+    auto& r = registry();
+    {
+        std::lock_guard lock(r.mutex);
+        if (r.idle.empty()) {
+            r.shards.push_back(std::make_unique<Shard>());
+            lease.shard = r.shards.back().get();
+        } else {
+            lease.shard = r.idle.back();
+            r.idle.pop_back();
+        }
+        lease.shard->live = &scoring_counters;
+    }
+    current_shard = lease.shard;
+    return *lease.shard;
+}
+
+inline Shard& shard() {
+    Shard* shard = current_shard;
+    if (shard == nullptr) [[unlikely]] {
+        return acquire_shard();
+    }
+    return *shard;
+}
+
+[[gnu::noinline]] inline Shard* start_sample(ModelId id) noexcept {
+    Shard& shard = detail::shard();
+    shard.sample_id = id;
+    shard.sample_started = std::chrono::steady_clock::now();
+    return &shard;
+}
+
+[[gnu::noinline]] inline void finish_sample(Shard& shard) {
+    auto elapsed = std::chrono::steady_clock::now() - shard.sample_started;
+    LatencyHistogram* histogram = shard.latency[shard.sample_id].load(std::memory_order_relaxed);
+    if (histogram == nullptr) {
+        histogram = new LatencyHistogram;
+        shard.latency[shard.sample_id].store(histogram, std::memory_order_release);
+    }
+    histogram->record(elapsed);
+}
+
+} // namespace detail
+
+// Per-model tag stored in every Model; empty when metrics are off. Ids
+// register_model() cannot have handed out fall back to 0.
+class ModelTag {
+public:
+    void set(ModelId id) noexcept { id_ = id < max_models ? id : ModelId(0); }
+    ModelId id() const noexcept { return id_; }
+
+private:
+    ModelId id_ = 0;
+};
+
+// Counts one scoring call against model `tag`: classify() with the
+// single-row constructor, batches with the other. One call in
+// 2^CLASSIFIER_METRICS_SAMPLE_SHIFT per kind is also timed until
+// destruction. The unsampled path is one or two TLS counter bumps and a
+// test, and only a pointer stays live across the scoring itself. A
+// thread's first call per model is always sampled, which is what attaches
+// its counters to a shard.
+class ScoringCall {
+public:
+    explicit ScoringCall(ModelTag tag) noexcept {
+        auto& counters = detail::scoring_counters;
+        std::uint64_t calls = counters.single_calls[tag.id()];
+        detail::relaxed_store(counters.single_calls[tag.id()], calls + 1);
+        if ((calls & sample_mask) == 0) [[unlikely]] {
+            sampled_ = detail::start_sample(tag.id());
+        }
+    }
+
+    ScoringCall(ModelTag tag, std::size_t rows) noexcept {
+        auto& counters = detail::scoring_counters;
+        std::uint64_t calls = counters.batch_calls[tag.id()];
+        detail::relaxed_store(counters.batch_calls[tag.id()], calls + 1);
+        detail::relaxed_add(counters.batch_rows[tag.id()], rows);
+        if ((calls & sample_mask) == 0) [[unlikely]] {
+            sampled_ = detail::start_sample(tag.id());
+        }
+    }
+
+    ~ScoringCall() {
+        if (sampled_ != nullptr) [[unlikely]] {
+            detail::finish_sample(*sampled_);
+        }
+    }
+
+    ScoringCall(ScoringCall const&) = delete;
+    ScoringCall& operator=(ScoringCall const&) = delete;
+
+private:
+    static constexpr std::uint64_t sample_mask =
+        (std::uint64_t(1) << CLASSIFIER_METRICS_SAMPLE_SHIFT) - 1;
+
+    detail::Shard* sampled_ = nullptr;
+};
+
+// Times one deserialize call and counts the bytes it reports via read().
+class ReadCall {
+public:
+    explicit ReadCall(detail::ReadSource source) noexcept
+        : shard_(detail::shard()), source_(static_cast<std::size_t>(source)),
+          started_(std::chrono::steady_clock::now()) {}
+
+    ~ReadCall() {
+        detail::relaxed_add(shard_.read_calls[source_], 1);
+        detail::relaxed_add(shard_.read_bytes[source_], bytes_);
+        shard_.read_latency[source_].record(std::chrono::steady_clock::now() - started_);
+    }
+
+    ReadCall(ReadCall const&) = delete;
+    ReadCall& operator=(ReadCall const&) = delete;
+
+    void read(std::streamsize bytes) noexcept { bytes_ += static_cast<std::uint64_t>(bytes); }
+
+private:
+    detail::Shard& shard_;
+    std::size_t source_;
+    std::uint64_t bytes_ = 0;
+    std::chrono::steady_clock::time_point started_;
+};
+
+// Times one training epoch.
+class EpochCall {
+public:
+    EpochCall() noexcept : started_(std::chrono::steady_clock::now()) {}
+    ~EpochCall() { detail::shard().epochs.record(std::chrono::steady_clock::now() - started_); }
+
+    EpochCall(EpochCall const&) = delete;
+    EpochCall& operator=(EpochCall const&) = delete;
+
+private:
+    std::chrono::steady_clock::time_point started_;
+};
+
+// Names a model id for snapshots; the same name gets the same id. Returns
+// 0 ("default") once max_models names are taken.
+inline ModelId register_model(std::string_view name) {
+    auto& r = detail::registry();
+    std::lock_guard lock(r.mutex);
+    for (std::size_t id = 0; id < max_models; ++id) {
+        if (r.names[id] == name) {
+            return static_cast<ModelId>(id);
+        }
+        if (r.names[id].empty()) {
+            r.names[id] = name;
+            return static_cast<ModelId>(id);
+        }
+    }
+    return 0;
+}
+
+// Sums every shard. Safe to call while other threads record.
+inline MetricsSnapshot snapshot() {
+    auto& r = detail::registry();
+    std::lock_guard lock(r.mutex);
+    MetricsSnapshot result{};
+    std::vector<ModelMetrics> models(max_models);
+    for (auto const& shard : r.shards) {
+        detail::ScoringCounters const* live = shard->live;
+        auto count = [&](auto member, std::size_t id) {
+            std::uint64_t total = (shard->retired.*member)[id];
+            return live != nullptr ? total + detail::relaxed_load((live->*member)[id]) : total;
+        };
+        using Counters = detail::ScoringCounters;
+        for (std::size_t id = 0; id < max_models; ++id) {
+            std::uint64_t single = count(&Counters::single_calls, id);
+            models[id].calls += single + count(&Counters::batch_calls, id);
+            models[id].rows += single + count(&Counters::batch_rows, id);
+            if (auto* histogram = shard->latency[id].load(std::memory_order_acquire)) {
+                models[id].latency.merge(histogram->snapshot());
+            }
+        }
+        ReadMetrics* reads[] = {&result.model_reads, &result.training_data_reads};
+        for (std::size_t source = 0; source < 2; ++source) {
+            reads[source]->calls += detail::relaxed_load(shard->read_calls[source]);
+            reads[source]->bytes += detail::relaxed_load(shard->read_bytes[source]);
+            reads[source]->latency.merge(shard->read_latency[source].snapshot());
+        }
+        result.epochs.merge(shard->epochs.snapshot());
+    }
+    for (std::size_t id = 0; id < max_models; ++id) {
+        if (models[id].calls > 0) {
+            models[id].id = static_cast<ModelId>(id);
+            models[id].name = r.names[id];
+            result.models.push_back(std::move(models[id]));
+        }
+    }
+    return result;
+}
+
+#else
+
+struct ModelTag {
+    void set(ModelId) noexcept {}
+    ModelId id() const noexcept { return 0; }
+};
+
+struct ScoringCall {
+    explicit ScoringCall(ModelTag) noexcept {}
+    ScoringCall(ModelTag, std::size_t) noexcept {}
+};
+
+namespace detail {
+enum class ReadSource { model, training_data };
+} // namespace detail
+
+struct ReadCall {
+    explicit ReadCall(detail::ReadSource) noexcept {}
+    void read(std::streamsize) noexcept {}
+};
+
+struct EpochCall {};
+
+inline ModelId register_model(std::string_view) { return 0; }
+inline MetricsSnapshot snapshot() { return {}; }
+
+#endif
+
+// Writes a snapshot in the Prometheus text exposition format: counters,
+// plus latency summaries with p50/p90/p99/max in seconds.
+inline void write_text(std::ostream& os, MetricsSnapshot const& snapshot) {
+    auto summary = [&](std::string_view name, std::string const& labels,
+                       LatencyHistogram const& histogram) {
+        std::string open = labels.empty() ? "{" : "{" + labels + ",";
+        for (double q : {0.5, 0.9, 0.99, 1.0}) {
+            os << name << open << "quantile=\"" << q << "\"} "
+               << std::chrono::duration<double>(histogram.percentile(q)).count() << '\n';
+        }
+        std::string close = labels.empty() ? "" : "{" + labels + "}";
+        os << name << "_count" << close << ' ' << histogram.count() << '\n';
+    };
+
+    os << "# TYPE classifier_scoring_calls_total counter\n";
+    for (auto const& model : snapshot.models) {
+        os << "classifier_scoring_calls_total{model=\"" << model.name << "\"} " << model.calls
+           << '\n';
+    }
+    os << "# TYPE classifier_scoring_rows_total counter\n";
+    for (auto const& model : snapshot.models) {
+        os << "classifier_scoring_rows_total{model=\"" << model.name << "\"} " << model.rows
+           << '\n';
+    }
+    os << "# TYPE classifier_scoring_latency_seconds summary\n";
+    for (auto const& model : snapshot.models) {
+        summary("classifier_scoring_latency_seconds", "model=\"" + model.name + "\"",
+                model.latency);
+    }
+
+    std::pair<char const*, ReadMetrics const*> reads[] = {
+        {"model", &snapshot.model_reads}, {"training_data", &snapshot.training_data_reads}};
+    os << "# TYPE classifier_read_bytes_total counter\n";
+    for (auto [source, metrics] : reads) {
+        os << "classifier_read_bytes_total{source=\"" << source << "\"} " << metrics->bytes
+           << '\n';
+    }
+    os << "# TYPE classifier_read_latency_seconds summary\n";
+    for (auto [source, metrics] : reads) {
+        summary("classifier_read_latency_seconds", std::string("source=\"") + source + "\"",
+                metrics->latency);
+    }
+    os << "# TYPE classifier_epoch_seconds summary\n";
+    summary("classifier_epoch_seconds", "", snapshot.epochs);
+}
+
+} // namespace classifier::metrics
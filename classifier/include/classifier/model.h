@@ -1,11 +1,18 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <concepts>
 #include <cstddef>
 #include <istream>
 #include <ostream>
+#include <span>
 
+#include "classifier/kernels.h"
+#include "classifier/kernels_fixed.h"
 #include "classifier/math.h"
+#include "classifier/metrics.h"
+#include "classifier/sigmoid.h"
 
 namespace classifier {
 
@@ -16,30 +23,72 @@ struct Result {
     float confidence;
 };
 
-template <std::size_t N>
+template <std::size_t N, SigmoidPolicy Sigmoid = ExactSigmoid>
 class Model {
 public:
     Model() noexcept : weights_{}, bias_(0.0f) {}
 
     Result classify(std::array<float, N> const& features) const noexcept {
+        metrics::ScoringCall call(metrics_);
         if constexpr (N == 0) {
             return {Prediction::unknown, 0.0f};
+        } else if constexpr (N <= kernels::unroll_limit) {
+            float z = kernels::dot_fixed<N>(weights_.data(), features.data());
+            return to_result(Sigmoid::apply(z + bias_));
         } else {
-            float score = math::sigmoid(math::dot(weights_, features) + bias_);
-            if (score >= 0.5f) {
-                return {Prediction::positive, score};
+            return to_result(Sigmoid::apply(math::dot(weights_, features) + bias_));
+        }
+    }
+
+    // Scores `scores.size()` contiguous row-major feature rows in one pass.
+    Error score_batch(std::span<float const> features, std::span<float> scores) const noexcept {
+        if (features.size() != scores.size() * N) {
+            return Error::size_mismatch;
+        }
+        metrics::ScoringCall call(metrics_, scores.size());
+        if constexpr (N == 0) {
+            std::fill(scores.begin(), scores.end(), 0.0f);
+        } else {
+            score_rows(features.data(), scores.size(), scores.data());
+        }
+        return Error::none;
+    }
+
+    Error classify_batch(std::span<float const> features, std::span<Result> results) const noexcept {
+        if (features.size() != results.size() * N) {
+            return Error::size_mismatch;
+        }
+        metrics::ScoringCall call(metrics_, results.size());
+        if constexpr (N == 0) {
+            std::fill(results.begin(), results.end(), Result{Prediction::unknown, 0.0f});
+        } else {
+            float scores[kernels::detail::block_rows];
+            for (std::size_t r = 0; r < results.size(); r += std::size(scores)) {
+                std::size_t count = std::min(std::size(scores), results.size() - r);
+                score_rows(features.data() + r * N, count, scores);
+                for (std::size_t i = 0; i < count; ++i) {
+                    results[r + i] = to_result(scores[i]);
+                }
             }
-            return {Prediction::negative, 1.0f - score};
         }
+        return Error::none;
     }
 
     float weight(std::size_t index) const noexcept { return weights_[index]; }
     void set_weight(std::size_t index, float value) noexcept { weights_[index] = value; }
     static constexpr std::size_t weight_count() noexcept { return N; }
+    std::span<float const, N> weights() const noexcept { return weights_; }
+    std::span<float, N> weights() noexcept { return weights_; }
 
     float bias() const noexcept { return bias_; }
     void set_bias(float value) noexcept { bias_ = value; }
 
+    // Which metrics::register_model() id this model's scoring calls count
+    // against; ids from max_models up count against 0. Always 0 when
+    // metrics are compiled out.
+    void set_metrics_id(metrics::ModelId id) noexcept { metrics_.set(id); }
+    metrics::ModelId metrics_id() const noexcept { return metrics_.id(); }
+
     Error serialize(std::ostream& os) const noexcept {
         std::size_t n = N;
         os.write(reinterpret_cast<char const*>(&n), sizeof(n));
@@ -52,8 +101,10 @@ public:
     }
 
     Error deserialize(std::istream& is) noexcept {
+        metrics::ReadCall call(metrics::detail::ReadSource::model);
         std::size_t n = 0;
         is.read(reinterpret_cast<char*>(&n), sizeof(n));
+        call.read(is.gcount());
         if (!is) {
             return Error::io_failed;
         }
@@ -61,7 +112,9 @@ public:
             return Error::dimension_mismatch;
         }
         is.read(reinterpret_cast<char*>(weights_.data()), sizeof(float) * N);
+        call.read(is.gcount());
         is.read(reinterpret_cast<char*>(&bias_), sizeof(bias_));
+        call.read(is.gcount());
         if (!is) {
             return Error::io_failed;
         }
@@ -69,8 +122,27 @@ public:
     }
 
 private:
+    // The exact policy keeps the fused dot-and-sigmoid kernel; other policies
+    // run their own batch sigmoid over the linear outputs.
+    void score_rows(float const* rows, std::size_t count, float* out) const noexcept {
+        if constexpr (std::same_as<Sigmoid, ExactSigmoid>) {
+            kernels::score_rows(weights_.data(), N, bias_, rows, count, out);
+        } else {
+            kernels::linear_rows(weights_.data(), N, bias_, rows, count, out);
+            Sigmoid::apply_inplace(out, count);
+        }
+    }
+
+    static Result to_result(float score) noexcept {
+        if (score >= 0.5f) {
+            return {Prediction::positive, score};
+        }
+        return {Prediction::negative, 1.0f - score};
+    }
+
     std::array<float, N> weights_;
     float bias_;
+    [[no_unique_address]] metrics::ModelTag metrics_;
 };
 
 } // namespace classifier
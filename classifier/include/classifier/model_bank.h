@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "classifier/aligned.h"
+#include "classifier/kernels.h"
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/sigmoid.h"
+
+namespace classifier {
+
+// Many binary models over the same N features, scored together. Model m's
+// weights are column m of one N x stride() feature-major block, the
+// MulticlassModel layout, with stride() a multiple of 16 so every feature's
+// row starts on a cache line. A feature vector is read once for all the
+// models, and a batch is scored four rows at a time per block of columns.
+//
+// Columns [0, size()) hold live models. add() fills the next one, doubling
+// the block when it is full, and remove() moves the last column into the
+// freed one; neither rewrites the other models. Models are named by the id
+// add() returns, stable until removed and then reused; ids() lists them in
+// column order, the order scores come out in.
+template <std::size_t N, SigmoidPolicy Sigmoid = ExactSigmoid>
+class ModelBank {
+public:
+    using Id = std::uint32_t;
+
+    // What column() returns for an id the bank does not hold.
+    static constexpr std::size_t npos = ~std::size_t(0);
+
+    ModelBank() = default;
+    explicit ModelBank(std::size_t capacity) { reserve(capacity); }
+
+    Id add(Model<N, Sigmoid> const& model) {
+        if (size() == stride_) {
+            reserve(std::max<std::size_t>(2 * stride_, 16));
+        }
+        Id id;
+        if (free_ids_.empty()) {
+            id = static_cast<Id>(column_of_.size());
+            column_of_.push_back(0);
+            // remove() pushes onto free_ids_ and must not allocate.
+            free_ids_.reserve(column_of_.size());
+        } else {
+            id = free_ids_.back();
+            free_ids_.pop_back();
+        }
+        std::size_t column = ids_.size();
+        ids_.push_back(id);
+        column_of_[id] = column;
+        store(column, model);
+        return id;
+    }
+
+    Error replace(Id id, Model<N, Sigmoid> const& model) noexcept {
+        if (!contains(id)) {
+            return Error::unknown_model;
+        }
+        store(column_of_[id], model);
+        return Error::none;
+    }
+
+    Error remove(Id id) noexcept {
+        if (!contains(id)) {
+            return Error::unknown_model;
+        }
+        std::size_t column = column_of_[id];
+        std::size_t last = ids_.size() - 1;
+        if (column != last) {
+            for (std::size_t i = 0; i < N; ++i) {
+                weights_[i * stride_ + column] = weights_[i * stride_ + last];
+            }
+            bias_[column] = bias_[last];
+            ids_[column] = ids_[last];
+            column_of_[ids_[column]] = column;
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            weights_[i * stride_ + last] = 0.0f;
+        }
+        bias_[last] = 0.0f;
+        ids_.pop_back();
+        column_of_[id] = npos;
+        free_ids_.push_back(id);
+        return Error::none;
+    }
+
+    Error get(Id id, Model<N, Sigmoid>& out) const noexcept {
+        if (!contains(id)) {
+            return Error::unknown_model;
+        }
+        std::size_t column = column_of_[id];
+        for (std::size_t i = 0; i < N; ++i) {
+            out.set_weight(i, weights_[i * stride_ + column]);
+        }
+        out.set_bias(bias_[column]);
+        return Error::none;
+    }
+
+    bool contains(Id id) const noexcept {
+        return id < column_of_.size() && column_of_[id] != npos;
+    }
+
+    std::size_t size() const noexcept { return ids_.size(); }
+    std::size_t stride() const noexcept { return stride_; }
+    std::span<Id const> ids() const noexcept { return ids_; }
+    std::size_t column(Id id) const noexcept {
+        return id < column_of_.size() ? column_of_[id] : npos;
+    }
+    static constexpr std::size_t weight_count() noexcept { return N; }
+
+    // Grows the block to hold `capacity` models without reallocating.
+    void reserve(std::size_t capacity) {
+        std::size_t stride = (capacity + 15) & ~std::size_t(15);
+        if (stride <= stride_) {
+            return;
+        }
+        AlignedVector<float> weights(N * stride, 0.0f);
+        AlignedVector<float> bias(stride, 0.0f);
+        for (std::size_t i = 0; i < N; ++i) {
+            std::copy_n(weights_.data() + i * stride_, size(), weights.data() + i * stride);
+        }
+        std::copy_n(bias_.data(), size(), bias.data());
+        weights_ = std::move(weights);
+        bias_ = std::move(bias);
+        stride_ = stride;
+        ids_.reserve(stride);
+    }
+
+    // Every model's probability for one row, in column order.
+    Error score(std::span<float const, N> features, std::span<float> scores) const noexcept {
+        if (scores.size() != size()) {
+            return Error::size_mismatch;
+        }
+        if (scores.empty()) {
+            return Error::none;
+        }
+        kernels::linear_classes_rows(weights_.data(), stride_, N, bias_.data(), features.data(), 1,
+                                     size(), scores.data(), size());
+        Sigmoid::apply_inplace(scores.data(), scores.size());
+        return Error::none;
+    }
+
+    // Rows of N features; scores is rows x size(), row-major.
+    Error score_batch(std::span<float const> features, std::span<float> scores) const noexcept {
+        std::size_t rows = N == 0 ? 0 : features.size() / N;
+        if (features.size() != rows * N || scores.size() != rows * size()) {
+            return Error::size_mismatch;
+        }
+        if (scores.empty()) {
+            return Error::none;
+        }
+        kernels::linear_classes_rows(weights_.data(), stride_, N, bias_.data(), features.data(),
+                                     rows, size(), scores.data(), size());
+        Sigmoid::apply_inplace(scores.data(), scores.size());
+        return Error::none;
+    }
+
+private:
+    void store(std::size_t column, Model<N, Sigmoid> const& model) noexcept {
+        for (std::size_t i = 0; i < N; ++i) {
+            weights_[i * stride_ + column] = model.weight(i);
+        }
+        bias_[column] = model.bias();
+    }
+
+    AlignedVector<float> weights_;
+    AlignedVector<float> bias_;
+    std::size_t stride_ = 0;
+    std::vector<Id> ids_;
+    std::vector<std::size_t> column_of_;
+    std::vector<Id> free_ids_;
+};
+
+} // namespace classifier
@@ -0,0 +1,393 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "classifier/aligned.h"
+#include "classifier/crc32c.h"
+#include "classifier/kernels.h"
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/stream_bounds.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CLASSIFIER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define CLASSIFIER_HAS_MMAP 0
+#endif
+
+namespace classifier {
+
+enum class ModelDtype : std::uint8_t { float32 = 0 };
+
+// How much of a model file open() checks: the header checksum only, which
+// costs the same for any model size, or the weights and metadata as well.
+enum class Verify { header, full };
+
+// Fixed 64-byte header of a model file. The weights follow at
+// weights_offset, a multiple of 64, so a page-aligned mapping of the file
+// leaves them cache-line aligned; the metadata bytes follow the weights.
+// All fields are in the writing host's byte order; byte_order reads back as
+// 0x01020304 only on a host of the same endianness.
+struct ModelFileHeader {
+    std::uint32_t magic;
+    std::uint16_t version;
+    ModelDtype dtype;
+    std::uint8_t reserved0;
+    std::uint32_t byte_order;
+    std::uint32_t alignment;
+    std::uint64_t dimension;
+    std::uint64_t weights_offset;
+    std::uint64_t metadata_size;
+    float bias;
+    // CRC32C of the weight and metadata bytes.
+    std::uint32_t payload_crc;
+    // CRC32C of this header with header_crc set to zero.
+    std::uint32_t header_crc;
+    std::uint32_t reserved1[3];
+};
+
+static_assert(sizeof(ModelFileHeader) == 64);
+
+namespace detail {
+
+inline constexpr std::uint32_t model_file_magic = 0x464d4c43; // "CLMF"
+inline constexpr std::uint16_t model_file_version = 1;
+inline constexpr std::uint32_t model_file_byte_order = 0x01020304;
+inline constexpr std::uint32_t model_file_alignment = 64;
+// Bounds that keep size arithmetic from overflowing and a stream reader from
+// allocating on a forged header.
+inline constexpr std::uint64_t max_model_file_dimension = std::uint64_t(1) << 40;
+inline constexpr std::uint64_t max_model_file_metadata = std::uint64_t(1) << 24;
+
+inline std::uint32_t header_crc(ModelFileHeader header) noexcept {
+    header.header_crc = 0;
+    return crc32c(&header, sizeof(header));
+}
+
+// Checks the fields that do not depend on the file size.
+inline Error check_header(ModelFileHeader const& header) noexcept {
+    if (header.magic != model_file_magic || header.byte_order != model_file_byte_order ||
+        header.version != model_file_version || header.dtype != ModelDtype::float32 ||
+        header.alignment != model_file_alignment || header.header_crc != header_crc(header)) {
+        return Error::invalid_format;
+    }
+    if (header.weights_offset < sizeof(ModelFileHeader) ||
+        header.weights_offset % model_file_alignment != 0 ||
+        header.dimension > max_model_file_dimension ||
+        header.metadata_size > max_model_file_metadata) {
+        return Error::invalid_format;
+    }
+    return Error::none;
+}
+
+// Bytes of weights and metadata after weights_offset. check_header bounds
+// both fields, so this cannot overflow.
+inline std::uint64_t payload_size(ModelFileHeader const& header) noexcept {
+    return header.dimension * sizeof(float) + header.metadata_size;
+}
+
+// Whether a file of `length` bytes ends exactly where the header says the
+// metadata does. Subtracts from the length instead of adding weights_offset
+// to the payload, so a forged offset cannot wrap the sum around to `length`.
+inline bool matches_length(ModelFileHeader const& header, std::uint64_t length) noexcept {
+    return header.weights_offset <= length &&
+           length - header.weights_offset == payload_size(header);
+}
+
+} // namespace detail
+
+// Writes the versioned container: header, weights at offset 64, metadata.
+inline Error write_model_file(std::ostream& os, std::span<float const> weights, float bias,
+                              std::string_view metadata = {}) noexcept {
+    if (metadata.size() > detail::max_model_file_metadata) {
+        return Error::invalid_format;
+    }
+    ModelFileHeader header{};
+    header.magic = detail::model_file_magic;
+    header.version = detail::model_file_version;
+    header.dtype = ModelDtype::float32;
+    header.byte_order = detail::model_file_byte_order;
+    header.alignment = detail::model_file_alignment;
+    header.dimension = weights.size();
+    header.weights_offset = sizeof(ModelFileHeader);
+    header.metadata_size = metadata.size();
+    header.bias = bias;
+    header.payload_crc = crc32c(metadata.data(), metadata.size(),
+                                crc32c(weights.data(), weights.size_bytes()));
+    header.header_crc = detail::header_crc(header);
+
+    os.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    os.write(reinterpret_cast<char const*>(weights.data()),
+             static_cast<std::streamsize>(weights.size_bytes()));
+    os.write(metadata.data(), static_cast<std::streamsize>(metadata.size()));
+    if (!os) {
+        return Error::io_failed;
+    }
+    return Error::none;
+}
+
+template <std::size_t N, SigmoidPolicy Sigmoid>
+Error write_model_file(std::ostream& os, Model<N, Sigmoid> const& model,
+                       std::string_view metadata = {}) noexcept {
+    return write_model_file(os, model.weights(), model.bias(), metadata);
+}
+
+// Reads either the versioned container, verifying both checksums, or the
+// legacy Model<N>::serialize layout. A file is taken as versioned when it
+// starts with the magic; a legacy file would need a dimension above 10^9
+// to collide with it.
+template <std::size_t N, SigmoidPolicy Sigmoid>
+Error read_model_file(std::istream& is, Model<N, Sigmoid>& model,
+                      std::string* metadata = nullptr) noexcept {
+    std::uint32_t magic = 0;
+    is.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    if (!is) {
+        return Error::io_failed;
+    }
+    is.seekg(-static_cast<std::streamoff>(sizeof(magic)), std::ios::cur);
+    if (!is) {
+        return Error::io_failed;
+    }
+    if (magic != detail::model_file_magic) {
+        if (metadata != nullptr) {
+            metadata->clear();
+        }
+        return model.deserialize(is);
+    }
+
+    ModelFileHeader header{};
+    is.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!is) {
+        return Error::io_failed;
+    }
+    if (Error error = detail::check_header(header); error != Error::none) {
+        return error;
+    }
+    if (header.dimension != N) {
+        return Error::dimension_mismatch;
+    }
+
+    std::uint64_t padding = header.weights_offset - sizeof(header);
+    std::uint64_t remaining = detail::remaining_bytes(is);
+    if (padding > remaining || remaining - padding < detail::payload_size(header)) {
+        return Error::io_failed;
+    }
+    is.ignore(static_cast<std::streamsize>(padding));
+    AlignedVector<float> weights(N);
+    std::string bytes(header.metadata_size, '\0');
+    is.read(reinterpret_cast<char*>(weights.data()), sizeof(float) * N);
+    is.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if (!is) {
+        return Error::io_failed;
+    }
+    if (crc32c(bytes.data(), bytes.size(), crc32c(weights.data(), sizeof(float) * N)) !=
+        header.payload_crc) {
+        return Error::invalid_format;
+    }
+
+    std::copy(weights.begin(), weights.end(), model.weights().begin());
+    model.set_bias(header.bias);
+    if (metadata != nullptr) {
+        *metadata = std::move(bytes);
+    }
+    return Error::none;
+}
+
+// Read-only model scored in place from a shared mapping of its file, so
+// every process that opens the same file shares one page-cache copy. Opens
+// both the versioned container, with 64-byte-aligned weights, and the
+// legacy layout, whose weights sit at offset 8 and carry no checksum.
+class MappedModel {
+public:
+    MappedModel() noexcept = default;
+    ~MappedModel() { close(); }
+
+    MappedModel(MappedModel&& other) noexcept
+        : mapping_(std::exchange(other.mapping_, nullptr)),
+          length_(std::exchange(other.length_, 0)),
+          weights_(std::exchange(other.weights_, {})),
+          metadata_(std::exchange(other.metadata_, {})),
+          bias_(std::exchange(other.bias_, 0.0f)) {}
+
+    MappedModel& operator=(MappedModel&& other) noexcept {
+        if (this != &other) {
+            close();
+            mapping_ = std::exchange(other.mapping_, nullptr);
+            length_ = std::exchange(other.length_, 0);
+            weights_ = std::exchange(other.weights_, {});
+            metadata_ = std::exchange(other.metadata_, {});
+            bias_ = std::exchange(other.bias_, 0.0f);
+        }
+        return *this;
+    }
+
+    MappedModel(MappedModel const&) = delete;
+    MappedModel& operator=(MappedModel const&) = delete;
+
+    Error open(char const* path, Verify verify = Verify::full) noexcept {
+        close();
+#if CLASSIFIER_HAS_MMAP
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return Error::io_failed;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return Error::io_failed;
+        }
+        auto length = static_cast<std::size_t>(st.st_size);
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return Error::io_failed;
+        }
+        mapping_ = mapping;
+        length_ = length;
+
+        Error error = parse(verify);
+        if (error != Error::none) {
+            close();
+        }
+        return error;
+#else
+        (void)path;
+        (void)verify;
+        return Error::io_failed;
+#endif
+    }
+
+    void close() noexcept {
+#if CLASSIFIER_HAS_MMAP
+        if (mapping_ != nullptr) {
+            ::munmap(mapping_, length_);
+        }
+#endif
+        mapping_ = nullptr;
+        length_ = 0;
+        weights_ = {};
+        metadata_ = {};
+        bias_ = 0.0f;
+    }
+
+    bool is_open() const noexcept { return mapping_ != nullptr; }
+
+    std::size_t weight_count() const noexcept { return weights_.size(); }
+    std::span<float const> weights() const noexcept { return weights_; }
+    float bias() const noexcept { return bias_; }
+    std::string_view metadata() const noexcept { return metadata_; }
+
+    Error classify(std::span<float const> features, Result& result) const noexcept {
+        float score = 0.0f;
+        if (Error error = score_batch(features, {&score, 1}); error != Error::none) {
+            return error;
+        }
+        if (weights_.empty()) {
+            result = {Prediction::unknown, 0.0f};
+        } else if (score >= 0.5f) {
+            result = {Prediction::positive, score};
+        } else {
+            result = {Prediction::negative, 1.0f - score};
+        }
+        return Error::none;
+    }
+
+    Error score_batch(std::span<float const> features, std::span<float> scores) const noexcept {
+        if (features.size() != scores.size() * weights_.size()) {
+            return Error::size_mismatch;
+        }
+        if (weights_.empty()) {
+            std::fill(scores.begin(), scores.end(), 0.0f);
+        } else {
+            kernels::score_rows(weights_.data(), weights_.size(), bias_, features.data(),
+                                scores.size(), scores.data());
+        }
+        return Error::none;
+    }
+
+    template <std::size_t N, SigmoidPolicy Sigmoid>
+    Error to(Model<N, Sigmoid>& model) const noexcept {
+        if (weights_.size() != N) {
+            return Error::dimension_mismatch;
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            model.set_weight(i, weights_[i]);
+        }
+        model.set_bias(bias_);
+        return Error::none;
+    }
+
+private:
+    Error parse(Verify verify) noexcept {
+        auto const* bytes = static_cast<unsigned char const*>(mapping_);
+        std::uint32_t magic = 0;
+        if (length_ >= sizeof(magic)) {
+            std::memcpy(&magic, bytes, sizeof(magic));
+        }
+        if (magic != detail::model_file_magic) {
+            return parse_legacy(bytes);
+        }
+
+        if (length_ < sizeof(ModelFileHeader)) {
+            return Error::invalid_format;
+        }
+        ModelFileHeader header;
+        std::memcpy(&header, bytes, sizeof(header));
+        if (Error error = detail::check_header(header); error != Error::none) {
+            return error;
+        }
+        if (!detail::matches_length(header, length_)) {
+            return Error::invalid_format;
+        }
+        std::size_t payload = length_ - header.weights_offset;
+        if (verify == Verify::full &&
+            crc32c(bytes + header.weights_offset, payload) != header.payload_crc) {
+            return Error::invalid_format;
+        }
+
+        weights_ = {reinterpret_cast<float const*>(bytes + header.weights_offset),
+                    static_cast<std::size_t>(header.dimension)};
+        metadata_ = {reinterpret_cast<char const*>(bytes + header.weights_offset) +
+                         weights_.size_bytes(),
+                     static_cast<std::size_t>(header.metadata_size)};
+        bias_ = header.bias;
+        return Error::none;
+    }
+
+    // [size_t n][n floats][float bias], as written by Model<N>::serialize.
+    Error parse_legacy(unsigned char const* bytes) noexcept {
+        std::size_t n = 0;
+        if (length_ < sizeof(n) + sizeof(float)) {
+            return Error::invalid_format;
+        }
+        std::memcpy(&n, bytes, sizeof(n));
+        if (n > (length_ - sizeof(n) - sizeof(float)) / sizeof(float) ||
+            sizeof(n) + (n + 1) * sizeof(float) != length_) {
+            return Error::invalid_format;
+        }
+        weights_ = {reinterpret_cast<float const*>(bytes + sizeof(n)), n};
+        std::memcpy(&bias_, bytes + sizeof(n) + n * sizeof(float), sizeof(bias_));
+        return Error::none;
+    }
+
+    void* mapping_ = nullptr;
+    std::size_t length_ = 0;
+    std::span<float const> weights_;
+    std::string_view metadata_;
+    float bias_ = 0.0f;
+};
+
+} // namespace classifier
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "classifier/aligned.h"
+#include "classifier/math.h"
+
+namespace classifier {
+
+// Named, versioned models for live serving. Readers take snapshots without
+// locks or shared reference counts: each reader owns a padded slot in which
+// it announces the epoch it entered at, and publishers retire the registry
+// state they replace until every reader that might still see it has left.
+// Publishing, removal and reclamation serialize on a writer mutex that
+// readers never touch, and background loads run on the registry's own
+// thread. Readers beyond max_readers still work, but copy a reference count
+// under the writer mutex instead.
+template <typename M>
+class ModelRegistry {
+    struct Entry {
+        M model;
+        std::uint64_t version;
+    };
+    using State = std::map<std::string, std::shared_ptr<Entry const>, std::less<>>;
+
+    struct alignas(cache_line_size) ReaderSlot {
+        std::atomic<std::uint64_t> epoch{0};
+        std::atomic<bool> claimed{false};
+        std::size_t depth = 0;
+    };
+
+public:
+    // A model pinned for as long as the snapshot lives. Empty when the name
+    // was not registered.
+    class Snapshot {
+    public:
+        Snapshot() noexcept = default;
+        Snapshot(Snapshot&& other) noexcept
+            : slot_(std::exchange(other.slot_, nullptr)),
+              entry_(std::exchange(other.entry_, nullptr)),
+              shared_(std::move(other.shared_)) {}
+        Snapshot& operator=(Snapshot&& other) noexcept {
+            if (this != &other) {
+                release();
+                slot_ = std::exchange(other.slot_, nullptr);
+                entry_ = std::exchange(other.entry_, nullptr);
+                shared_ = std::move(other.shared_);
+            }
+            return *this;
+        }
+        ~Snapshot() { release(); }
+
+        explicit operator bool() const noexcept { return entry_ != nullptr; }
+        M const& operator*() const noexcept { return entry_->model; }
+        M const* operator->() const noexcept { return &entry_->model; }
+        std::uint64_t version() const noexcept { return entry_ == nullptr ? 0 : entry_->version; }
+
+    private:
+        friend class ModelRegistry;
+
+        Snapshot(ReaderSlot* slot, Entry const* entry) noexcept : slot_(slot), entry_(entry) {}
+        explicit Snapshot(std::shared_ptr<Entry const> shared) noexcept
+            : entry_(shared.get()), shared_(std::move(shared)) {}
+
+        void release() noexcept {
+            if (slot_ != nullptr && --slot_->depth == 0) {
+                slot_->epoch.store(0, std::memory_order_release);
+            }
+            slot_ = nullptr;
+            entry_ = nullptr;
+            shared_.reset();
+        }
+
+        ReaderSlot* slot_ = nullptr;
+        Entry const* entry_ = nullptr;
+        // Set instead of slot_ when taken by a reader without a slot.
+        std::shared_ptr<Entry const> shared_;
+    };
+
+    // One reader slot, to be used from a single thread at a time. When every
+    // slot was already claimed the reader has none and its snapshots take the
+    // writer mutex; see wait_free().
+    class Reader {
+    public:
+        Reader() noexcept = default;
+        Reader(Reader&& other) noexcept
+            : registry_(std::exchange(other.registry_, nullptr)),
+              slot_(std::exchange(other.slot_, nullptr)) {}
+        Reader& operator=(Reader&& other) noexcept {
+            if (this != &other) {
+                release();
+                registry_ = std::exchange(other.registry_, nullptr);
+                slot_ = std::exchange(other.slot_, nullptr);
+            }
+            return *this;
+        }
+        ~Reader() { release(); }
+
+        // False only for a default-constructed or moved-from reader.
+        bool valid() const noexcept { return registry_ != nullptr; }
+        // Whether this reader holds a slot, so that snapshot() never blocks.
+        bool wait_free() const noexcept { return slot_ != nullptr; }
+
+        // Wait-free with a slot: two stores and two loads on top of the name
+        // lookup. Without one it waits for any publish in progress.
+        Snapshot snapshot(std::string_view name) const noexcept {
+            if (slot_ == nullptr) {
+                return registry_ == nullptr ? Snapshot() : registry_->shared_snapshot(name);
+            }
+            if (slot_->depth++ == 0) {
+                slot_->epoch.store(registry_->epoch_.load(std::memory_order_seq_cst),
+                                   std::memory_order_seq_cst);
+            }
+            State const* state = registry_->state_.load(std::memory_order_seq_cst);
+            auto it = state->find(name);
+            return {slot_, it == state->end() ? nullptr : it->second.get()};
+        }
+
+    private:
+        friend class ModelRegistry;
+
+        Reader(ModelRegistry* registry, ReaderSlot* slot) noexcept
+            : registry_(registry), slot_(slot) {}
+
+        void release() noexcept {
+            if (slot_ != nullptr) {
+                slot_->claimed.store(false, std::memory_order_release);
+            }
+            registry_ = nullptr;
+            slot_ = nullptr;
+        }
+
+        ModelRegistry* registry_ = nullptr;
+        ReaderSlot* slot_ = nullptr;
+    };
+
+    using Loader = std::function<Error(M&)>;
+
+    explicit ModelRegistry(std::size_t max_readers = 64)
+        : slots_(max_readers), state_(new State()), loader_([this] { load_loop(); }) {}
+
+    // Readers and snapshots must be gone before the registry is destroyed.
+    ~ModelRegistry() {
+        {
+            std::lock_guard lock(jobs_mutex_);
+            stopping_ = true;
+        }
+        jobs_cv_.notify_all();
+        loader_.join();
+        for (auto& retired : retired_) {
+            delete retired.state;
+        }
+        delete state_.load();
+    }
+
+    ModelRegistry(ModelRegistry const&) = delete;
+    ModelRegistry& operator=(ModelRegistry const&) = delete;
+
+    Reader reader() noexcept {
+        for (auto& slot : slots_) {
+            bool expected = false;
+            if (!slot.claimed.load(std::memory_order_relaxed) &&
+                slot.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return {this, &slot};
+            }
+        }
+        return {this, nullptr};
+    }
+
+    // Makes `model` the current version of `name` and returns its version
+    // number, which increases across the whole registry.
+    std::uint64_t publish(std::string_view name, M model) {
+        std::lock_guard lock(writer_mutex_);
+        std::uint64_t version = ++last_version_;
+        auto next = std::make_unique<State>(*state_.load(std::memory_order_relaxed));
+        auto entry = std::make_shared<Entry const>(Entry{std::move(model), version});
+        if (auto it = next->find(name); it != next->end()) {
+            it->second = std::move(entry);
+        } else {
+            next->emplace(std::string(name), std::move(entry));
+        }
+        swap_state(std::move(next));
+        return version;
+    }
+
+    bool remove(std::string_view name) {
+        std::lock_guard lock(writer_mutex_);
+        State const& current = *state_.load(std::memory_order_relaxed);
+        auto found = current.find(name);
+        if (found == current.end()) {
+            return false;
+        }
+        auto next = std::make_unique<State>(current);
+        next->erase(found->first);
+        swap_state(std::move(next));
+        return true;
+    }
+
+    // Runs `loader` on the background thread into a fresh M and publishes
+    // the result under `name` if it returns Error::none.
+    std::future<Error> load(std::string name, Loader loader) {
+        std::promise<Error> done;
+        auto result = done.get_future();
+        {
+            std::lock_guard lock(jobs_mutex_);
+            jobs_.push_back({std::move(name), std::move(loader), std::move(done)});
+        }
+        jobs_cv_.notify_one();
+        return result;
+    }
+
+    // Frees retired states that no reader can still be using. Publishing and
+    // removal call this too.
+    void reclaim() {
+        std::lock_guard lock(writer_mutex_);
+        reclaim_locked();
+    }
+
+    std::size_t pending_reclamation() const {
+        std::lock_guard lock(writer_mutex_);
+        return retired_.size();
+    }
+
+private:
+    struct Retired {
+        State const* state;
+        std::uint64_t epoch;
+    };
+
+    struct Job {
+        std::string name;
+        Loader loader;
+        std::promise<Error> done;
+    };
+
+    // States are only retired under the writer mutex, so holding it pins the
+    // current one long enough to copy an entry's reference count.
+    Snapshot shared_snapshot(std::string_view name) const noexcept {
+        std::lock_guard lock(writer_mutex_);
+        State const& current = *state_.load(std::memory_order_relaxed);
+        auto it = current.find(name);
+        return Snapshot(it == current.end() ? nullptr : it->second);
+    }
+
+    // A reader that announced epoch e <= retired.epoch may have loaded the
+    // retired state; one that announced a later epoch read the epoch after
+    // the swap and so sees the newer state.
+    void swap_state(std::unique_ptr<State> next) {
+        State const* previous = state_.exchange(next.release(), std::memory_order_seq_cst);
+        retired_.push_back({previous, epoch_.fetch_add(1, std::memory_order_seq_cst)});
+        reclaim_locked();
+    }
+
+    void reclaim_locked() {
+        std::uint64_t oldest = UINT64_MAX;
+        for (auto const& slot : slots_) {
+            std::uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+            if (epoch != 0 && epoch < oldest) {
+                oldest = epoch;
+            }
+        }
+        std::erase_if(retired_, [oldest](Retired const& retired) {
+            if (retired.epoch < oldest) {
+                delete retired.state;
+                return true;
+            }
+            return false;
+        });
+    }
+
+    void load_loop() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock lock(jobs_mutex_);
+                jobs_cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                if (jobs_.empty()) {
+                    return;
+                }
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            M model{};
+            Error error = job.loader(model);
+            if (error == Error::none) {
+                publish(job.name, std::move(model));
+            }
+            job.done.set_value(error);
+        }
+    }
+
+    std::vector<ReaderSlot> slots_;
+    std::atomic<std::uint64_t> epoch_{1};
+    std::atomic<State const*> state_;
+
+    mutable std::mutex writer_mutex_;
+    std::vector<Retired> retired_;
+    std::uint64_t last_version_ = 0;
+
+    std::mutex jobs_mutex_;
+    std::condition_variable jobs_cv_;
+    std::deque<Job> jobs_;
+    bool stopping_ = false;
+    std::thread loader_;
+};
+
+} // namespace classifier
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/sigmoid.h"
+#include "classifier/thread_pool.h"
+#include "classifier/trainer.h"
+
+namespace classifier {
+
+// The arguments of Trainer::train that a search chooses between.
+struct Hyperparameters {
+    float learning_rate = 0.1f;
+    std::size_t epochs = 100;
+    Regularization regularization = Regularization::none;
+    float regularization_strength = 0.0f;
+};
+
+// Values to try for each hyperparameter; grid() takes every combination.
+struct SearchGrid {
+    std::vector<float> learning_rates{0.1f};
+    std::vector<std::size_t> epochs{100};
+    std::vector<Regularization> regularizations{Regularization::none};
+    std::vector<float> regularization_strengths{0.0f};
+};
+
+// Ranges random_search() samples from: learning rates and strengths
+// log-uniformly, epochs uniformly, the regularization kind uniformly from the
+// list. Candidates with Regularization::none get a strength of 0.
+struct SearchRanges {
+    float min_learning_rate = 1e-3f;
+    float max_learning_rate = 1.0f;
+    std::size_t min_epochs = 10;
+    std::size_t max_epochs = 200;
+    std::vector<Regularization> regularizations{Regularization::none, Regularization::l1,
+                                                Regularization::l2};
+    float min_regularization_strength = 1e-6f;
+    float max_regularization_strength = 1e-1f;
+
+    // Every minimum is at most its maximum, and the log-uniform ranges are
+    // positive.
+    bool valid() const noexcept {
+        return min_learning_rate > 0.0f && max_learning_rate >= min_learning_rate &&
+               min_epochs <= max_epochs && min_regularization_strength > 0.0f &&
+               max_regularization_strength >= min_regularization_strength &&
+               std::isfinite(max_learning_rate) && std::isfinite(max_regularization_strength);
+    }
+};
+
+// Candidates ordered with the learning rate varying slowest and the
+// regularization strength fastest.
+inline std::vector<Hyperparameters> grid(SearchGrid const& space) {
+    std::vector<Hyperparameters> candidates;
+    for (float learning_rate : space.learning_rates) {
+        for (std::size_t epochs : space.epochs) {
+            for (Regularization regularization : space.regularizations) {
+                for (float strength : space.regularization_strengths) {
+                    candidates.push_back({learning_rate, epochs, regularization, strength});
+                }
+            }
+        }
+    }
+    return candidates;
+}
+
+// `count` candidates drawn from `ranges`; the same seed gives the same list.
+// Empty when the ranges are not valid(), which cross_validate() reports as
+// Error::empty_search_space.
+inline std::vector<Hyperparameters> random_search(SearchRanges const& ranges, std::size_t count,
+                                                  std::uint64_t seed = 0) {
+    if (!ranges.valid()) {
+        return {};
+    }
+    std::mt19937_64 rng(seed);
+    auto uniform = [&] { return static_cast<double>(rng() >> 11) * 0x1.0p-53; };
+    auto log_uniform = [&](float low, float high) {
+        double log_low = std::log(static_cast<double>(low));
+        double log_high = std::log(static_cast<double>(high));
+        return static_cast<float>(std::exp(log_low + (log_high - log_low) * uniform()));
+    };
+
+    std::vector<Hyperparameters> candidates(count);
+    for (auto& candidate : candidates) {
+        candidate.learning_rate = log_uniform(ranges.min_learning_rate, ranges.max_learning_rate);
+        // Wraps to 0 only when the range covers every std::size_t.
+        std::size_t span = ranges.max_epochs - ranges.min_epochs + 1;
+        candidate.epochs =
+            ranges.min_epochs + static_cast<std::size_t>(span == 0 ? rng() : rng() % span);
+        if (!ranges.regularizations.empty()) {
+            candidate.regularization =
+                ranges.regularizations[rng() % ranges.regularizations.size()];
+        }
+        if (candidate.regularization != Regularization::none) {
+            candidate.regularization_strength = log_uniform(
+                ranges.min_regularization_strength, ranges.max_regularization_strength);
+        }
+    }
+    return candidates;
+}
+
+struct CrossValidationOptions {
+    std::size_t folds = 5;
+    // Assign rows to folds in a seeded random order rather than in order.
+    bool shuffle = true;
+    std::uint64_t seed = 0;
+    // 0 uses one thread per hardware thread.
+    std::size_t threads = 0;
+};
+
+// Held-out metrics of one candidate over the folds. The std fields are
+// sample standard deviations across folds. AUC is NaN if any validation
+// fold holds a single class.
+struct CrossValidationScore {
+    Hyperparameters hyperparameters;
+    double mean_log_loss;
+    double std_log_loss;
+    double mean_auc;
+    double std_auc;
+};
+
+template <std::size_t N, SigmoidPolicy Sigmoid = ExactSigmoid>
+struct SearchResult {
+    // One per candidate, in candidate order.
+    std::vector<CrossValidationScore> scores;
+    // Index of the candidate with the lowest mean log-loss; candidates that
+    // diverged to NaN only win if all did.
+    std::size_t best = 0;
+    // The best candidate retrained on all of the data.
+    Model<N, Sigmoid> model;
+};
+
+namespace detail {
+
+// ROC AUC from the Mann-Whitney rank sum, with tied scores sharing their
+// mean rank. Sorts `scored` (score, label) in place.
+inline double roc_auc(std::vector<std::pair<float, float>>& scored) noexcept {
+    std::sort(scored.begin(), scored.end(),
+              [](auto const& a, auto const& b) { return a.first < b.first; });
+    double positives = 0.0;
+    double rank_sum = 0.0;
+    for (std::size_t i = 0; i < scored.size();) {
+        std::size_t j = i;
+        double tied_positives = 0.0;
+        for (; j < scored.size() && scored[j].first == scored[i].first; ++j) {
+            tied_positives += scored[j].second > 0.5f ? 1.0 : 0.0;
+        }
+        // Ranks i + 1 .. j.
+        rank_sum += tied_positives * (static_cast<double>(i + 1 + j) / 2.0);
+        positives += tied_positives;
+        i = j;
+    }
+    double negatives = static_cast<double>(scored.size()) - positives;
+    if (positives == 0.0 || negatives == 0.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return (rank_sum - positives * (positives + 1.0) / 2.0) / (positives * negatives);
+}
+
+inline std::pair<double, double> mean_and_std(std::span<double const> values) noexcept {
+    double mean = 0.0;
+    for (double v : values) {
+        mean += v;
+    }
+    mean /= static_cast<double>(values.size());
+    double squares = 0.0;
+    for (double v : values) {
+        squares += (v - mean) * (v - mean);
+    }
+    double deviation =
+        values.size() > 1 ? std::sqrt(squares / static_cast<double>(values.size() - 1)) : 0.0;
+    return {mean, deviation};
+}
+
+} // namespace detail
+
+// k-fold cross-validation of Trainer<N, Sigmoid>::train for every candidate,
+// and a final refit of the best one on all of `data`. The rows are assigned
+// to folds once; each (candidate, fold) pair is an independent task on a
+// work-stealing pool. Tasks share `data` read-only and see their training
+// and validation rows as index views, so nothing is copied per fold. Each
+// task writes only its own result slot, so the scores do not depend on the
+// thread count or on which thread ran what.
+template <std::size_t N, SigmoidPolicy Sigmoid = ExactSigmoid>
+Error cross_validate(std::span<typename Trainer<N, Sigmoid>::Sample const> data,
+                     std::span<Hyperparameters const> candidates,
+                     CrossValidationOptions const& options,
+                     SearchResult<N, Sigmoid>& result) noexcept {
+    if (data.empty()) {
+        return Error::empty_training_set;
+    }
+    if (options.folds < 2 || options.folds > data.size()) {
+        return Error::invalid_fold_count;
+    }
+    if (candidates.empty()) {
+        return Error::empty_search_space;
+    }
+    for (auto const& candidate : candidates) {
+        if (candidate.regularization_strength < 0.0f) {
+            return Error::invalid_regularization_strength;
+        }
+    }
+
+    // The row order written out twice: fold f validates on rows
+    // [begin, end) of it and trains on [end, begin + n), which is contiguous
+    // in the doubled copy.
+    std::size_t const n = data.size();
+    std::size_t const folds = options.folds;
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    if (options.shuffle) {
+        std::mt19937_64 rng(options.seed);
+        detail::shuffle(order, rng);
+    }
+    order.resize(2 * n);
+    std::copy_n(order.begin(), n, order.begin() + static_cast<std::ptrdiff_t>(n));
+    std::span<std::size_t const> rows = order;
+
+    std::vector<double> log_losses(candidates.size() * folds);
+    std::vector<double> aucs(candidates.size() * folds);
+    std::size_t threads = options.threads == 0 ? ThreadPool::default_size() : options.threads;
+    ThreadPool pool(std::min(threads, log_losses.size()));
+    std::vector<std::vector<std::pair<float, float>>> scratch(pool.size());
+
+    pool.run_tasks(log_losses.size(), [&](std::size_t task, std::size_t t) {
+        Hyperparameters const& candidate = candidates[task / folds];
+        std::size_t fold = task % folds;
+        std::size_t begin = n * fold / folds;
+        std::size_t end = n * (fold + 1) / folds;
+
+        Model<N, Sigmoid> model;
+        Trainer<N, Sigmoid> trainer(model);
+        trainer.train(data, rows.subspan(end, n - (end - begin)), candidate.learning_rate,
+                      candidate.epochs, candidate.regularization,
+                      candidate.regularization_strength);
+
+        auto& scored = scratch[t];
+        scored.clear();
+        std::span<float const, N> weights = model.weights();
+        double loss = 0.0;
+        for (std::size_t row : rows.subspan(begin, end - begin)) {
+            auto const& sample = data[row];
+            float z = math::dot(weights, std::span<float const, N>(sample.data(), N));
+            z += model.bias();
+            loss += math::logistic_loss(z, sample[N]);
+            scored.emplace_back(z, sample[N]);
+        }
+        log_losses[task] = loss / static_cast<double>(end - begin);
+        aucs[task] = detail::roc_auc(scored);
+    });
+
+    result.scores.clear();
+    result.best = 0;
+    for (std::size_t c = 0; c < candidates.size(); ++c) {
+        auto [mean_loss, std_loss] =
+            detail::mean_and_std(std::span<double const>(log_losses).subspan(c * folds, folds));
+        auto [mean_auc, std_auc] =
+            detail::mean_and_std(std::span<double const>(aucs).subspan(c * folds, folds));
+        result.scores.push_back({candidates[c], mean_loss, std_loss, mean_auc, std_auc});
+        double best_loss = result.scores[result.best].mean_log_loss;
+        if (std::isnan(best_loss) || mean_loss < best_loss) {
+            result.best = c;
+        }
+    }
+
+    Hyperparameters const& best = candidates[result.best];
+    result.model = Model<N, Sigmoid>{};
+    Trainer<N, Sigmoid> trainer(result.model);
+    return trainer.train(data, best.learning_rate, best.epochs, best.regularization,
+                         best.regularization_strength);
+}
+
+} // namespace classifier
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+
+#include "classifier/aligned.h"
+#include "classifier/kernels.h"
+#include "classifier/math.h"
+#include "classifier/model.h"
+
+namespace classifier {
+
+// softmax: one distribution over the K classes. one_vs_rest: K independent
+// binary models, each class's probability its own sigmoid.
+enum class MulticlassMode : std::uint32_t { softmax, one_vs_rest };
+
+struct MulticlassResult {
+    std::size_t label;
+    float probability;
+};
+
+// K-class linear model. The K x N weights live in one aligned block stored
+// feature-major, with each feature's K weights padded to a multiple of 16,
+// so all K logits come out of a single pass over the features.
+template <std::size_t K, std::size_t N>
+class MulticlassModel {
+    static_assert(K >= 2, "use Model<N> for a single class");
+
+public:
+    // Padded class count: the stride between consecutive features' weights.
+    static constexpr std::size_t class_stride = (K + 15) & ~std::size_t(15);
+
+    explicit MulticlassModel(MulticlassMode mode = MulticlassMode::softmax)
+        : weights_(N * class_stride, 0.0f), bias_(class_stride, 0.0f), mode_(mode) {}
+
+    // One-vs-rest model from K binary models, class k scored by models[k].
+    template <SigmoidPolicy Sigmoid>
+    static MulticlassModel one_vs_rest(std::span<Model<N, Sigmoid> const, K> models) {
+        MulticlassModel result(MulticlassMode::one_vs_rest);
+        for (std::size_t k = 0; k < K; ++k) {
+            for (std::size_t i = 0; i < N; ++i) {
+                result.set_weight(k, i, models[k].weight(i));
+            }
+            result.set_bias(k, models[k].bias());
+        }
+        return result;
+    }
+
+    void logits(std::span<float const, N> features, std::span<float, K> out) const noexcept {
+        alignas(64) float padded[class_stride];
+        kernels::linear_classes(weights_.data(), class_stride, N, bias_.data(), features.data(),
+                                padded);
+        std::copy_n(padded, K, out.begin());
+    }
+
+    void probabilities(std::span<float const, N> features, std::span<float, K> out) const noexcept {
+        logits(features, out);
+        normalize(out.data());
+    }
+
+    MulticlassResult classify(std::array<float, N> const& features) const noexcept {
+        alignas(64) float scores[class_stride];
+        kernels::linear_classes(weights_.data(), class_stride, N, bias_.data(), features.data(),
+                                scores);
+        return to_result(scores);
+    }
+
+    // Rows of N features, results.size() rows.
+    Error classify_batch(std::span<float const> features,
+                         std::span<MulticlassResult> results) const noexcept {
+        if (features.size() != results.size() * N) {
+            return Error::size_mismatch;
+        }
+        alignas(64) float scores[class_stride];
+        for (std::size_t r = 0; r < results.size(); ++r) {
+            kernels::linear_classes(weights_.data(), class_stride, N, bias_.data(),
+                                    features.data() + r * N, scores);
+            results[r] = to_result(scores);
+        }
+        return Error::none;
+    }
+
+    float weight(std::size_t label, std::size_t index) const noexcept {
+        return weights_[index * class_stride + label];
+    }
+    void set_weight(std::size_t label, std::size_t index, float value) noexcept {
+        weights_[index * class_stride + label] = value;
+    }
+    float bias(std::size_t label) const noexcept { return bias_[label]; }
+    void set_bias(std::size_t label, float value) noexcept { bias_[label] = value; }
+
+    MulticlassMode mode() const noexcept { return mode_; }
+    static constexpr std::size_t class_count() noexcept { return K; }
+    static constexpr std::size_t weight_count() noexcept { return N; }
+
+    // Feature-major padded storage, for trainers: N rows of class_stride.
+    std::span<float const> weight_matrix() const noexcept { return weights_; }
+    std::span<float> weight_matrix() noexcept { return weights_; }
+    std::span<float const> biases() const noexcept { return bias_; }
+    std::span<float> biases() noexcept { return bias_; }
+
+    // Layout: "CLMC" magic and version (uint32), mode (uint32), K and N
+    // (size_t), then the weights class by class (K rows of N floats) and the
+    // K biases, independent of the in-memory padding.
+    Error serialize(std::ostream& os) const noexcept {
+        std::uint32_t header[3] = {magic, version, static_cast<std::uint32_t>(mode_)};
+        std::size_t shape[2] = {K, N};
+        os.write(reinterpret_cast<char const*>(header), sizeof(header));
+        os.write(reinterpret_cast<char const*>(shape), sizeof(shape));
+        for (std::size_t k = 0; k < K; ++k) {
+            for (std::size_t i = 0; i < N; ++i) {
+                float w = weight(k, i);
+                os.write(reinterpret_cast<char const*>(&w), sizeof(w));
+            }
+        }
+        os.write(reinterpret_cast<char const*>(bias_.data()), sizeof(float) * K);
+        if (!os) {
+            return Error::io_failed;
+        }
+        return Error::none;
+    }
+
+    Error deserialize(std::istream& is) noexcept {
+        std::uint32_t header[3] = {};
+        is.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (header[0] != magic || header[1] != version ||
+            header[2] > static_cast<std::uint32_t>(MulticlassMode::one_vs_rest)) {
+            return Error::invalid_format;
+        }
+        std::size_t shape[2] = {};
+        is.read(reinterpret_cast<char*>(shape), sizeof(shape));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (shape[0] != K || shape[1] != N) {
+            return Error::dimension_mismatch;
+        }
+
+        MulticlassModel loaded(static_cast<MulticlassMode>(header[2]));
+        AlignedVector<float> row(N);
+        for (std::size_t k = 0; k < K; ++k) {
+            is.read(reinterpret_cast<char*>(row.data()), sizeof(float) * N);
+            for (std::size_t i = 0; i < N; ++i) {
+                loaded.set_weight(k, i, row[i]);
+            }
+        }
+        is.read(reinterpret_cast<char*>(loaded.bias_.data()), sizeof(float) * K);
+        if (!is) {
+            return Error::io_failed;
+        }
+        *this = std::move(loaded);
+        return Error::none;
+    }
+
+private:
+    static constexpr std::uint32_t magic = 0x434d4c43; // "CLMC"
+    static constexpr std::uint32_t version = 1;
+
+    void normalize(float* scores) const noexcept {
+        if (mode_ == MulticlassMode::softmax) {
+            kernels::softmax_inplace(scores, K);
+        } else {
+            kernels::sigmoid_inplace(scores, K);
+        }
+    }
+
+    // Only the winner's probability is needed: for softmax that is
+    // 1 / sum(exp(logit - max)), for one-vs-rest sigmoid(max).
+    MulticlassResult to_result(float* scores) const noexcept {
+        std::size_t best = static_cast<std::size_t>(std::max_element(scores, scores + K) - scores);
+        if (mode_ == MulticlassMode::one_vs_rest) {
+            return {best, math::sigmoid(scores[best])};
+        }
+        kernels::softmax_inplace(scores, K);
+        return {best, scores[best]};
+    }
+
+    AlignedVector<float> weights_;
+    AlignedVector<float> bias_;
+    MulticlassMode mode_;
+};
+
+} // namespace classifier
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "classifier/aligned.h"
+#include "classifier/kernels.h"
+#include "classifier/math.h"
+#include "classifier/multiclass_model.h"
+#include "classifier/thread_pool.h"
+#include "classifier/trainer.h"
+
+namespace classifier {
+
+// Mini-batch SGD for MulticlassModel. A sample is N features followed by its
+// class index stored as a float. Softmax models minimize the cross-entropy of
+// the softmax distribution; one-vs-rest models train each class as its own
+// logistic regression against all others, over the same pass.
+template <std::size_t K, std::size_t N>
+class MulticlassTrainer {
+public:
+    using Model = MulticlassModel<K, N>;
+    using Sample = std::array<float, N + 1>;
+    using TrainingSet = std::vector<Sample>;
+
+    explicit MulticlassTrainer(Model& model) noexcept : model_(model) {}
+
+    // Same batching and reduction scheme as Trainer::train_sgd: results are
+    // reproducible for a fixed seed and thread count.
+    Error train_sgd(std::span<Sample const> data, SgdOptions const& options) noexcept {
+        if (data.empty()) {
+            return Error::empty_training_set;
+        }
+        if (options.regularization_strength < 0.0f) {
+            return Error::invalid_regularization_strength;
+        }
+        if (options.batch_size == 0) {
+            return Error::invalid_batch_size;
+        }
+        for (Sample const& sample : data) {
+            if (!(sample[N] >= 0.0f && sample[N] < static_cast<float>(K)) ||
+                sample[N] != static_cast<float>(static_cast<std::size_t>(sample[N]))) {
+                return Error::invalid_label;
+            }
+        }
+
+        std::size_t threads = options.threads == 0 ? ThreadPool::default_size() : options.threads;
+        ThreadPool pool(threads);
+        std::vector<Gradients> partials(pool.size());
+
+        std::vector<std::size_t> order(data.size());
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::mt19937_64 rng(options.seed);
+
+        for (std::size_t epoch = 0; epoch < options.epochs; ++epoch) {
+            if (options.shuffle) {
+                detail::shuffle(order, rng);
+            }
+            for (std::size_t begin = 0; begin < order.size(); begin += options.batch_size) {
+                std::size_t end = std::min(order.size(), begin + options.batch_size);
+                std::size_t count = end - begin;
+
+                pool.run([&](std::size_t t) {
+                    Gradients& local = partials[t];
+                    local.clear();
+                    std::size_t first = begin + count * t / pool.size();
+                    std::size_t last = begin + count * (t + 1) / pool.size();
+                    for (std::size_t i = first; i < last; ++i) {
+                        accumulate(data[order[i]], local);
+                    }
+                });
+
+                Gradients& total = partials[0];
+                for (std::size_t t = 1; t < partials.size(); ++t) {
+                    kernels::axpy(1.0f, partials[t].weights.data(), total.weights.data(),
+                                  total.weights.size());
+                    kernels::axpy(1.0f, partials[t].bias.data(), total.bias.data(), stride);
+                }
+                apply(total, static_cast<float>(count), options.learning_rate,
+                      options.regularization, options.regularization_strength);
+            }
+        }
+        return Error::none;
+    }
+
+private:
+    static constexpr std::size_t stride = Model::class_stride;
+
+    // Laid out like the model: N rows of `stride` class gradients.
+    struct Gradients {
+        AlignedVector<float> weights = AlignedVector<float>(N * stride, 0.0f);
+        AlignedVector<float> bias = AlignedVector<float>(stride, 0.0f);
+
+        void clear() noexcept {
+            std::fill(weights.begin(), weights.end(), 0.0f);
+            std::fill(bias.begin(), bias.end(), 0.0f);
+        }
+    };
+
+    // d(loss)/d(logit_c) is p_c - [c == label] for both losses; only how p
+    // is computed differs.
+    void accumulate(Sample const& sample, Gradients& gradients) const noexcept {
+        alignas(64) float error[stride];
+        kernels::linear_classes(model_.weight_matrix().data(), stride, N, model_.biases().data(),
+                                sample.data(), error);
+        if (model_.mode() == MulticlassMode::softmax) {
+            kernels::softmax_inplace(error, K);
+        } else {
+            kernels::sigmoid_inplace(error, K);
+        }
+        std::fill(error + K, error + stride, 0.0f);
+        error[static_cast<std::size_t>(sample[N])] -= 1.0f;
+
+        for (std::size_t i = 0; i < N; ++i) {
+            if (sample[i] != 0.0f) {
+                kernels::axpy(sample[i], error, gradients.weights.data() + i * stride, stride);
+            }
+        }
+        kernels::axpy(1.0f, error, gradients.bias.data(), stride);
+    }
+
+    // Padding columns have zero weights and zero gradients, so updating the
+    // whole padded matrix leaves them at zero.
+    void apply(Gradients const& gradients, float m, float learning_rate,
+               Regularization regularization, float regularization_strength) noexcept {
+        std::span<float> weights = model_.weight_matrix();
+        for (std::size_t j = 0; j < weights.size(); ++j) {
+            float gradient = gradients.weights[j] / m;
+
+            if (regularization == Regularization::l2) {
+                gradient += regularization_strength * weights[j];
+            } else if (regularization == Regularization::l1) {
+                if (weights[j] > 0.0f) {
+                    gradient += regularization_strength;
+                } else if (weights[j] < 0.0f) {
+                    gradient -= regularization_strength;
+                }
+            }
+
+            weights[j] -= learning_rate * gradient;
+        }
+        kernels::axpy(-learning_rate / m, gradients.bias.data(), model_.biases().data(), stride);
+    }
+
+    Model& model_;
+};
+
+} // namespace classifier
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+#include "classifier/aligned.h"
+
+namespace classifier {
+
+// Per-step settings handed to an optimizer by the trainer.
+struct OptimizerStep {
+    float learning_rate;
+    float l1;
+    float l2;
+};
+
+// Optimizer policies for Trainer::train_sgd. Coordinates 0..n-1 are the
+// model's weights and coordinate n is its bias. prepare(n) sizes the
+// per-coordinate state, which lives in contiguous cache-line-aligned arrays
+// and carries over between train_sgd calls until reset() or a different n;
+// begin_step() runs once per mini-batch and update() once per coordinate.
+// Non-proximal optimizers get L1/L2 folded into the gradient by the trainer
+// and must not apply it themselves; proximal ones get the raw gradient and
+// regularize the weights (never the bias) as part of the update.
+template <typename O>
+concept Optimizer = requires(O& optimizer, std::size_t n, OptimizerStep const& step, float& w,
+                             float g) {
+    optimizer.prepare(n);
+    optimizer.reset();
+    optimizer.begin_step(step);
+    optimizer.update(n, w, g);
+    { O::proximal } -> std::convertible_to<bool>;
+};
+
+// w -= lr * g.
+class GradientDescent {
+public:
+    static constexpr bool proximal = false;
+
+    void prepare(std::size_t) noexcept {}
+    void reset() noexcept {}
+    void begin_step(OptimizerStep const& step) noexcept { learning_rate_ = step.learning_rate; }
+    void update(std::size_t, float& w, float g) noexcept { w -= learning_rate_ * g; }
+
+private:
+    float learning_rate_ = 0.0f;
+};
+
+// Heavy-ball momentum: v = mu * v + g, w -= lr * v.
+class Momentum {
+public:
+    static constexpr bool proximal = false;
+
+    explicit Momentum(float momentum = 0.9f) noexcept : momentum_(momentum) {}
+
+    void prepare(std::size_t weights) {
+        if (velocity_.size() != weights + 1) {
+            velocity_.assign(weights + 1, 0.0f);
+        }
+    }
+    void reset() noexcept { std::fill(velocity_.begin(), velocity_.end(), 0.0f); }
+    void begin_step(OptimizerStep const& step) noexcept { learning_rate_ = step.learning_rate; }
+    void update(std::size_t i, float& w, float g) noexcept {
+        float& v = velocity_[i];
+        v = momentum_ * v + g;
+        w -= learning_rate_ * v;
+    }
+
+private:
+    float momentum_;
+    float learning_rate_ = 0.0f;
+    AlignedVector<float> velocity_;
+};
+
+// Nesterov momentum in the look-ahead-free form: v = mu * v + g,
+// w -= lr * (g + mu * v).
+class Nesterov {
+public:
+    static constexpr bool proximal = false;
+
+    explicit Nesterov(float momentum = 0.9f) noexcept : momentum_(momentum) {}
+
+    void prepare(std::size_t weights) {
+        if (velocity_.size() != weights + 1) {
+            velocity_.assign(weights + 1, 0.0f);
+        }
+    }
+    void reset() noexcept { std::fill(velocity_.begin(), velocity_.end(), 0.0f); }
+    void begin_step(OptimizerStep const& step) noexcept { learning_rate_ = step.learning_rate; }
+    void update(std::size_t i, float& w, float g) noexcept {
+        float& v = velocity_[i];
+        v = momentum_ * v + g;
+        w -= learning_rate_ * (g + momentum_ * v);
+    }
+
+private:
+    float momentum_;
+    float learning_rate_ = 0.0f;
+    AlignedVector<float> velocity_;
+};
+
+// Per-coordinate rates from the accumulated squared gradients:
+// G += g^2, w -= lr * g / (sqrt(G) + epsilon).
+class AdaGrad {
+public:
+    static constexpr bool proximal = false;
+
+    explicit AdaGrad(float epsilon = 1e-7f) noexcept : epsilon_(epsilon) {}
+
+    void prepare(std::size_t weights) {
+        if (squared_.size() != weights + 1) {
+            squared_.assign(weights + 1, 0.0f);
+        }
+    }
+    void reset() noexcept { std::fill(squared_.begin(), squared_.end(), 0.0f); }
+    void begin_step(OptimizerStep const& step) noexcept { learning_rate_ = step.learning_rate; }
+    void update(std::size_t i, float& w, float g) noexcept {
+        float& s = squared_[i];
+        s += g * g;
+        w -= learning_rate_ * g / (std::sqrt(s) + epsilon_);
+    }
+
+private:
+    float epsilon_;
+    float learning_rate_ = 0.0f;
+    AlignedVector<float> squared_;
+};
+
+// Adam with bias-corrected moment estimates. The corrections are folded into
+// the step size and epsilon once per step rather than per coordinate.
+class Adam {
+public:
+    static constexpr bool proximal = false;
+
+    explicit Adam(float beta1 = 0.9f, float beta2 = 0.999f, float epsilon = 1e-8f) noexcept
+        : beta1_(beta1), beta2_(beta2), epsilon_(epsilon) {}
+
+    void prepare(std::size_t weights) {
+        if (first_.size() != weights + 1) {
+            first_.assign(weights + 1, 0.0f);
+            second_.assign(weights + 1, 0.0f);
+            steps_ = 0;
+        }
+    }
+    void reset() noexcept {
+        std::fill(first_.begin(), first_.end(), 0.0f);
+        std::fill(second_.begin(), second_.end(), 0.0f);
+        steps_ = 0;
+    }
+    void begin_step(OptimizerStep const& step) noexcept {
+        ++steps_;
+        double t = static_cast<double>(steps_);
+        double correction1 = 1.0 - std::pow(static_cast<double>(beta1_), t);
+        double correction2 = std::sqrt(1.0 - std::pow(static_cast<double>(beta2_), t));
+        step_size_ = static_cast<float>(step.learning_rate * correction2 / correction1);
+        corrected_epsilon_ = static_cast<float>(epsilon_ * correction2);
+    }
+    void update(std::size_t i, float& w, float g) noexcept {
+        float& m = first_[i];
+        float& v = second_[i];
+        m = beta1_ * m + (1.0f - beta1_) * g;
+        v = beta2_ * v + (1.0f - beta2_) * g * g;
+        w -= step_size_ * m / (std::sqrt(v) + corrected_epsilon_);
+    }
+
+private:
+    float beta1_;
+    float beta2_;
+    float epsilon_;
+    float step_size_ = 0.0f;
+    float corrected_epsilon_ = 0.0f;
+    std::uint64_t steps_ = 0;
+    AlignedVector<float> first_;
+    AlignedVector<float> second_;
+};
+
+// FTRL-Proximal (McMahan et al., 2013). The learning rate is alpha; each
+// weight is solved in closed form from its accumulated state, so L1 drives
+// weights to exactly zero instead of oscillating around it. Meant to train a
+// model from zero weights: starting from others, the first step pulls them
+// towards what the (empty) state implies.
+class Ftrl {
+public:
+    static constexpr bool proximal = true;
+
+    explicit Ftrl(float beta = 1.0f) noexcept : beta_(beta) {}
+
+    void prepare(std::size_t weights) {
+        if (z_.size() != weights + 1) {
+            z_.assign(weights + 1, 0.0f);
+            n_.assign(weights + 1, 0.0f);
+        }
+        weights_ = weights;
+    }
+    void reset() noexcept {
+        std::fill(z_.begin(), z_.end(), 0.0f);
+        std::fill(n_.begin(), n_.end(), 0.0f);
+    }
+    void begin_step(OptimizerStep const& step) noexcept { step_ = step; }
+    void update(std::size_t i, float& w, float g) noexcept {
+        float& z = z_[i];
+        float& n = n_[i];
+        float sigma = (std::sqrt(n + g * g) - std::sqrt(n)) / step_.learning_rate;
+        z += g - sigma * w;
+        n += g * g;
+
+        float l1 = i < weights_ ? step_.l1 : 0.0f;
+        float l2 = i < weights_ ? step_.l2 : 0.0f;
+        if (std::abs(z) <= l1) {
+            w = 0.0f;
+        } else {
+            float shrunk = z > 0.0f ? z - l1 : z + l1;
+            w = -shrunk / ((beta_ + std::sqrt(n)) / step_.learning_rate + l2);
+        }
+    }
+
+private:
+    float beta_;
+    std::size_t weights_ = 0;
+    OptimizerStep step_{};
+    AlignedVector<float> z_;
+    AlignedVector<float> n_;
+};
+
+} // namespace classifier
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+
+#include "classifier/kernels.h"
+#include "classifier/kernels_int8.h"
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/trainer.h"
+
+namespace classifier {
+
+// Affine quantization: real = scale * (quantized - zero_point).
+struct QuantizationParams {
+    float scale = 1.0f;
+    std::int32_t zero_point = 0;
+};
+
+// int8 counterpart of Model<N>: int8 weights and uint8 features, each with a
+// per-model scale and zero point. The dot product runs entirely in integers
+// and is dequantized once per row.
+template <std::size_t N>
+class QuantizedModel {
+public:
+    using Sample = typename Trainer<N>::Sample;
+
+    QuantizedModel() noexcept : weights_{}, bias_(0.0f), weight_sum_(0) {}
+
+    // Calibrates the feature range on `calibration` and quantizes `model`.
+    static Error quantize(Model<N> const& model, std::span<Sample const> calibration,
+                          QuantizedModel& out) noexcept {
+        if (calibration.empty()) {
+            return Error::empty_training_set;
+        }
+
+        float lo = 0.0f;
+        float hi = 0.0f;
+        for (auto const& sample : calibration) {
+            for (std::size_t i = 0; i < N; ++i) {
+                lo = std::min(lo, sample[i]);
+                hi = std::max(hi, sample[i]);
+            }
+        }
+        out.features_ = choose_params(lo, hi, 0, 255);
+
+        lo = 0.0f;
+        hi = 0.0f;
+        for (std::size_t i = 0; i < N; ++i) {
+            lo = std::min(lo, model.weight(i));
+            hi = std::max(hi, model.weight(i));
+        }
+        out.weights_params_ = choose_params(lo, hi, -128, 127);
+
+        out.weight_sum_ = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            out.weights_[i] = static_cast<std::int8_t>(
+                quantize_value(model.weight(i), out.weights_params_, -128, 127));
+            out.weight_sum_ += out.weights_[i];
+        }
+        out.bias_ = model.bias();
+        return Error::none;
+    }
+
+    void quantize_features(std::span<float const, N> features,
+                           std::span<std::uint8_t, N> out) const noexcept {
+        for (std::size_t i = 0; i < N; ++i) {
+            out[i] = static_cast<std::uint8_t>(quantize_value(features[i], features_, 0, 255));
+        }
+    }
+
+    Result classify(std::array<float, N> const& features) const noexcept {
+        std::array<std::uint8_t, N> quantized;
+        quantize_features(features, quantized);
+        return classify_quantized(quantized);
+    }
+
+    Result classify_quantized(std::span<std::uint8_t const, N> features) const noexcept {
+        if constexpr (N == 0) {
+            return {Prediction::unknown, 0.0f};
+        } else {
+            return to_result(math::sigmoid(linear(features.data(), kernels::active_int8_isa())));
+        }
+    }
+
+    // Rows of N pre-quantized features; results.size() rows.
+    Error classify_batch(std::span<std::uint8_t const> features,
+                         std::span<Result> results) const noexcept {
+        if (features.size() != results.size() * N) {
+            return Error::size_mismatch;
+        }
+        if constexpr (N == 0) {
+            std::fill(results.begin(), results.end(), Result{Prediction::unknown, 0.0f});
+        } else {
+            auto isa = kernels::active_int8_isa();
+            float scores[256];
+            for (std::size_t r = 0; r < results.size(); r += std::size(scores)) {
+                std::size_t count = std::min(std::size(scores), results.size() - r);
+                for (std::size_t i = 0; i < count; ++i) {
+                    scores[i] = linear(features.data() + (r + i) * N, isa);
+                }
+                kernels::sigmoid_inplace(scores, count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    results[r + i] = to_result(scores[i]);
+                }
+            }
+        }
+        return Error::none;
+    }
+
+    QuantizationParams weight_params() const noexcept { return weights_params_; }
+    QuantizationParams feature_params() const noexcept { return features_; }
+    std::int8_t quantized_weight(std::size_t index) const noexcept { return weights_[index]; }
+    float bias() const noexcept { return bias_; }
+    static constexpr std::size_t weight_count() noexcept { return N; }
+
+    Error serialize(std::ostream& os) const noexcept {
+        std::uint32_t header[2] = {magic, version};
+        std::size_t n = N;
+        os.write(reinterpret_cast<char const*>(header), sizeof(header));
+        os.write(reinterpret_cast<char const*>(&n), sizeof(n));
+        write_params(os, weights_params_);
+        write_params(os, features_);
+        os.write(reinterpret_cast<char const*>(&bias_), sizeof(bias_));
+        os.write(reinterpret_cast<char const*>(weights_.data()), N);
+        if (!os) {
+            return Error::io_failed;
+        }
+        return Error::none;
+    }
+
+    Error deserialize(std::istream& is) noexcept {
+        std::uint32_t header[2] = {};
+        is.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (header[0] != magic || header[1] != version) {
+            return Error::invalid_format;
+        }
+        std::size_t n = 0;
+        is.read(reinterpret_cast<char*>(&n), sizeof(n));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (n != N) {
+            return Error::dimension_mismatch;
+        }
+
+        QuantizedModel loaded;
+        read_params(is, loaded.weights_params_);
+        read_params(is, loaded.features_);
+        is.read(reinterpret_cast<char*>(&loaded.bias_), sizeof(loaded.bias_));
+        is.read(reinterpret_cast<char*>(loaded.weights_.data()), N);
+        if (!is) {
+            return Error::io_failed;
+        }
+        loaded.weight_sum_ = 0;
+        for (std::int8_t w : loaded.weights_) {
+            loaded.weight_sum_ += w;
+        }
+        *this = loaded;
+        return Error::none;
+    }
+
+private:
+    static constexpr std::uint32_t magic = 0x38514c43; // "CLQ8"
+    static constexpr std::uint32_t version = 1;
+
+    // Maps [lo, hi] (always containing 0, so 0 is exact) onto [qmin, qmax].
+    static QuantizationParams choose_params(float lo, float hi, std::int32_t qmin,
+                                            std::int32_t qmax) noexcept {
+        if (hi - lo <= 0.0f) {
+            return {1.0f, 0};
+        }
+        float scale = (hi - lo) / static_cast<float>(qmax - qmin);
+        auto zero_point = static_cast<std::int32_t>(std::lround(static_cast<float>(qmin) - lo / scale));
+        return {scale, std::clamp(zero_point, qmin, qmax)};
+    }
+
+    // Clamps before rounding, as a scaled value out of int32 range, infinite
+    // or NaN has no defined conversion. NaN maps to the zero point, i.e. 0.
+    static std::int32_t quantize_value(float value, QuantizationParams params, std::int32_t qmin,
+                                       std::int32_t qmax) noexcept {
+        float scaled = value / params.scale;
+        if (std::isnan(scaled)) {
+            return params.zero_point;
+        }
+        scaled = std::clamp(scaled, static_cast<float>(qmin - params.zero_point),
+                            static_cast<float>(qmax - params.zero_point));
+        return static_cast<std::int32_t>(std::lround(scaled)) + params.zero_point;
+    }
+
+    float linear(std::uint8_t const* features, kernels::Int8Isa isa) const noexcept {
+        auto [dot, activation_sum] = kernels::dot_u8s8(features, weights_.data(), N, isa);
+        std::int64_t zw = weights_params_.zero_point;
+        std::int64_t zx = features_.zero_point;
+        std::int64_t acc = std::int64_t(dot) - zx * weight_sum_ - zw * activation_sum +
+                           static_cast<std::int64_t>(N) * zw * zx;
+        return weights_params_.scale * features_.scale * static_cast<float>(acc) + bias_;
+    }
+
+    static Result to_result(float score) noexcept {
+        if (score >= 0.5f) {
+            return {Prediction::positive, score};
+        }
+        return {Prediction::negative, 1.0f - score};
+    }
+
+    static void write_params(std::ostream& os, QuantizationParams const& params) noexcept {
+        os.write(reinterpret_cast<char const*>(&params.scale), sizeof(params.scale));
+        os.write(reinterpret_cast<char const*>(&params.zero_point), sizeof(params.zero_point));
+    }
+
+    static void read_params(std::istream& is, QuantizationParams& params) noexcept {
+        is.read(reinterpret_cast<char*>(&params.scale), sizeof(params.scale));
+        is.read(reinterpret_cast<char*>(&params.zero_point), sizeof(params.zero_point));
+    }
+
+    alignas(64) std::array<std::int8_t, N> weights_;
+    QuantizationParams weights_params_;
+    QuantizationParams features_;
+    float bias_;
+    std::int32_t weight_sum_;
+};
+
+} // namespace classifier
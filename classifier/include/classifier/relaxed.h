@@ -0,0 +1,25 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace classifier::detail {
+
+// Counters with a single writing thread that other threads read while it
+// runs. The writer publishes with a relaxed atomic_ref store and needs no
+// read-modify-write, since nobody else writes; readers load with relaxed
+// atomic_ref, which needs a non-const referent even for loads.
+inline std::uint64_t relaxed_load(std::uint64_t const& counter) noexcept {
+    return std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t&>(counter))
+        .load(std::memory_order_relaxed);
+}
+
+inline void relaxed_store(std::uint64_t& counter, std::uint64_t value) noexcept {
+    std::atomic_ref<std::uint64_t>(counter).store(value, std::memory_order_relaxed);
+}
+
+inline void relaxed_add(std::uint64_t& counter, std::uint64_t by) noexcept {
+    relaxed_store(counter, relaxed_load(counter) + by);
+}
+
+} // namespace classifier::detail
@@ -0,0 +1,699 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "classifier/aligned.h"
+#include "classifier/latency_histogram.h"
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/relaxed.h"
+#include "classifier/sigmoid.h"
+
+// Reference scoring service for Model<N> over a Unix domain socket or
+// loopback TCP (Linux, epoll).
+//
+// Wire format, host byte order since both ends share the machine: a request
+// is a uint32 row count r followed by r * N float features; its response is
+// r followed by the r positive-class probabilities. Requests on a connection
+// are answered in order, so clients may pipeline. A request of zero rows or
+// more than max_request_rows is a protocol error and closes the connection.
+namespace classifier {
+
+struct ScoringServerOptions {
+    // Listen on this Unix domain socket path when set, on 127.0.0.1
+    // otherwise. An existing socket file at the path is replaced; any other
+    // file there makes start() fail.
+    std::string unix_path;
+    // 0 picks a free port; see ScoringServer::port().
+    std::uint16_t tcp_port = 0;
+    // Event loops, one thread each; 0 uses one per hardware thread.
+    std::size_t loops = 0;
+    // A loop scores its pending requests as one micro-batch once they hold
+    // max_batch_rows rows or the oldest has waited max_queue_delay. A delay
+    // of zero scores whatever arrived in the same wakeup.
+    std::size_t max_batch_rows = 256;
+    std::chrono::microseconds max_queue_delay{100};
+    std::size_t max_request_rows = 4096;
+    // A connection is not read while more than this many response bytes
+    // wait for its client to take them, so a client that pipelines without reading
+    // cannot grow the server's buffers without bound.
+    std::size_t max_pending_output = 1 << 20;
+};
+
+struct ScoringServerStats {
+    std::uint64_t connections;
+    std::uint64_t requests;
+    std::uint64_t rows;
+    std::uint64_t batches;
+    // Per request, from its last byte being read to its response being
+    // handed to the socket: queueing delay plus the batch's scoring time.
+    LatencyHistogram latency;
+};
+
+namespace detail {
+
+inline bool set_nonblocking(int fd) noexcept {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Blocking send/recv of exactly `size` bytes.
+inline bool send_all(int fd, void const* data, std::size_t size) noexcept {
+    auto const* bytes = static_cast<char const*>(data);
+    while (size > 0) {
+        ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        bytes += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+inline bool recv_all(int fd, void* data, std::size_t size) noexcept {
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = ::recv(fd, bytes, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        bytes += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+inline bool unix_address(std::string const& path, sockaddr_un& address) noexcept {
+    address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Removes the socket file at `path`. True when nothing is left there; a
+// path naming anything but a socket is left alone.
+inline bool remove_socket_file(std::string const& path) noexcept {
+    struct stat status;
+    if (::lstat(path.c_str(), &status) != 0) {
+        return errno == ENOENT;
+    }
+    return S_ISSOCK(status.st_mode) && ::unlink(path.c_str()) == 0;
+}
+
+inline sockaddr_in loopback_address(std::uint16_t port) noexcept {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+} // namespace detail
+
+// Serves a copy of `model`. Every event loop owns the connections it
+// accepts: it reads their requests, appends the rows to its own micro-batch
+// buffer, scores the batch with one Model::score_batch pass and queues each
+// response, so a request never crosses threads and the loops share nothing
+// but the listening socket and the model.
+template <std::size_t N, SigmoidPolicy Sigmoid = ExactSigmoid>
+class ScoringServer {
+    static_assert(N > 0, "a scoring server needs at least one feature");
+
+public:
+    ScoringServer(Model<N, Sigmoid> const& model, ScoringServerOptions options)
+        : model_(model), options_(std::move(options)) {}
+
+    ~ScoringServer() { stop(); }
+
+    ScoringServer(ScoringServer const&) = delete;
+    ScoringServer& operator=(ScoringServer const&) = delete;
+
+    // Binds, listens and starts the loops, stopping them first when the
+    // server is already running. Error::io_failed when the socket cannot be
+    // set up.
+    Error start() {
+        stop();
+        loops_.clear();
+        if (!open_listener()) {
+            close_all();
+            return Error::io_failed;
+        }
+        std::size_t count = options_.loops == 0 ? std::max<std::size_t>(
+                                                      std::thread::hardware_concurrency(), 1)
+                                                : options_.loops;
+        for (std::size_t l = 0; l < count; ++l) {
+            auto loop = std::make_unique<Loop>(*this);
+            if (!loop->open(listener_, wake_)) {
+                close_all();
+                return Error::io_failed;
+            }
+            loops_.push_back(std::move(loop));
+        }
+        for (auto& loop : loops_) {
+            loop->thread = std::thread([&loop = *loop] { loop.run(); });
+        }
+        return Error::none;
+    }
+
+    // Stops accepting, closes every connection and joins the loops.
+    // Requests still waiting for their batch are dropped.
+    void stop() noexcept {
+        if (wake_ >= 0) {
+            stopping_.store(true, std::memory_order_relaxed);
+            std::uint64_t one = 1;
+            [[maybe_unused]] auto written = ::write(wake_, &one, sizeof(one));
+        }
+        for (auto& loop : loops_) {
+            if (loop->thread.joinable()) {
+                loop->thread.join();
+            }
+        }
+        close_all();
+    }
+
+    // The bound TCP port; 0 when serving a Unix socket.
+    std::uint16_t port() const noexcept { return port_; }
+
+    // Totals since start(). Safe to call while serving and after stop().
+    ScoringServerStats stats() const noexcept {
+        ScoringServerStats stats{};
+        for (auto const& loop : loops_) {
+            stats.connections += detail::relaxed_load(loop->connections_accepted);
+            stats.requests += detail::relaxed_load(loop->requests);
+            stats.rows += detail::relaxed_load(loop->rows);
+            stats.batches += detail::relaxed_load(loop->batches);
+            stats.latency.merge(loop->latency.snapshot());
+        }
+        return stats;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection {
+        int fd = -1;
+        std::vector<std::byte> input;
+        std::size_t input_begin = 0;
+        std::vector<std::byte> output;
+        std::size_t output_begin = 0;
+        // Requests parsed but not yet answered.
+        std::size_t pending = 0;
+        bool closed = false;
+        // Stopped reading until the pending output drains.
+        bool paused = false;
+        bool writing = false;
+        bool flushed = false;
+        std::uint32_t events = EPOLLIN;
+    };
+
+    struct Request {
+        Connection* connection;
+        std::size_t first_row;
+        std::uint32_t rows;
+        Clock::time_point arrived;
+    };
+
+    struct Loop {
+        explicit Loop(ScoringServer& server) : server(server) {}
+
+        ~Loop() { close_all(); }
+
+        void close_all() noexcept {
+            for (auto& connection : connections) {
+                if (connection->fd >= 0) {
+                    ::close(connection->fd);
+                }
+            }
+            connections.clear();
+            queue.clear();
+            batch_rows = 0;
+            if (epoll >= 0) {
+                ::close(epoll);
+                epoll = -1;
+            }
+        }
+
+        bool open(int listener, int wake) {
+            epoll = ::epoll_create1(EPOLL_CLOEXEC);
+            if (epoll < 0) {
+                return false;
+            }
+            // Every loop waits on the one listening socket; EPOLLEXCLUSIVE
+            // wakes only one of them per incoming connection.
+            epoll_event accept_event{};
+            accept_event.events = EPOLLIN | EPOLLEXCLUSIVE;
+            accept_event.data.ptr = &listener_tag;
+            epoll_event wake_event{};
+            wake_event.events = EPOLLIN;
+            wake_event.data.ptr = &wake_tag;
+            if (::epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &accept_event) != 0 ||
+                ::epoll_ctl(epoll, EPOLL_CTL_ADD, wake, &wake_event) != 0) {
+                return false;
+            }
+            this->listener = listener;
+
+            std::size_t capacity = std::max(server.options_.max_batch_rows,
+                                            server.options_.max_request_rows);
+            features.assign(capacity * N, 0.0f);
+            scores.assign(capacity, 0.0f);
+            return true;
+        }
+
+        void run() noexcept {
+            std::array<epoll_event, 64> events;
+            while (!server.stopping_.load(std::memory_order_relaxed)) {
+                int ready = ::epoll_pwait2(epoll, events.data(), static_cast<int>(events.size()),
+                                           wait_timeout(), nullptr);
+                for (int e = 0; e < ready; ++e) {
+                    void* tag = events[static_cast<std::size_t>(e)].data.ptr;
+                    std::uint32_t flags = events[static_cast<std::size_t>(e)].events;
+                    if (tag == &listener_tag) {
+                        accept_all();
+                    } else if (tag != &wake_tag) {
+                        auto* connection = static_cast<Connection*>(tag);
+                        if ((flags & EPOLLOUT) != 0) {
+                            write(*connection);
+                        }
+                        if ((flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0) {
+                            read(*connection);
+                        }
+                    }
+                }
+                if (!queue.empty() &&
+                    Clock::now() - queue.front().arrived >= server.options_.max_queue_delay) {
+                    flush();
+                }
+                reap();
+            }
+        }
+
+        // Until the oldest queued request's deadline; blocks when idle.
+        timespec const* wait_timeout() noexcept {
+            if (queue.empty()) {
+                return nullptr;
+            }
+            auto left = queue.front().arrived + server.options_.max_queue_delay - Clock::now();
+            auto ns = std::max<std::int64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(left).count(), 0);
+            timeout.tv_sec = static_cast<time_t>(ns / 1'000'000'000);
+            timeout.tv_nsec = static_cast<long>(ns % 1'000'000'000);
+            return &timeout;
+        }
+
+        void accept_all() noexcept {
+            for (;;) {
+                int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) {
+                    return;
+                }
+                if (server.unix_path_.empty()) {
+                    int on = 1;
+                    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                }
+                auto connection = std::make_unique<Connection>();
+                connection->fd = fd;
+                epoll_event event{};
+                event.events = EPOLLIN;
+                event.data.ptr = connection.get();
+                if (::epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+                    ::close(fd);
+                    continue;
+                }
+                connections.push_back(std::move(connection));
+                detail::relaxed_add(connections_accepted, 1);
+            }
+        }
+
+        void read(Connection& connection) noexcept {
+            if (connection.closed) {
+                return;
+            }
+            if (connection.output.size() - connection.output_begin >
+                server.options_.max_pending_output) {
+                connection.paused = true;
+                watch(connection);
+                return;
+            }
+            constexpr std::size_t chunk = 64 * 1024;
+            auto& input = connection.input;
+            if (connection.input_begin > 0 && connection.input_begin * 2 >= input.size()) {
+                input.erase(input.begin(),
+                            input.begin() + static_cast<std::ptrdiff_t>(connection.input_begin));
+                connection.input_begin = 0;
+            }
+            std::size_t used = input.size();
+            input.resize(used + chunk);
+            ssize_t received = ::recv(connection.fd, input.data() + used, chunk, 0);
+            input.resize(used + static_cast<std::size_t>(std::max<ssize_t>(received, 0)));
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EINTR)) {
+                close(connection);
+                return;
+            }
+            parse(connection);
+        }
+
+        void parse(Connection& connection) noexcept {
+            auto const& options = server.options_;
+            while (!connection.closed) {
+                std::size_t available = connection.input.size() - connection.input_begin;
+                std::uint32_t rows = 0;
+                if (available < sizeof(rows)) {
+                    return;
+                }
+                std::byte const* frame = connection.input.data() + connection.input_begin;
+                std::memcpy(&rows, frame, sizeof(rows));
+                if (rows == 0 || rows > options.max_request_rows) {
+                    close(connection);
+                    return;
+                }
+                std::size_t bytes = sizeof(float) * N * rows;
+                if (available < sizeof(rows) + bytes) {
+                    return;
+                }
+
+                if (batch_rows > 0 && batch_rows + rows > options.max_batch_rows) {
+                    flush();
+                }
+                std::memcpy(features.data() + batch_rows * N, frame + sizeof(rows), bytes);
+                queue.push_back({&connection, batch_rows, rows, Clock::now()});
+                batch_rows += rows;
+                ++connection.pending;
+                connection.input_begin += sizeof(rows) + bytes;
+                if (batch_rows >= options.max_batch_rows) {
+                    flush();
+                }
+            }
+        }
+
+        // Scores the micro-batch and queues every response.
+        void flush() noexcept {
+            server.model_.score_batch(std::span<float const>(features.data(), batch_rows * N),
+                                      std::span<float>(scores.data(), batch_rows));
+            auto now = Clock::now();
+            for (Request const& request : queue) {
+                Connection& connection = *request.connection;
+                --connection.pending;
+                if (connection.closed) {
+                    continue;
+                }
+                auto& output = connection.output;
+                std::size_t header = output.size();
+                std::size_t body = sizeof(float) * request.rows;
+                output.resize(header + sizeof(request.rows) + body);
+                std::memcpy(output.data() + header, &request.rows, sizeof(request.rows));
+                std::memcpy(output.data() + header + sizeof(request.rows),
+                            scores.data() + request.first_row, body);
+                connection.flushed = true;
+                latency.record(now - request.arrived);
+            }
+            for (Request const& request : queue) {
+                Connection& connection = *request.connection;
+                if (connection.flushed) {
+                    connection.flushed = false;
+                    write(connection);
+                }
+            }
+            detail::relaxed_add(requests, queue.size());
+            detail::relaxed_add(rows, batch_rows);
+            detail::relaxed_add(batches, 1);
+            queue.clear();
+            batch_rows = 0;
+        }
+
+        void write(Connection& connection) noexcept {
+            auto& output = connection.output;
+            while (connection.output_begin < output.size()) {
+                ssize_t sent = ::send(connection.fd, output.data() + connection.output_begin,
+                                      output.size() - connection.output_begin, MSG_NOSIGNAL);
+                if (sent < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno == EAGAIN) {
+                        connection.writing = true;
+                        watch(connection);
+                    } else {
+                        close(connection);
+                    }
+                    return;
+                }
+                connection.output_begin += static_cast<std::size_t>(sent);
+            }
+            output.clear();
+            connection.output_begin = 0;
+            connection.writing = false;
+            connection.paused = false;
+            watch(connection);
+        }
+
+        // Every complete request read so far has been parsed, so a paused
+        // connection resumes with EPOLLIN once the socket has more to read.
+        void watch(Connection& connection) noexcept {
+            std::uint32_t events = (connection.paused ? 0u : std::uint32_t(EPOLLIN)) |
+                                   (connection.writing ? std::uint32_t(EPOLLOUT) : 0u);
+            if (connection.events == events) {
+                return;
+            }
+            connection.events = events;
+            epoll_event event{};
+            event.events = events;
+            event.data.ptr = &connection;
+            ::epoll_ctl(epoll, EPOLL_CTL_MOD, connection.fd, &event);
+        }
+
+        // The fd goes at once; the Connection stays until no queued request
+        // refers to it.
+        void close(Connection& connection) noexcept {
+            if (connection.closed) {
+                return;
+            }
+            connection.closed = true;
+            ::epoll_ctl(epoll, EPOLL_CTL_DEL, connection.fd, nullptr);
+            ::close(connection.fd);
+            connection.fd = -1;
+        }
+
+        void reap() {
+            std::erase_if(connections, [](auto const& connection) {
+                return connection->closed && connection->pending == 0;
+            });
+        }
+
+        ScoringServer& server;
+        int epoll = -1;
+        int listener = -1;
+        std::thread thread;
+        std::vector<std::unique_ptr<Connection>> connections;
+        AlignedVector<float> features;
+        AlignedVector<float> scores;
+        std::vector<Request> queue;
+        std::size_t batch_rows = 0;
+        timespec timeout{};
+        char listener_tag = 0;
+        char wake_tag = 0;
+
+        // Written by the loop thread only, read by stats().
+        std::uint64_t connections_accepted = 0;
+        std::uint64_t requests = 0;
+        std::uint64_t rows = 0;
+        std::uint64_t batches = 0;
+        LatencyHistogram latency;
+    };
+
+    bool open_listener() noexcept {
+        // Never read: once written it keeps every loop's epoll_wait returning.
+        wake_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (wake_ < 0) {
+            return false;
+        }
+        if (!options_.unix_path.empty()) {
+            sockaddr_un address;
+            if (!detail::unix_address(options_.unix_path, address)) {
+                return false;
+            }
+            if (!detail::remove_socket_file(options_.unix_path)) {
+                return false;
+            }
+            listener_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (listener_ < 0 ||
+                ::bind(listener_, reinterpret_cast<sockaddr const*>(&address),
+                       sizeof(address)) != 0) {
+                return false;
+            }
+            unix_path_ = options_.unix_path;
+        } else {
+            sockaddr_in address = detail::loopback_address(options_.tcp_port);
+            listener_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            int on = 1;
+            if (listener_ < 0 ||
+                ::setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+                ::bind(listener_, reinterpret_cast<sockaddr const*>(&address),
+                       sizeof(address)) != 0) {
+                return false;
+            }
+            socklen_t length = sizeof(address);
+            if (::getsockname(listener_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+                return false;
+            }
+            port_ = ntohs(address.sin_port);
+        }
+        return detail::set_nonblocking(listener_) && ::listen(listener_, SOMAXCONN) == 0;
+    }
+
+    // Loops are kept, closed, so stats() still reports after stop().
+    void close_all() noexcept {
+        for (auto& loop : loops_) {
+            loop->close_all();
+        }
+        if (listener_ >= 0) {
+            ::close(listener_);
+            listener_ = -1;
+        }
+        if (wake_ >= 0) {
+            ::close(wake_);
+            wake_ = -1;
+        }
+        if (!unix_path_.empty()) {
+            detail::remove_socket_file(unix_path_);
+            unix_path_.clear();
+        }
+        port_ = 0;
+        stopping_.store(false, std::memory_order_relaxed);
+    }
+
+    Model<N, Sigmoid> model_;
+    ScoringServerOptions options_;
+    std::vector<std::unique_ptr<Loop>> loops_;
+    std::atomic<bool> stopping_{false};
+    int listener_ = -1;
+    int wake_ = -1;
+    std::string unix_path_;
+    std::uint16_t port_ = 0;
+};
+
+// Blocking client for ScoringServer<N>, one connection, for tests, tools and
+// the load generator.
+template <std::size_t N>
+class ScoringClient {
+public:
+    ScoringClient() noexcept = default;
+    ~ScoringClient() { close(); }
+
+    ScoringClient(ScoringClient&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+    ScoringClient& operator=(ScoringClient&& other) noexcept {
+        if (this != &other) {
+            close();
+            fd_ = std::exchange(other.fd_, -1);
+        }
+        return *this;
+    }
+
+    Error connect_unix(std::string const& path) noexcept {
+        sockaddr_un address;
+        if (!detail::unix_address(path, address)) {
+            return Error::io_failed;
+        }
+        close();
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0 ||
+            ::connect(fd_, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) {
+            close();
+            return Error::io_failed;
+        }
+        return Error::none;
+    }
+
+    Error connect_tcp(std::uint16_t port) noexcept {
+        sockaddr_in address = detail::loopback_address(port);
+        close();
+        fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0 ||
+            ::connect(fd_, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) {
+            close();
+            return Error::io_failed;
+        }
+        int on = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        return Error::none;
+    }
+
+    // Sends one request of scores.size() rows and waits for its
+    // probabilities.
+    Error score(std::span<float const> features, std::span<float> scores) noexcept {
+        Error error = send(features);
+        return error == Error::none ? receive(scores) : error;
+    }
+
+    // The halves of score(), for pipelining several requests.
+    Error send(std::span<float const> features) noexcept {
+        if (features.empty() || features.size() % N != 0) {
+            return Error::size_mismatch;
+        }
+        auto rows = static_cast<std::uint32_t>(features.size() / N);
+        if (!detail::send_all(fd_, &rows, sizeof(rows)) ||
+            !detail::send_all(fd_, features.data(), sizeof(float) * features.size())) {
+            return Error::io_failed;
+        }
+        return Error::none;
+    }
+
+    Error receive(std::span<float> scores) noexcept {
+        std::uint32_t rows = 0;
+        if (!detail::recv_all(fd_, &rows, sizeof(rows))) {
+            return Error::io_failed;
+        }
+        if (rows != scores.size()) {
+            return Error::size_mismatch;
+        }
+        if (!detail::recv_all(fd_, scores.data(), sizeof(float) * scores.size())) {
+            return Error::io_failed;
+        }
+        return Error::none;
+    }
+
+    void close() noexcept {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+private:
+    int fd_ = -1;
+};
+
+} // namespace classifier
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+
+#include "classifier/kernels.h"
+#include "classifier/math.h"
+
+namespace classifier {
+
+// Sigmoid implementations selectable by Model and Trainer. Each provides a
+// scalar apply and an in-place batch form; max_error is the largest absolute
+// deviation from the exact logistic function over all float inputs.
+template <typename S>
+concept SigmoidPolicy = requires(float x, float* values, std::size_t count) {
+    { S::apply(x) } noexcept -> std::same_as<float>;
+    { S::apply_inplace(values, count) } noexcept;
+    { S::max_error } -> std::convertible_to<float>;
+};
+
+struct ExactSigmoid {
+    // The batch form uses the vectorized expf kernel, within 1e-6 of std::exp.
+    static constexpr float max_error = 1e-6f;
+
+    static float apply(float x) noexcept { return math::sigmoid(x); }
+    static void apply_inplace(float* values, std::size_t count) noexcept {
+        kernels::sigmoid_inplace(values, count);
+    }
+};
+
+struct RationalSigmoid {
+    static constexpr float max_error = 5e-5f;
+
+    static float apply(float x) noexcept { return math::sigmoid_rational(x); }
+    static void apply_inplace(float* values, std::size_t count) noexcept {
+        kernels::sigmoid_rational_inplace(values, count);
+    }
+};
+
+// Linear interpolation in a 2049-entry table over [-16, 16]; outside that
+// range the logistic is within 1.2e-7 of 0 or 1. NaN maps to NaN.
+struct TableSigmoid {
+    static constexpr float max_error = 5e-6f;
+
+    static float apply(float x) noexcept {
+        // Clamping keeps NaN, and converting it to an index is undefined.
+        if (std::isnan(x)) {
+            return x;
+        }
+        float position = (std::clamp(x, -range, range) + range) * steps_per_unit;
+        auto index = static_cast<std::size_t>(position);
+        index = index < intervals ? index : intervals - 1;
+        float fraction = position - static_cast<float>(index);
+        return table[index] + fraction * (table[index + 1] - table[index]);
+    }
+
+    static void apply_inplace(float* values, std::size_t count) noexcept {
+        for (std::size_t i = 0; i < count; ++i) {
+            values[i] = apply(values[i]);
+        }
+    }
+
+private:
+    static constexpr std::size_t intervals = 2048;
+    static constexpr float range = 16.0f;
+    static constexpr float steps_per_unit = static_cast<float>(intervals) / (2.0f * range);
+
+    static std::array<float, intervals + 1> make_table() noexcept {
+        std::array<float, intervals + 1> values;
+        for (std::size_t i = 0; i <= intervals; ++i) {
+            double x = -static_cast<double>(range) + static_cast<double>(i) / steps_per_unit;
+            values[i] = static_cast<float>(math::sigmoid(x));
+        }
+        return values;
+    }
+
+    static inline std::array<float, intervals + 1> const table = make_table();
+};
+
+} // namespace classifier
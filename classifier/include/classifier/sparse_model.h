@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <utility>
+
+#include "classifier/aligned.h"
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/stream_bounds.h"
+
+namespace classifier {
+
+// One non-zero entry of a sparse feature row.
+struct SparseFeature {
+    std::uint32_t index;
+    float value;
+};
+
+// Logistic model over a large feature space whose rows carry only a few
+// non-zeros. Inference costs one weight lookup per non-zero. The on-disk
+// layout matches Model<N> and DynamicModel.
+class SparseModel {
+public:
+    SparseModel() noexcept : bias_(0.0f) {}
+    explicit SparseModel(std::size_t dimension) : weights_(dimension, 0.0f), bias_(0.0f) {}
+
+    // Linear score; repeated indices contribute once per occurrence.
+    Error linear(std::span<SparseFeature const> features, float& out) const noexcept {
+        float z = bias_;
+        for (auto const& feature : features) {
+            if (feature.index >= weights_.size()) {
+                return Error::dimension_mismatch;
+            }
+            z += weights_[feature.index] * feature.value;
+        }
+        out = z;
+        return Error::none;
+    }
+
+    Error classify(std::span<SparseFeature const> features, Result& result) const noexcept {
+        if (weights_.empty()) {
+            result = {Prediction::unknown, 0.0f};
+            return Error::none;
+        }
+        float z = 0.0f;
+        if (Error error = linear(features, z); error != Error::none) {
+            return error;
+        }
+        float score = math::sigmoid(z);
+        if (score >= 0.5f) {
+            result = {Prediction::positive, score};
+        } else {
+            result = {Prediction::negative, 1.0f - score};
+        }
+        return Error::none;
+    }
+
+    float weight(std::size_t index) const noexcept { return weights_[index]; }
+    void set_weight(std::size_t index, float value) noexcept { weights_[index] = value; }
+    std::size_t dimension() const noexcept { return weights_.size(); }
+    std::span<float const> weights() const noexcept { return weights_; }
+    std::span<float> weights() noexcept { return weights_; }
+
+    float bias() const noexcept { return bias_; }
+    void set_bias(float value) noexcept { bias_ = value; }
+
+    Error serialize(std::ostream& os) const noexcept {
+        std::size_t n = weights_.size();
+        os.write(reinterpret_cast<char const*>(&n), sizeof(n));
+        os.write(reinterpret_cast<char const*>(weights_.data()), sizeof(float) * n);
+        os.write(reinterpret_cast<char const*>(&bias_), sizeof(bias_));
+        if (!os) {
+            return Error::io_failed;
+        }
+        return Error::none;
+    }
+
+    Error deserialize(std::istream& is) noexcept {
+        std::size_t n = 0;
+        is.read(reinterpret_cast<char*>(&n), sizeof(n));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (!detail::fits_in_stream(is, n, sizeof(float))) {
+            return Error::io_failed;
+        }
+        AlignedVector<float> weights(n);
+        float bias = 0.0f;
+        is.read(reinterpret_cast<char*>(weights.data()), sizeof(float) * n);
+        is.read(reinterpret_cast<char*>(&bias), sizeof(bias));
+        if (!is) {
+            return Error::io_failed;
+        }
+        weights_ = std::move(weights);
+        bias_ = bias;
+        return Error::none;
+    }
+
+private:
+    AlignedVector<float> weights_;
+    float bias_;
+};
+
+} // namespace classifier
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "classifier/math.h"
+#include "classifier/sparse_model.h"
+#include "classifier/stream_bounds.h"
+#include "classifier/trainer.h"
+
+namespace classifier {
+
+static_assert(sizeof(SparseFeature) == 8, "CSR files store SparseFeature as raw bytes");
+
+// Compressed sparse rows: row r is features[offsets[r], offsets[r + 1]) with
+// label labels[r]. Every index must be below `dimension`.
+struct CsrTrainingSet {
+    std::size_t dimension = 0;
+    std::vector<std::size_t> offsets = {0};
+    std::vector<SparseFeature> features;
+    std::vector<float> labels;
+
+    std::size_t rows() const noexcept { return labels.size(); }
+    bool empty() const noexcept { return labels.empty(); }
+    std::span<SparseFeature const> row(std::size_t r) const noexcept {
+        return {features.data() + offsets[r], offsets[r + 1] - offsets[r]};
+    }
+
+    void add_row(std::span<SparseFeature const> row, float label) {
+        features.insert(features.end(), row.begin(), row.end());
+        offsets.push_back(features.size());
+        labels.push_back(label);
+    }
+
+    // Offsets start at 0, never decrease and end at features.size(), and
+    // every index is in range.
+    bool valid() const noexcept {
+        if (offsets.size() != labels.size() + 1 || offsets.front() != 0 ||
+            offsets.back() != features.size()) {
+            return false;
+        }
+        for (std::size_t r = 0; r < labels.size(); ++r) {
+            if (offsets[r + 1] < offsets[r]) {
+                return false;
+            }
+        }
+        for (auto const& feature : features) {
+            if (feature.index >= dimension) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+struct SparseSgdOptions {
+    float learning_rate = 0.1f;
+    std::size_t epochs = 10;
+    bool shuffle = true;
+    std::uint64_t seed = 0;
+    Regularization regularization = Regularization::none;
+    float regularization_strength = 0.0f;
+};
+
+// Per-sample SGD over CSR rows. Each step reads and writes only the weights
+// of the row's non-zeros, yet matches shrinking every weight on every step
+// (L1 clipped at zero) up to rounding: L2 folds the shrink into a shared
+// scale factor, and L1 applies the shrinks a weight sat out in closed form
+// the next time it is touched and once more for all weights at the end.
+class SparseTrainer {
+public:
+    explicit SparseTrainer(SparseModel& model) noexcept : model_(model) {}
+
+    // Layout: "CLSR" magic and version (uint32 each), then dimension, rows and
+    // non-zero count (size_t), rows + 1 offsets (size_t), the non-zeros as
+    // (uint32 index, float value) pairs and one float label per row.
+    static Error serialize_training_data(std::ostream& os, CsrTrainingSet const& data) noexcept {
+        std::uint32_t header[2] = {magic, version};
+        std::size_t sizes[3] = {data.dimension, data.rows(), data.features.size()};
+        os.write(reinterpret_cast<char const*>(header), sizeof(header));
+        os.write(reinterpret_cast<char const*>(sizes), sizeof(sizes));
+        os.write(reinterpret_cast<char const*>(data.offsets.data()),
+                 static_cast<std::streamsize>(sizeof(std::size_t) * data.offsets.size()));
+        os.write(reinterpret_cast<char const*>(data.features.data()),
+                 static_cast<std::streamsize>(sizeof(SparseFeature) * data.features.size()));
+        os.write(reinterpret_cast<char const*>(data.labels.data()),
+                 static_cast<std::streamsize>(sizeof(float) * data.labels.size()));
+        if (!os) {
+            return Error::io_failed;
+        }
+        return Error::none;
+    }
+
+    static Error deserialize_training_data(std::istream& is, CsrTrainingSet& out) noexcept {
+        std::uint32_t header[2] = {};
+        is.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (header[0] != magic || header[1] != version) {
+            return Error::invalid_format;
+        }
+
+        std::size_t sizes[3] = {};
+        is.read(reinterpret_cast<char*>(sizes), sizeof(sizes));
+        if (!is) {
+            return Error::io_failed;
+        }
+        auto [dimension, rows, nnz] = sizes;
+        if (dimension > std::size_t(std::numeric_limits<std::uint32_t>::max()) + 1) {
+            return Error::invalid_format;
+        }
+        // Each row costs an offset and a label, plus the leading offset.
+        std::uint64_t const available = detail::remaining_bytes(is);
+        std::uint64_t const row_bytes = sizeof(std::size_t) + sizeof(float);
+        if (rows >= available / row_bytes ||
+            nnz > (available - row_bytes * rows - sizeof(std::size_t)) / sizeof(SparseFeature)) {
+            return Error::io_failed;
+        }
+
+        CsrTrainingSet loaded;
+        loaded.dimension = dimension;
+        loaded.offsets.resize(rows + 1);
+        loaded.features.resize(nnz);
+        loaded.labels.resize(rows);
+        is.read(reinterpret_cast<char*>(loaded.offsets.data()),
+                static_cast<std::streamsize>(sizeof(std::size_t) * (rows + 1)));
+        is.read(reinterpret_cast<char*>(loaded.features.data()),
+                static_cast<std::streamsize>(sizeof(SparseFeature) * nnz));
+        is.read(reinterpret_cast<char*>(loaded.labels.data()),
+                static_cast<std::streamsize>(sizeof(float) * rows));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (!loaded.valid()) {
+            return Error::invalid_format;
+        }
+        out = std::move(loaded);
+        return Error::none;
+    }
+
+    Error train(CsrTrainingSet const& data, SparseSgdOptions const& options) noexcept {
+        if (data.empty()) {
+            return Error::empty_training_set;
+        }
+        if (data.dimension != model_.dimension()) {
+            return Error::dimension_mismatch;
+        }
+        if (!data.valid()) {
+            return Error::invalid_format;
+        }
+        if (options.regularization_strength < 0.0f) {
+            return Error::invalid_regularization_strength;
+        }
+
+        float* weights = model_.weights().data();
+        float bias = model_.bias();
+        float const shrink = options.learning_rate * options.regularization_strength;
+        bool const l1 = options.regularization == Regularization::l1 && shrink > 0.0f;
+        bool const l2 = options.regularization == Regularization::l2 && shrink > 0.0f;
+
+        // L2 keeps weights as scale * weights[i], so shrinking every weight is
+        // one multiply. L1 keeps each weight next to the step it was last
+        // brought up to date, so a non-zero costs one cache miss, not two.
+        float scale = 1.0f;
+        std::vector<L1Weight> l1_state;
+        if (l1) {
+            l1_state.resize(model_.dimension());
+            for (std::size_t i = 0; i < l1_state.size(); ++i) {
+                l1_state[i].value = weights[i];
+            }
+        }
+
+        std::vector<std::size_t> order(data.rows());
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::mt19937_64 rng(options.seed);
+
+        std::uint64_t step = 0;
+        for (std::size_t epoch = 0; epoch < options.epochs; ++epoch) {
+            if (options.shuffle) {
+                detail::shuffle(order, rng);
+            }
+            for (std::size_t r : order) {
+                auto row = data.row(r);
+                ++step;
+
+                float z = 0.0f;
+                if (l1) {
+                    for (auto const& feature : row) {
+                        L1Weight& w = l1_state[feature.index];
+                        catch_up(w, step, shrink);
+                        z += w.value * feature.value;
+                    }
+                } else {
+                    if (l2) {
+                        scale *= 1.0f - shrink;
+                        if (std::fabs(scale) < min_scale) {
+                            rescale(model_.weights(), scale);
+                        }
+                    }
+                    for (auto const& feature : row) {
+                        z += weights[feature.index] * feature.value;
+                    }
+                    z *= scale;
+                }
+
+                float step_size = options.learning_rate * (math::sigmoid(z + bias) - data.labels[r]);
+                if (l1) {
+                    for (auto const& feature : row) {
+                        l1_state[feature.index].value -= step_size * feature.value;
+                    }
+                } else {
+                    float scaled_step = step_size / scale;
+                    for (auto const& feature : row) {
+                        weights[feature.index] -= scaled_step * feature.value;
+                    }
+                }
+                bias -= step_size;
+            }
+        }
+
+        if (l1) {
+            for (std::size_t i = 0; i < l1_state.size(); ++i) {
+                catch_up(l1_state[i], step, shrink);
+                weights[i] = l1_state[i].value;
+            }
+        } else if (scale != 1.0f) {
+            rescale(model_.weights(), scale);
+        }
+        model_.set_bias(bias);
+        return Error::none;
+    }
+
+private:
+    static constexpr std::uint32_t magic = 0x52534c43; // "CLSR"
+    static constexpr std::uint32_t version = 1;
+
+    static constexpr float min_scale = 1e-9f;
+
+    struct L1Weight {
+        float value = 0.0f;
+        std::uint64_t last_step = 0;
+    };
+
+    // Applies the L1 shrinks, clipped at zero, for the steps since the
+    // weight was last brought up to date, up to and including `step`.
+    static void catch_up(L1Weight& w, std::uint64_t step, float shrink) noexcept {
+        std::uint64_t steps = step - w.last_step;
+        w.last_step = step;
+        if (steps == 0 || w.value == 0.0f) {
+            return;
+        }
+        float magnitude = std::fabs(w.value) - shrink * static_cast<float>(steps);
+        w.value = magnitude > 0.0f ? std::copysign(magnitude, w.value) : 0.0f;
+    }
+
+    static void rescale(std::span<float> weights, float& scale) noexcept {
+        for (float& w : weights) {
+            w *= scale;
+        }
+        scale = 1.0f;
+    }
+
+    SparseModel& model_;
+};
+
+} // namespace classifier
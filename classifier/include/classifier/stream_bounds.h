@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+
+namespace classifier::detail {
+
+// Upper bound on the bytes a reader may allocate for a stream it cannot seek
+// to the end of, such as a pipe or socket.
+inline constexpr std::uint64_t unseekable_stream_limit = std::uint64_t(1) << 30;
+
+// Bytes between the read position of `is` and its end, or
+// unseekable_stream_limit when the stream cannot report that.
+inline std::uint64_t remaining_bytes(std::istream& is) noexcept {
+    std::istream::pos_type const here = is.tellg();
+    if (here == std::istream::pos_type(-1)) {
+        return unseekable_stream_limit;
+    }
+    is.seekg(0, std::ios::end);
+    std::istream::pos_type const end = is.tellg();
+    is.clear();
+    is.seekg(here);
+    if (end == std::istream::pos_type(-1) || end < here) {
+        return unseekable_stream_limit;
+    }
+    return static_cast<std::uint64_t>(end - here);
+}
+
+// Whether `count` elements of `element_size` bytes can still be read from
+// `is`. Sizes come straight from the stream, so readers check them with this
+// before allocating: a corrupt or hostile header then fails like any other
+// short read instead of throwing bad_alloc out of a noexcept reader. Divides
+// instead of multiplying, so a huge count cannot overflow into a small total.
+inline bool fits_in_stream(std::istream& is, std::uint64_t count,
+                           std::size_t element_size) noexcept {
+    return count <= remaining_bytes(is) / element_size;
+}
+
+} // namespace classifier::detail
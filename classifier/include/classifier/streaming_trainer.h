@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "classifier/math.h"
+#include "classifier/model.h"
+#include "classifier/trainer.h"
+
+namespace classifier {
+
+struct StreamingOptions {
+    float learning_rate = 0.1f;
+    std::size_t passes = 1;
+    std::size_t chunk_rows = 65536;
+    std::size_t batch_size = 32;
+    bool shuffle = false;
+    std::uint64_t seed = 0;
+    Regularization regularization = Regularization::none;
+    float regularization_strength = 0.0f;
+};
+
+// Out-of-core SGD over a [cols][rows][floats...] stream. A prefetch thread
+// reads the next chunk into one of two buffers while mini-batch updates run
+// on the other; extra passes seek back to the first row.
+template <std::size_t N>
+class StreamingTrainer {
+public:
+    using Sample = typename Trainer<N>::Sample;
+
+    explicit StreamingTrainer(Model<N>& model) noexcept : model_(model) {}
+
+    Error train(char const* path, StreamingOptions const& options) noexcept {
+        std::ifstream is(path, std::ios::binary);
+        if (!is) {
+            return Error::io_failed;
+        }
+        return train(is, options);
+    }
+
+    Error train(std::istream& is, StreamingOptions const& options) noexcept {
+        if (options.regularization_strength < 0.0f) {
+            return Error::invalid_regularization_strength;
+        }
+        if (options.batch_size == 0 || options.chunk_rows == 0) {
+            return Error::invalid_batch_size;
+        }
+
+        std::size_t cols = 0;
+        is.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (cols != N + 1) {
+            return Error::dimension_mismatch;
+        }
+        std::size_t rows = 0;
+        is.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+        if (!is) {
+            return Error::io_failed;
+        }
+        if (rows == 0) {
+            return Error::empty_training_set;
+        }
+
+        std::istream::pos_type start = is.tellg();
+        std::uint64_t chunk_index = 0;
+        for (std::size_t pass = 0; pass < options.passes; ++pass) {
+            if (pass > 0) {
+                is.clear();
+                is.seekg(start);
+                if (!is) {
+                    return Error::io_failed;
+                }
+            }
+            Error error = train_pass(is, rows, options, chunk_index);
+            if (error != Error::none) {
+                return error;
+            }
+        }
+        return Error::none;
+    }
+
+private:
+    struct Buffer {
+        std::vector<Sample> samples;
+        std::size_t count = 0;
+        bool ready = false;
+    };
+
+    Error train_pass(std::istream& is, std::size_t rows, StreamingOptions const& options,
+                     std::uint64_t& chunk_index) noexcept {
+        std::size_t chunk_rows = std::min(options.chunk_rows, rows);
+        Buffer buffers[2];
+        for (auto& buffer : buffers) {
+            buffer.samples.resize(chunk_rows);
+        }
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool stopping = false;
+        Error read_error = Error::none;
+
+        std::thread prefetch([&] {
+            std::size_t remaining = rows;
+            for (std::size_t k = 0; remaining > 0; ++k) {
+                Buffer& buffer = buffers[k % 2];
+                {
+                    std::unique_lock lock(mutex);
+                    cv.wait(lock, [&] { return stopping || !buffer.ready; });
+                    if (stopping) {
+                        return;
+                    }
+                }
+                std::size_t count = std::min(chunk_rows, remaining);
+                is.read(reinterpret_cast<char*>(buffer.samples.data()),
+                        static_cast<std::streamsize>(sizeof(Sample) * count));
+                bool ok = static_cast<bool>(is);
+                {
+                    std::lock_guard lock(mutex);
+                    buffer.count = ok ? count : 0;
+                    buffer.ready = true;
+                    if (!ok) {
+                        read_error = Error::io_failed;
+                    }
+                }
+                cv.notify_all();
+                if (!ok) {
+                    return;
+                }
+                remaining -= count;
+            }
+        });
+
+        Trainer<N> trainer(model_);
+        SgdOptions sgd;
+        sgd.learning_rate = options.learning_rate;
+        sgd.epochs = 1;
+        sgd.batch_size = options.batch_size;
+        sgd.shuffle = options.shuffle;
+        sgd.threads = 1;
+        sgd.regularization = options.regularization;
+        sgd.regularization_strength = options.regularization_strength;
+
+        Error error = Error::none;
+        std::size_t consumed = 0;
+        for (std::size_t k = 0; consumed < rows; ++k) {
+            Buffer& buffer = buffers[k % 2];
+            {
+                std::unique_lock lock(mutex);
+                cv.wait(lock, [&] { return buffer.ready; });
+                if (read_error != Error::none && buffer.count == 0) {
+                    error = read_error;
+                    break;
+                }
+            }
+
+            sgd.seed = options.seed + chunk_index++;
+            error = trainer.train_sgd(std::span<Sample const>(buffer.samples.data(), buffer.count),
+                                      sgd);
+            if (error != Error::none) {
+                break;
+            }
+            consumed += buffer.count;
+            {
+                std::lock_guard lock(mutex);
+                buffer.ready = false;
+            }
+            cv.notify_all();
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        prefetch.join();
+        return error;
+    }
+
+    Model<N>& model_;
+};
+
+} // namespace classifier
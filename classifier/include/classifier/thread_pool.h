@@ -0,0 +1,163 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace classifier {
+
+// Fork-join pool: run(fn) calls fn(t) once for every participant t in
+// [0, size()), with the calling thread acting as participant 0. Participant
+// indices are stable, so work split by index is reproducible run to run.
+// run_tasks(count, fn) spreads independent tasks of uneven cost over the
+// participants with work stealing.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threads) : size_(threads == 0 ? 1 : threads) {
+        workers_.reserve(size_ - 1);
+        for (std::size_t t = 1; t < size_; ++t) {
+            workers_.emplace_back([this, t] { worker_loop(t); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        start_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    std::size_t size() const noexcept { return size_; }
+
+    template <typename F>
+    void run(F&& fn) noexcept {
+        if (size_ == 1) {
+            fn(std::size_t(0));
+            return;
+        }
+        {
+            std::lock_guard lock(mutex_);
+            job_ = const_cast<void*>(static_cast<void const*>(&fn));
+            invoke_ = [](void* job, std::size_t t) {
+                (*static_cast<std::remove_reference_t<F>*>(job))(t);
+            };
+            pending_ = size_ - 1;
+            ++generation_;
+        }
+        start_.notify_all();
+        fn(std::size_t(0));
+
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        job_ = nullptr;
+    }
+
+    // Calls fn(task, t) once for every task in [0, count), t being the
+    // participant that runs it. Tasks start dealt out in contiguous ranges,
+    // one per participant; a participant takes tasks from the front of its
+    // own range and, once that is empty, steals from the back of the others'.
+    // Which participant runs a task is not deterministic, so fn should only
+    // write state owned by the task.
+    template <typename F>
+    void run_tasks(std::size_t count, F&& fn) noexcept {
+        std::vector<TaskRange> ranges(size_);
+        for (std::size_t t = 0; t < size_; ++t) {
+            ranges[t].front = count * t / size_;
+            ranges[t].back = count * (t + 1) / size_;
+        }
+        run([&](std::size_t t) {
+            std::size_t task = 0;
+            while (ranges[t].pop_front(task)) {
+                fn(task, t);
+            }
+            for (std::size_t step = 1; step < size_;) {
+                if (ranges[(t + step) % size_].pop_back(task)) {
+                    fn(task, t);
+                    step = 1;
+                } else {
+                    ++step;
+                }
+            }
+        });
+    }
+
+    static std::size_t default_size() noexcept {
+        std::size_t n = std::thread::hardware_concurrency();
+        return n == 0 ? 1 : n;
+    }
+
+private:
+    // A participant's remaining tasks [front, back). Tasks are expected to be
+    // coarse, so a lock per range costs nothing measurable.
+    struct alignas(64) TaskRange {
+        std::mutex mutex;
+        std::size_t front = 0;
+        std::size_t back = 0;
+
+        bool pop_front(std::size_t& task) noexcept {
+            std::lock_guard lock(mutex);
+            if (front == back) {
+                return false;
+            }
+            task = front++;
+            return true;
+        }
+
+        bool pop_back(std::size_t& task) noexcept {
+            std::lock_guard lock(mutex);
+            if (front == back) {
+                return false;
+            }
+            task = --back;
+            return true;
+        }
+    };
+
+    void worker_loop(std::size_t t) {
+        std::uint64_t seen = 0;
+        for (;;) {
+            void* job = nullptr;
+            void (*invoke)(void*, std::size_t) = nullptr;
+            {
+                std::unique_lock lock(mutex_);
+                start_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) {
+                    return;
+                }
+                seen = generation_;
+                job = job_;
+                invoke = invoke_;
+            }
+            invoke(job, t);
+            {
+                std::lock_guard lock(mutex_);
+                --pending_;
+            }
+            done_.notify_one();
+        }
+    }
+
+    std::size_t size_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    void* job_ = nullptr;
+    void (*invoke_)(void*, std::size_t) = nullptr;
+    std::size_t pending_ = 0;
+    std::uint64_t generation_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace classifier
@@ -1,29 +1,107 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <istream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <span>
 #include <vector>
 
+#include "classifier/aligned.h"
+#include "classifier/columnar.h"
+#include "classifier/kernels.h"
+#include "classifier/kernels_fixed.h"
 #include "classifier/math.h"
+#include "classifier/metrics.h"
 #include "classifier/model.h"
+#include "classifier/optimizer.h"
+#include "classifier/sigmoid.h"
+#include "classifier/stream_bounds.h"
+#include "classifier/thread_pool.h"
+#include "classifier/training_monitor.h"
 
 namespace classifier {
 
 enum class Regularization { none, l1, l2 };
 
-template <std::size_t N>
+struct SgdOptions {
+    float learning_rate = 0.1f;
+    std::size_t epochs = 10;
+    std::size_t batch_size = 256;
+    bool shuffle = true;
+    std::uint64_t seed = 0;
+    // 0 uses one thread per hardware thread.
+    std::size_t threads = 1;
+    Regularization regularization = Regularization::none;
+    float regularization_strength = 0.0f;
+    // Trailing fraction of the samples held out for validation, in [0, 1).
+    float validation_fraction = 0.0f;
+    EarlyStopping early_stopping;
+};
+
+namespace detail {
+
+// Fisher-Yates with the raw engine output, so the permutation depends only
+// on the seed and not on the standard library's distribution classes.
+inline void shuffle(std::vector<std::size_t>& order, std::mt19937_64& rng) noexcept {
+    for (std::size_t i = order.size(); i > 1; --i) {
+        std::size_t j = static_cast<std::size_t>(rng() % i);
+        std::swap(order[i - 1], order[j]);
+    }
+}
+
+} // namespace detail
+
+// Per-epoch learning rate: constant, lr / (1 + decay * epoch) for
+// inverse_time, or lr * decay^epoch for exponential. inverse_time takes a
+// decay of at least 0 and exponential one in (0, 1].
+enum class LearningRateSchedule { constant, inverse_time, exponential };
+
+struct HogwildOptions {
+    float learning_rate = 0.1f;
+    LearningRateSchedule schedule = LearningRateSchedule::constant;
+    float decay = 0.0f;
+    std::size_t epochs = 10;
+    std::uint64_t seed = 0;
+    // 0 uses one thread per hardware thread.
+    std::size_t threads = 0;
+    Regularization regularization = Regularization::none;
+    float regularization_strength = 0.0f;
+};
+
+inline float scheduled_learning_rate(HogwildOptions const& options, std::size_t epoch) noexcept {
+    auto t = static_cast<float>(epoch);
+    switch (options.schedule) {
+    case LearningRateSchedule::constant: break;
+    case LearningRateSchedule::inverse_time:
+        return options.learning_rate / (1.0f + options.decay * t);
+    case LearningRateSchedule::exponential:
+        return options.learning_rate * std::pow(options.decay, t);
+    }
+    return options.learning_rate;
+}
+
+template <std::size_t N, SigmoidPolicy Sigmoid = ExactSigmoid>
 class Trainer {
 public:
-    explicit Trainer(Model<N>& model) noexcept : model_(model) {}
+    explicit Trainer(Model<N, Sigmoid>& model) noexcept : model_(model) {}
 
     using Sample = std::array<float, N + 1>;
     using TrainingSet = std::vector<Sample>;
 
     static Error deserialize_training_data(std::istream& is, TrainingSet& out) noexcept {
+        metrics::ReadCall call(metrics::detail::ReadSource::training_data);
         std::size_t cols = 0;
         is.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+        call.read(is.gcount());
         if (!is) {
             return Error::io_failed;
         }
@@ -33,14 +111,19 @@ public:
 
         std::size_t rows = 0;
         is.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+        call.read(is.gcount());
         if (!is) {
             return Error::io_failed;
         }
+        if (!detail::fits_in_stream(is, rows, sizeof(Sample))) {
+            return Error::io_failed;
+        }
 
         out.resize(rows);
         for (std::size_t r = 0; r < rows; ++r) {
             is.read(reinterpret_cast<char*>(out[r].data()),
                     sizeof(float) * (N + 1));
+            call.read(is.gcount());
             if (!is) {
                 return Error::io_failed;
             }
@@ -48,7 +131,7 @@ public:
         return Error::none;
     }
 
-    Error train(TrainingSet const& data, float learning_rate = 0.1f,
+    Error train(std::span<Sample const> data, float learning_rate = 0.1f,
                 std::size_t epochs = 100,
                 Regularization regularization = Regularization::none,
                 float regularization_strength = 0.0f) noexcept {
@@ -60,51 +143,449 @@ public:
         }
 
         for (std::size_t epoch = 0; epoch < epochs; ++epoch) {
-            std::array<float, N> weight_gradients{};
-            float bias_gradient = 0.0f;
-
+            [[maybe_unused]] metrics::EpochCall timed;
+            Gradients gradients{};
             for (auto const& sample : data) {
-                float label = sample[N];
+                accumulate(sample, gradients);
+            }
+            apply(gradients, static_cast<float>(data.size()), learning_rate, regularization,
+                  regularization_strength);
+        }
+        return Error::none;
+    }
 
-                float z = 0.0f;
+    // train() over the subset data[rows[0]], data[rows[1]], ... without
+    // copying it, e.g. a cross-validation fold. Every index must be below
+    // data.size().
+    Error train(std::span<Sample const> data, std::span<std::size_t const> rows,
+                float learning_rate = 0.1f, std::size_t epochs = 100,
+                Regularization regularization = Regularization::none,
+                float regularization_strength = 0.0f) noexcept {
+        if (rows.empty()) {
+            return Error::empty_training_set;
+        }
+        if (regularization_strength < 0.0f) {
+            return Error::invalid_regularization_strength;
+        }
+
+        for (std::size_t epoch = 0; epoch < epochs; ++epoch) {
+            [[maybe_unused]] metrics::EpochCall timed;
+            Gradients gradients{};
+            for (std::size_t row : rows) {
+                accumulate(data[row], gradients);
+            }
+            apply(gradients, static_cast<float>(rows.size()), learning_rate, regularization,
+                  regularization_strength);
+        }
+        return Error::none;
+    }
+
+    // Full-batch gradient descent over a columnar set: the forward pass and
+    // gradients run down feature columns a block of samples at a time.
+    Error train(ColumnarTrainingSet<N> const& data, float learning_rate = 0.1f,
+                std::size_t epochs = 100,
+                Regularization regularization = Regularization::none,
+                float regularization_strength = 0.0f) noexcept {
+        if (data.empty()) {
+            return Error::empty_training_set;
+        }
+        if (regularization_strength < 0.0f) {
+            return Error::invalid_regularization_strength;
+        }
+
+        constexpr std::size_t block = 256;
+        alignas(64) float errors[block];
+        float const* labels = data.labels().data();
+
+        for (std::size_t epoch = 0; epoch < epochs; ++epoch) {
+            [[maybe_unused]] metrics::EpochCall timed;
+            Gradients gradients{};
+            for (std::size_t begin = 0; begin < data.rows(); begin += block) {
+                std::size_t len = std::min(block, data.rows() - begin);
+
+                std::fill_n(errors, len, model_.bias());
                 for (std::size_t i = 0; i < N; ++i) {
-                    z += model_.weight(i) * sample[i];
+                    kernels::axpy(model_.weight(i), data.feature(i).data() + begin, errors, len);
+                }
+                Sigmoid::apply_inplace(errors, len);
+                for (std::size_t b = 0; b < len; ++b) {
+                    errors[b] -= labels[begin + b];
+                    gradients.bias += errors[b];
                 }
-                z += model_.bias();
-
-                float prediction = math::sigmoid(z);
-                float error = prediction - label;
 
                 for (std::size_t i = 0; i < N; ++i) {
-                    weight_gradients[i] += error * sample[i];
+                    gradients.weights[i] += kernels::dot(errors, data.feature(i).data() + begin, len);
                 }
-                bias_gradient += error;
             }
+            apply(gradients, static_cast<float>(data.rows()), learning_rate, regularization,
+                  regularization_strength);
+        }
+        return Error::none;
+    }
 
-            float m = static_cast<float>(data.size());
-            for (std::size_t i = 0; i < N; ++i) {
-                float gradient = weight_gradients[i] / m;
-
-                if (regularization == Regularization::l2) {
-                    gradient += regularization_strength * model_.weight(i);
-                } else if (regularization == Regularization::l1) {
-                    float w = model_.weight(i);
-                    if (w > 0.0f) {
-                        gradient += regularization_strength;
-                    } else if (w < 0.0f) {
-                        gradient -= regularization_strength;
+    // Mini-batch SGD. Each batch is split into one contiguous slice per
+    // thread; per-thread gradients are reduced in thread order, so results
+    // are reproducible for a fixed seed and thread count.
+    Error train_sgd(std::span<Sample const> data, SgdOptions const& options) noexcept {
+        GradientDescent optimizer;
+        return train_sgd(data, options, optimizer);
+    }
+
+    // train_sgd with the reduced batch gradient handed to `optimizer`, whose
+    // state persists across calls. options.learning_rate is the optimizer's
+    // base rate (alpha for Ftrl).
+    template <Optimizer O>
+    Error train_sgd(std::span<Sample const> data, SgdOptions const& options,
+                    O& optimizer) noexcept {
+        NullObserver observer;
+        return train_sgd(data, options, optimizer, observer);
+    }
+
+    // train_sgd reporting each epoch to `observer`. The last
+    // options.validation_fraction of `data` is held out from training and
+    // scored after every epoch. Losses and timings are only measured when
+    // the observer is not a NullObserver or early stopping is enabled.
+    template <Optimizer O, TrainingObserver Observer>
+    Error train_sgd(std::span<Sample const> data, SgdOptions const& options, O& optimizer,
+                    Observer& observer) noexcept {
+        if (!(options.validation_fraction >= 0.0f && options.validation_fraction < 1.0f)) {
+            return Error::invalid_validation_fraction;
+        }
+        auto held_out = static_cast<std::size_t>(options.validation_fraction *
+                                                 static_cast<float>(data.size()));
+        std::span<Sample const> training = data.first(data.size() - held_out);
+        std::span<Sample const> validation = data.last(held_out);
+        if (training.empty()) {
+            return Error::empty_training_set;
+        }
+        if (options.regularization_strength < 0.0f) {
+            return Error::invalid_regularization_strength;
+        }
+        if (options.batch_size == 0) {
+            return Error::invalid_batch_size;
+        }
+
+        if (!std::same_as<Observer, NullObserver> || options.early_stopping.patience > 0) {
+            run_sgd<true>(training, validation, options, optimizer, observer);
+        } else {
+            run_sgd<false>(training, validation, options, optimizer, observer);
+        }
+        return Error::none;
+    }
+
+    // Lock-free asynchronous SGD (Hogwild!). Each thread owns a contiguous
+    // slice of the samples, reshuffles it every epoch and applies per-sample
+    // updates straight to a shared, cache-line-aligned copy of the weights
+    // through relaxed atomics. Zero features are skipped, so threads working
+    // on sparse rows rarely touch the same cache lines; the bias, which every
+    // sample updates, is accumulated per thread and published every
+    // hogwild_bias_interval samples. Regularization only shrinks the weights
+    // a sample touches and is not caught up for the samples a weight sat out,
+    // so on sparse data it is weaker than train()'s, most of all for rare
+    // features. Results are only reproducible with a single thread.
+    Error train_hogwild(std::span<Sample const> data, HogwildOptions const& options) noexcept {
+        if (data.empty()) {
+            return Error::empty_training_set;
+        }
+        if (options.regularization_strength < 0.0f) {
+            return Error::invalid_regularization_strength;
+        }
+        if ((options.schedule == LearningRateSchedule::inverse_time && !(options.decay >= 0.0f)) ||
+            (options.schedule == LearningRateSchedule::exponential &&
+             !(options.decay > 0.0f && options.decay <= 1.0f))) {
+            return Error::invalid_decay;
+        }
+
+        // Weights first, bias alone on the following cache line.
+        constexpr std::size_t floats_per_line = cache_line_size / sizeof(float);
+        constexpr std::size_t bias_index = (N + floats_per_line - 1) / floats_per_line * floats_per_line;
+        AlignedVector<float> shared(bias_index + floats_per_line, 0.0f);
+        for (std::size_t i = 0; i < N; ++i) {
+            shared[i] = model_.weight(i);
+        }
+        shared[bias_index] = model_.bias();
+
+        std::size_t threads = options.threads == 0 ? ThreadPool::default_size() : options.threads;
+        threads = std::min(threads, data.size());
+        ThreadPool pool(threads);
+
+        std::vector<std::vector<std::size_t>> slices(pool.size());
+        std::vector<std::mt19937_64> rngs;
+        rngs.reserve(pool.size());
+        for (std::size_t t = 0; t < pool.size(); ++t) {
+            std::size_t first = data.size() * t / pool.size();
+            std::size_t last = data.size() * (t + 1) / pool.size();
+            slices[t].resize(last - first);
+            std::iota(slices[t].begin(), slices[t].end(), first);
+            rngs.emplace_back(options.seed + t);
+        }
+
+        for (std::size_t epoch = 0; epoch < options.epochs; ++epoch) {
+            [[maybe_unused]] metrics::EpochCall timed;
+            float learning_rate = scheduled_learning_rate(options, epoch);
+            pool.run([&](std::size_t t) {
+                detail::shuffle(slices[t], rngs[t]);
+                std::atomic_ref<float> bias(shared[bias_index]);
+                float bias_delta = 0.0f;
+                std::size_t pending = 0;
+                for (std::size_t index : slices[t]) {
+                    float error = hogwild_step(data[index], shared.data(),
+                                               bias.load(std::memory_order_relaxed) + bias_delta,
+                                               learning_rate, options.regularization,
+                                               options.regularization_strength);
+                    bias_delta -= learning_rate * error;
+                    if (++pending == hogwild_bias_interval) {
+                        bias.fetch_add(bias_delta, std::memory_order_relaxed);
+                        bias_delta = 0.0f;
+                        pending = 0;
                     }
                 }
+                bias.fetch_add(bias_delta, std::memory_order_relaxed);
+            });
+        }
 
-                model_.set_weight(i, model_.weight(i) - learning_rate * gradient);
-            }
-            model_.set_bias(model_.bias() - learning_rate * bias_gradient / m);
+        for (std::size_t i = 0; i < N; ++i) {
+            model_.set_weight(i, shared[i]);
         }
+        model_.set_bias(shared[bias_index]);
         return Error::none;
     }
 
 private:
-    Model<N>& model_;
+    // Samples a train_hogwild thread runs between publishing its bias updates.
+    static constexpr std::size_t hogwild_bias_interval = 64;
+
+    // Updates the shared weights for one sample scored with `bias` and
+    // returns its error, the bias gradient.
+    static float hogwild_step(Sample const& sample, float* shared, float bias,
+                              float learning_rate, Regularization regularization,
+                              float regularization_strength) noexcept {
+        using Ref = std::atomic_ref<float>;
+        constexpr auto relaxed = std::memory_order_relaxed;
+
+        float z = bias;
+        for (std::size_t i = 0; i < N; ++i) {
+            if (sample[i] != 0.0f) {
+                z += Ref(shared[i]).load(relaxed) * sample[i];
+            }
+        }
+        float error = Sigmoid::apply(z) - sample[N];
+
+        for (std::size_t i = 0; i < N; ++i) {
+            if (sample[i] == 0.0f) {
+                continue;
+            }
+            Ref weight(shared[i]);
+            float w = weight.load(relaxed);
+            float gradient = error * sample[i];
+            if (regularization == Regularization::l2) {
+                gradient += regularization_strength * w;
+            } else if (regularization == Regularization::l1) {
+                if (w > 0.0f) {
+                    gradient += regularization_strength;
+                } else if (w < 0.0f) {
+                    gradient -= regularization_strength;
+                }
+            }
+            weight.store(w - learning_rate * gradient, relaxed);
+        }
+        return error;
+    }
+
+    struct alignas(64) Gradients {
+        std::array<float, N> weights;
+        float bias;
+        // Summed log-loss, only accumulated when Track is set.
+        double loss;
+    };
+
+    template <bool Track>
+    void run_sgd(std::span<Sample const> data, std::span<Sample const> validation,
+                 SgdOptions const& options, Optimizer auto& optimizer,
+                 TrainingObserver auto& observer) noexcept {
+        std::size_t threads = options.threads == 0 ? ThreadPool::default_size() : options.threads;
+        ThreadPool pool(threads);
+        std::vector<Gradients> partials(pool.size());
+        optimizer.prepare(N);
+        detail::EarlyStopper stopper(options.early_stopping);
+
+        std::vector<std::size_t> order(data.size());
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::mt19937_64 rng(options.seed);
+
+        for (std::size_t epoch = 0; epoch < options.epochs; ++epoch) {
+            [[maybe_unused]] metrics::EpochCall timed;
+            [[maybe_unused]] std::chrono::steady_clock::time_point started;
+            [[maybe_unused]] Gradients sum{};
+            if constexpr (Track) {
+                started = std::chrono::steady_clock::now();
+            }
+            if (options.shuffle) {
+                detail::shuffle(order, rng);
+            }
+            for (std::size_t begin = 0; begin < order.size(); begin += options.batch_size) {
+                std::size_t end = std::min(order.size(), begin + options.batch_size);
+                std::size_t count = end - begin;
+
+                pool.run([&](std::size_t t) {
+                    Gradients& local = partials[t];
+                    local = Gradients{};
+                    std::size_t first = begin + count * t / pool.size();
+                    std::size_t last = begin + count * (t + 1) / pool.size();
+                    for (std::size_t i = first; i < last; ++i) {
+                        accumulate<Track>(data[order[i]], local);
+                    }
+                });
+
+                Gradients total = partials[0];
+                for (std::size_t t = 1; t < partials.size(); ++t) {
+                    for (std::size_t i = 0; i < N; ++i) {
+                        total.weights[i] += partials[t].weights[i];
+                    }
+                    total.bias += partials[t].bias;
+                    if constexpr (Track) {
+                        total.loss += partials[t].loss;
+                    }
+                }
+                if constexpr (Track) {
+                    for (std::size_t i = 0; i < N; ++i) {
+                        sum.weights[i] += total.weights[i];
+                    }
+                    sum.bias += total.bias;
+                    sum.loss += total.loss;
+                }
+                apply(total, static_cast<float>(count), optimizer, options);
+            }
+
+            if constexpr (Track) {
+                auto rows = static_cast<double>(data.size());
+                double norm = 0.0;
+                for (std::size_t i = 0; i < N; ++i) {
+                    norm += (sum.weights[i] / rows) * (sum.weights[i] / rows);
+                }
+                norm += (sum.bias / rows) * (sum.bias / rows);
+
+                EpochStats stats{epoch, sum.loss / rows, validation_loss(validation, pool),
+                                 std::sqrt(norm), std::chrono::steady_clock::now() - started};
+                bool stop = observer.on_epoch(stats) == EpochAction::stop;
+                double monitored = validation.empty() ? stats.training_loss
+                                                      : stats.validation_loss;
+                if (stopper.should_stop(monitored) || stop) {
+                    break;
+                }
+            }
+        }
+    }
+
+    double validation_loss(std::span<Sample const> validation, ThreadPool& pool) const noexcept {
+        if (validation.empty()) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        std::vector<double> partials(pool.size(), 0.0);
+        pool.run([&](std::size_t t) {
+            std::size_t first = validation.size() * t / pool.size();
+            std::size_t last = validation.size() * (t + 1) / pool.size();
+            double loss = 0.0;
+            for (std::size_t r = first; r < last; ++r) {
+                loss += math::logistic_loss(linear(validation[r]), validation[r][N]);
+            }
+            partials[t] = loss;
+        });
+        double total = 0.0;
+        for (double loss : partials) {
+            total += loss;
+        }
+        return total / static_cast<double>(validation.size());
+    }
+
+    float linear(Sample const& sample) const noexcept {
+        if constexpr (N <= kernels::unroll_limit) {
+            return kernels::dot_fixed<N>(model_.weights().data(), sample.data()) + model_.bias();
+        } else {
+            float z = 0.0f;
+            for (std::size_t i = 0; i < N; ++i) {
+                z += model_.weight(i) * sample[i];
+            }
+            return z + model_.bias();
+        }
+    }
+
+    template <bool Track = false>
+    void accumulate(Sample const& sample, Gradients& gradients) const noexcept {
+        float label = sample[N];
+        float z = linear(sample);
+        if constexpr (Track) {
+            gradients.loss += math::logistic_loss(z, label);
+        }
+
+        float prediction = Sigmoid::apply(z);
+        float error = prediction - label;
+
+        if constexpr (N <= kernels::unroll_limit) {
+            kernels::axpy_fixed<N>(error, sample.data(), gradients.weights.data());
+        } else {
+            for (std::size_t i = 0; i < N; ++i) {
+                gradients.weights[i] += error * sample[i];
+            }
+        }
+        gradients.bias += error;
+    }
+
+    void apply(Gradients const& gradients, float m, float learning_rate,
+               Regularization regularization, float regularization_strength) noexcept {
+        for (std::size_t i = 0; i < N; ++i) {
+            float gradient = gradients.weights[i] / m;
+
+            if (regularization == Regularization::l2) {
+                gradient += regularization_strength * model_.weight(i);
+            } else if (regularization == Regularization::l1) {
+                float w = model_.weight(i);
+                if (w > 0.0f) {
+                    gradient += regularization_strength;
+                } else if (w < 0.0f) {
+                    gradient -= regularization_strength;
+                }
+            }
+
+            model_.set_weight(i, model_.weight(i) - learning_rate * gradient);
+        }
+        model_.set_bias(model_.bias() - learning_rate * gradients.bias / m);
+    }
+
+    template <Optimizer O>
+    void apply(Gradients const& gradients, float m, O& optimizer,
+               SgdOptions const& options) noexcept {
+        float strength = options.regularization_strength;
+        float l1 = options.regularization == Regularization::l1 ? strength : 0.0f;
+        float l2 = options.regularization == Regularization::l2 ? strength : 0.0f;
+        optimizer.begin_step({options.learning_rate, l1, l2});
+
+        std::span<float, N> weights = model_.weights();
+        auto update = [&](std::size_t i) {
+            float gradient = gradients.weights[i] / m;
+            if constexpr (!O::proximal) {
+                float w = weights[i];
+                float sign = static_cast<float>(w > 0.0f) - static_cast<float>(w < 0.0f);
+                // Two adds, as in the other apply, so plain descent matches
+                // train() bit for bit.
+                gradient += l2 * w;
+                gradient += l1 * sign;
+            }
+            optimizer.update(i, weights[i], gradient);
+        };
+        if constexpr (N <= kernels::unroll_limit) {
+            kernels::unrolled<N>(update);
+        } else {
+            for (std::size_t i = 0; i < N; ++i) {
+                update(i);
+            }
+        }
+        float bias = model_.bias();
+        optimizer.update(N, bias, gradients.bias / m);
+        model_.set_bias(bias);
+    }
+
+    Model<N, Sigmoid>& model_;
 };
 
 } // namespace classifier
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace classifier {
+
+// What one epoch of training looked like.
+struct EpochStats {
+    // Zero-based.
+    std::size_t epoch;
+    // Mean log-loss over the training rows, accumulated during the gradient
+    // pass, i.e. with each batch scored by the weights before its update.
+    double training_loss;
+    // Mean log-loss over the held-out rows after the epoch; NaN without a
+    // validation split.
+    double validation_loss;
+    // L2 norm of the mean data gradient (weights and bias) over the epoch,
+    // before regularization.
+    double gradient_norm;
+    std::chrono::nanoseconds wall_time;
+};
+
+enum class EpochAction { proceed, stop };
+
+// Called once per epoch; returning EpochAction::stop ends training early.
+// Must not throw, since training runs in noexcept functions.
+template <typename O>
+concept TrainingObserver = requires(O& observer, EpochStats const& stats) {
+    { observer.on_epoch(stats) } noexcept -> std::same_as<EpochAction>;
+};
+
+// The default observer. Training with it and without early stopping
+// measures nothing: the loss and timing code is compiled out.
+struct NullObserver {
+    EpochAction on_epoch(EpochStats const&) noexcept { return EpochAction::proceed; }
+};
+
+// Keeps every epoch's stats, e.g. to plot the loss curve. An epoch that
+// cannot be stored for lack of memory is left out rather than ending
+// training.
+struct LossHistory {
+    std::vector<EpochStats> epochs;
+
+    EpochAction on_epoch(EpochStats const& stats) noexcept {
+        try {
+            epochs.push_back(stats);
+        } catch (std::bad_alloc const&) {
+        }
+        return EpochAction::proceed;
+    }
+};
+
+// Stops once the monitored loss (validation if there is a split, training
+// otherwise) has failed to beat its best value by more than `tolerance` for
+// `patience` consecutive epochs. A patience of 0 disables it.
+struct EarlyStopping {
+    double tolerance = 0.0;
+    std::size_t patience = 0;
+};
+
+namespace detail {
+
+class EarlyStopper {
+public:
+    explicit EarlyStopper(EarlyStopping const& settings) noexcept : settings_(settings) {}
+
+    bool should_stop(double loss) noexcept {
+        if (settings_.patience == 0) {
+            return false;
+        }
+        if (loss < best_ - settings_.tolerance) {
+            best_ = loss;
+            stale_ = 0;
+            return false;
+        }
+        return ++stale_ >= settings_.patience;
+    }
+
+private:
+    EarlyStopping settings_;
+    double best_ = std::numeric_limits<double>::infinity();
+    std::size_t stale_ = 0;
+};
+
+} // namespace detail
+
+} // namespace classifier
@@ -0,0 +1,137 @@
+// Load generator for ScoringServer: starts a server in-process, then drives
+// it with closed-loop clients at increasing concurrency and prints
+// throughput against client-side p50/p99 latency for each level.
+//
+//   scoring_load [unix|tcp] [queue_delay_us] [rows_per_request] [seconds_per_level]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <classifier/latency_histogram.h>
+#include <classifier/model.h>
+#include <classifier/scoring_server.h>
+
+namespace {
+
+constexpr std::size_t features = 32;
+
+struct Level {
+    double requests_per_second;
+    double rows_per_second;
+    classifier::LatencyHistogram latency;
+};
+
+Level run_level(classifier::ScoringServerOptions const& options, std::uint16_t port,
+                std::size_t clients, std::size_t rows, std::chrono::duration<double> length) {
+    std::atomic<bool> running{true};
+    std::atomic<std::size_t> failures{0};
+    std::vector<classifier::LatencyHistogram> latencies(clients);
+    std::vector<std::thread> threads;
+    for (std::size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            classifier::ScoringClient<features> client;
+            auto connected = options.unix_path.empty() ? client.connect_tcp(port)
+                                                       : client.connect_unix(options.unix_path);
+            if (connected != classifier::Error::none) {
+                ++failures;
+                return;
+            }
+            std::mt19937_64 rng(c);
+            std::normal_distribution<float> feature(0.0f, 1.0f);
+            std::vector<float> values(rows * features);
+            for (auto& v : values) {
+                v = feature(rng);
+            }
+            std::vector<float> scores(rows);
+            while (running.load(std::memory_order_relaxed)) {
+                auto sent = std::chrono::steady_clock::now();
+                if (client.score(values, scores) != classifier::Error::none) {
+                    ++failures;
+                    return;
+                }
+                latencies[c].record(std::chrono::steady_clock::now() - sent);
+            }
+        });
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(length);
+    running.store(false);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    if (failures.load() > 0) {
+        std::fprintf(stderr, "%zu clients failed\n", failures.load());
+    }
+
+    Level level{};
+    for (auto const& latency : latencies) {
+        level.latency.merge(latency);
+    }
+    level.requests_per_second = static_cast<double>(level.latency.count()) / elapsed.count();
+    level.rows_per_second = level.requests_per_second * static_cast<double>(rows);
+    return level;
+}
+
+double microseconds(std::chrono::nanoseconds duration) {
+    return static_cast<double>(duration.count()) / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool use_unix = argc < 2 || std::string(argv[1]) != "tcp";
+    long delay_us = argc > 2 ? std::atol(argv[2]) : 100;
+    std::size_t rows = argc > 3 ? static_cast<std::size_t>(std::atol(argv[3])) : 4;
+    double seconds = argc > 4 ? std::atof(argv[4]) : 1.0;
+
+    classifier::Model<features> model;
+    std::mt19937_64 rng(7);
+    std::normal_distribution<float> weight(0.0f, 0.5f);
+    for (std::size_t i = 0; i < features; ++i) {
+        model.set_weight(i, weight(rng));
+    }
+
+    classifier::ScoringServerOptions options;
+    if (use_unix) {
+        options.unix_path =
+            (std::filesystem::temp_directory_path() / "classifier_scoring_load.sock").string();
+    }
+    options.max_queue_delay = std::chrono::microseconds(delay_us);
+
+    std::printf("%s, %zu features, %zu rows/request, queue delay %ld us\n",
+                use_unix ? "unix socket" : "loopback tcp", features, rows, delay_us);
+    std::printf("%8s %12s %12s %10s %10s %10s %12s\n", "clients", "requests/s", "rows/s",
+                "p50 us", "p99 us", "max us", "rows/batch");
+
+    for (std::size_t clients : {1, 2, 4, 8, 16, 32, 64}) {
+        // A fresh server per level so its batch counters cover that level.
+        classifier::ScoringServer<features> server(model, options);
+        if (server.start() != classifier::Error::none) {
+            std::fprintf(stderr, "cannot start the server\n");
+            return 1;
+        }
+        Level level = run_level(options, server.port(), clients, rows,
+                                std::chrono::duration<double>(seconds));
+        auto stats = server.stats();
+        double batches = static_cast<double>(std::max<std::uint64_t>(stats.batches, 1));
+        double rows_per_batch = static_cast<double>(stats.rows) / batches;
+        std::printf("%8zu %12.0f %12.0f %10.1f %10.1f %10.1f %12.1f\n", clients,
+                    level.requests_per_second, level.rows_per_second,
+                    microseconds(level.latency.percentile(0.5)),
+                    microseconds(level.latency.percentile(0.99)),
+                    microseconds(level.latency.max()), rows_per_batch);
+    }
+    return 0;
+}
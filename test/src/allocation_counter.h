@@ -0,0 +1,61 @@
+#pragma once
+
+// Test hook: replaces the global allocation functions with ones that count
+// calls per thread, so tests can assert that a hot path never touches the
+// heap. Include in exactly one translation unit of a test binary.
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace test_support {
+
+inline thread_local std::size_t heap_allocations = 0;
+
+// Heap allocations made by the current thread since construction.
+class AllocationCounter {
+public:
+    AllocationCounter() noexcept : start_(heap_allocations) {}
+    std::size_t count() const noexcept { return heap_allocations - start_; }
+
+private:
+    std::size_t start_;
+};
+
+inline void* counted_allocate(std::size_t size, std::size_t alignment) {
+    ++heap_allocations;
+    if (size == 0) {
+        size = 1;
+    }
+    void* p = alignment <= alignof(std::max_align_t)
+                  ? std::malloc(size)
+                  : std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+} // namespace test_support
+
+void* operator new(std::size_t size) {
+    return test_support::counted_allocate(size, alignof(std::max_align_t));
+}
+void* operator new[](std::size_t size) {
+    return test_support::counted_allocate(size, alignof(std::max_align_t));
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return test_support::counted_allocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return test_support::counted_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
@@ -1,12 +1,63 @@
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <span>
 #include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include <unistd.h>
+
+#include "classifier/arena.h"
+#include "classifier/columnar.h"
+#include "classifier/compact_model.h"
+#include "classifier/crc32c.h"
+#include "classifier/dynamic_model.h"
+#include "classifier/dynamic_trainer.h"
+#include "classifier/evaluation.h"
+#include "classifier/feature_hasher.h"
+#include "classifier/inference.h"
+#include "classifier/kernels.h"
+#include "classifier/kernels_fixed.h"
+#include "classifier/kernels_hash.h"
+#include "classifier/kernels_int8.h"
+#include "classifier/latency_histogram.h"
+#include "classifier/mapped_training_data.h"
+#include "classifier/metrics.h"
 #include "classifier/model.h"
+#include "classifier/model_bank.h"
+#include "classifier/model_file.h"
+#include "classifier/model_registry.h"
+#include "classifier/model_selection.h"
+#include "classifier/multiclass_model.h"
+#include "classifier/multiclass_trainer.h"
+#include "classifier/optimizer.h"
+#include "classifier/sigmoid.h"
+#include "classifier/sparse_model.h"
+#include "classifier/sparse_trainer.h"
+#include "classifier/quantized_model.h"
+#include "classifier/scoring_server.h"
+#include "classifier/streaming_trainer.h"
+#include "classifier/thread_pool.h"
 #include "classifier/trainer.h"
 
+#include "allocation_counter.h"
+
 void test_empty_features() {
     classifier::Model<0> model;
     auto result = model.classify({});
@@ -290,6 +341,2758 @@ void test_deserialize_training_data_round_trip_train() {
     std::cout << "  PASS: test_deserialize_training_data_round_trip_train\n";
 }
 
+template <std::size_t N>
+void check_score_batch_matches_classify(std::size_t rows) {
+    classifier::Model<N> model;
+    for (std::size_t i = 0; i < N; ++i) {
+        model.set_weight(i, 0.05f * static_cast<float>(i % 7) - 0.15f);
+    }
+    model.set_bias(0.1f);
+
+    std::vector<float> features(rows * N);
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        features[i] = static_cast<float>((i * 37) % 23) / 11.0f - 1.0f;
+    }
+
+    std::vector<classifier::Result> results(rows);
+    assert(model.classify_batch(features, results) == classifier::Error::none);
+
+    for (std::size_t r = 0; r < rows; ++r) {
+        std::array<float, N> row;
+        std::copy_n(features.begin() + r * N, N, row.begin());
+        auto expected = model.classify(row);
+        assert(results[r].prediction == expected.prediction);
+        assert(std::abs(results[r].confidence - expected.confidence) < 1e-5f);
+    }
+}
+
+void test_classify_batch_matches_classify() {
+    check_score_batch_matches_classify<3>(21);
+    check_score_batch_matches_classify<8>(16);
+    check_score_batch_matches_classify<37>(19);
+    std::cout << "  PASS: test_classify_batch_matches_classify\n";
+}
+
+void test_score_batch_isa_agreement() {
+    constexpr std::size_t n = 45;
+    constexpr std::size_t rows = 27;
+    std::vector<float> weights(n);
+    std::vector<float> features(rows * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        weights[i] = static_cast<float>(i % 5) * 0.3f - 0.6f;
+    }
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        features[i] = static_cast<float>((i * 13) % 17) / 4.0f - 2.0f;
+    }
+    features[3 * n + 7] = std::nanf("");
+
+    std::vector<float> expected(rows);
+    classifier::kernels::score_rows(weights.data(), n, -0.2f, features.data(), rows,
+                                    expected.data(), classifier::kernels::Isa::scalar);
+
+    for (auto isa : {classifier::kernels::Isa::avx2, classifier::kernels::Isa::avx512}) {
+        if (isa > classifier::kernels::active_isa()) {
+            continue;
+        }
+        std::vector<float> actual(rows);
+        classifier::kernels::score_rows(weights.data(), n, -0.2f, features.data(), rows,
+                                        actual.data(), isa);
+        for (std::size_t r = 0; r < rows; ++r) {
+            assert(std::isnan(actual[r]) == std::isnan(expected[r]));
+            assert(std::isnan(expected[r]) || std::abs(actual[r] - expected[r]) < 1e-5f);
+        }
+    }
+    assert(std::isnan(expected[3]));
+
+    // A NaN margin stays NaN on every ISA, as in math::sigmoid.
+    std::vector<float> values = {-100.0f, -10.0f, std::nanf(""), -1.0f, -0.1f, 0.0f,
+                                 0.1f,    1.0f,   10.0f,         100.0f, 2.0f,  std::nanf("")};
+    for (auto isa : {classifier::kernels::Isa::scalar, classifier::kernels::Isa::avx2,
+                     classifier::kernels::Isa::avx512}) {
+        if (isa > classifier::kernels::active_isa()) {
+            continue;
+        }
+        std::vector<float> approx = values;
+        classifier::kernels::sigmoid_inplace(approx.data(), approx.size(), isa);
+        std::vector<float> rational = values;
+        classifier::kernels::sigmoid_rational_inplace(rational.data(), rational.size(), isa);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (std::isnan(values[i])) {
+                assert(std::isnan(approx[i]) && std::isnan(rational[i]));
+                continue;
+            }
+            assert(std::abs(approx[i] - classifier::math::sigmoid(values[i])) < 1e-6f);
+            assert(std::abs(rational[i] - classifier::math::sigmoid_rational(values[i])) < 1e-6f);
+        }
+    }
+    std::cout << "  PASS: test_score_batch_isa_agreement\n";
+}
+
+void test_classify_batch_size_mismatch() {
+    classifier::Model<3> model;
+    std::vector<float> features(7);
+    std::vector<classifier::Result> results(2);
+    assert(model.classify_batch(features, results) == classifier::Error::size_mismatch);
+
+    std::vector<float> scores(3);
+    assert(model.score_batch(features, scores) == classifier::Error::size_mismatch);
+    std::cout << "  PASS: test_classify_batch_size_mismatch\n";
+}
+
+void test_classify_batch_empty_model() {
+    classifier::Model<0> model;
+    std::vector<classifier::Result> results(4);
+    assert(model.classify_batch({}, results) == classifier::Error::none);
+    for (auto const& result : results) {
+        assert(result.prediction == classifier::Prediction::unknown);
+    }
+    std::cout << "  PASS: test_classify_batch_empty_model\n";
+}
+
+classifier::Trainer<2>::TrainingSet make_clusters(std::size_t rows) {
+    classifier::Trainer<2>::TrainingSet data(rows);
+    for (std::size_t r = 0; r < rows; ++r) {
+        float jitter = static_cast<float>((r * 7919) % 100) / 250.0f - 0.2f;
+        if (r % 2 == 0) {
+            data[r] = {1.0f + jitter, 0.8f - jitter, 1.0f};
+        } else {
+            data[r] = {-1.0f - jitter, -0.9f + jitter, 0.0f};
+        }
+    }
+    return data;
+}
+
+void test_sgd_converges() {
+    auto data = make_clusters(1000);
+
+    classifier::SgdOptions options;
+    options.learning_rate = 0.5f;
+    options.epochs = 5;
+    options.batch_size = 32;
+    options.threads = 3;
+
+    classifier::Model<2> model;
+    classifier::Trainer<2> t(model);
+    assert(t.train_sgd(data, options) == classifier::Error::none);
+
+    assert(model.classify({1.0f, 0.8f}).prediction == classifier::Prediction::positive);
+    assert(model.classify({-1.0f, -0.9f}).prediction == classifier::Prediction::negative);
+    std::cout << "  PASS: test_sgd_converges\n";
+}
+
+void test_sgd_deterministic_for_seed_and_threads() {
+    auto data = make_clusters(500);
+
+    classifier::SgdOptions options;
+    options.epochs = 3;
+    options.batch_size = 64;
+    options.threads = 4;
+    options.seed = 42;
+    options.regularization = classifier::Regularization::l2;
+    options.regularization_strength = 0.01f;
+
+    classifier::Model<2> model_a;
+    classifier::Trainer<2> trainer_a(model_a);
+    assert(trainer_a.train_sgd(data, options) == classifier::Error::none);
+
+    classifier::Model<2> model_b;
+    classifier::Trainer<2> trainer_b(model_b);
+    assert(trainer_b.train_sgd(data, options) == classifier::Error::none);
+
+    assert(model_a.weight(0) == model_b.weight(0));
+    assert(model_a.weight(1) == model_b.weight(1));
+    assert(model_a.bias() == model_b.bias());
+    std::cout << "  PASS: test_sgd_deterministic_for_seed_and_threads\n";
+}
+
+void test_sgd_full_batch_matches_train() {
+    // One unshuffled batch covering the whole set on one thread is exactly
+    // full-batch gradient descent.
+    auto data = make_clusters(40);
+
+    classifier::Model<2> model_a;
+    classifier::Trainer<2> trainer_a(model_a);
+    assert(trainer_a.train(data, 0.3f, 20) == classifier::Error::none);
+
+    classifier::SgdOptions options;
+    options.learning_rate = 0.3f;
+    options.epochs = 20;
+    options.batch_size = data.size();
+    options.shuffle = false;
+
+    classifier::Model<2> model_b;
+    classifier::Trainer<2> trainer_b(model_b);
+    assert(trainer_b.train_sgd(data, options) == classifier::Error::none);
+
+    assert(model_a.weight(0) == model_b.weight(0));
+    assert(model_a.weight(1) == model_b.weight(1));
+    assert(model_a.bias() == model_b.bias());
+    std::cout << "  PASS: test_sgd_full_batch_matches_train\n";
+}
+
+void test_sgd_invalid_options() {
+    classifier::Trainer<2>::TrainingSet data = {{1.0f, 0.0f, 1.0f}};
+    classifier::Model<2> model;
+    classifier::Trainer<2> t(model);
+
+    classifier::SgdOptions options;
+    options.batch_size = 0;
+    assert(t.train_sgd(data, options) == classifier::Error::invalid_batch_size);
+
+    assert(t.train_sgd({}, classifier::SgdOptions{}) == classifier::Error::empty_training_set);
+    std::cout << "  PASS: test_sgd_invalid_options\n";
+}
+
+void test_hogwild_converges() {
+    auto data = make_clusters(2000);
+
+    classifier::HogwildOptions options;
+    options.learning_rate = 0.2f;
+    options.schedule = classifier::LearningRateSchedule::inverse_time;
+    options.decay = 0.5f;
+    options.epochs = 4;
+    options.threads = 4;
+
+    classifier::Model<2> model;
+    classifier::Trainer<2> t(model);
+    assert(t.train_hogwild(data, options) == classifier::Error::none);
+
+    assert(model.classify({1.0f, 0.8f}).prediction == classifier::Prediction::positive);
+    assert(model.classify({-1.0f, -0.9f}).prediction == classifier::Prediction::negative);
+
+    // Featureless rows train only the per-thread batched bias: three in four
+    // positive gives a bias near logit(0.75).
+    classifier::Trainer<2>::TrainingSet bias_only(4000);
+    for (std::size_t i = 0; i < bias_only.size(); ++i) {
+        bias_only[i] = {0.0f, 0.0f, i % 4 == 0 ? 0.0f : 1.0f};
+    }
+    options.learning_rate = 0.001f;
+    options.schedule = classifier::LearningRateSchedule::constant;
+    options.epochs = 20;
+    classifier::Model<2> bias_model;
+    assert(classifier::Trainer<2>(bias_model).train_hogwild(bias_only, options) ==
+           classifier::Error::none);
+    assert(std::fabs(bias_model.bias() - std::log(3.0f)) < 0.05f);
+    std::cout << "  PASS: test_hogwild_converges\n";
+}
+
+void test_hogwild_single_thread_deterministic() {
+    auto data = make_clusters(300);
+
+    classifier::HogwildOptions options;
+    options.epochs = 3;
+    options.threads = 1;
+    options.seed = 7;
+    options.regularization = classifier::Regularization::l1;
+    options.regularization_strength = 0.001f;
+
+    classifier::Model<2> a;
+    classifier::Model<2> b;
+    assert(classifier::Trainer<2>(a).train_hogwild(data, options) == classifier::Error::none);
+    assert(classifier::Trainer<2>(b).train_hogwild(data, options) == classifier::Error::none);
+    assert(a.weight(0) == b.weight(0));
+    assert(a.weight(1) == b.weight(1));
+    assert(a.bias() == b.bias());
+    std::cout << "  PASS: test_hogwild_single_thread_deterministic\n";
+}
+
+void test_hogwild_schedule_and_errors() {
+    classifier::HogwildOptions options;
+    options.learning_rate = 0.4f;
+    assert(classifier::scheduled_learning_rate(options, 5) == 0.4f);
+
+    options.schedule = classifier::LearningRateSchedule::inverse_time;
+    options.decay = 1.0f;
+    assert(std::fabs(classifier::scheduled_learning_rate(options, 3) - 0.1f) < 1e-7f);
+
+    options.schedule = classifier::LearningRateSchedule::exponential;
+    options.decay = 0.5f;
+    assert(std::fabs(classifier::scheduled_learning_rate(options, 2) - 0.1f) < 1e-7f);
+
+    classifier::Model<2> model;
+    classifier::Trainer<2> t(model);
+    assert(t.train_hogwild({}, options) == classifier::Error::empty_training_set);
+    classifier::Trainer<2>::TrainingSet data = {{1.0f, 0.0f, 1.0f}};
+    for (float decay : {0.0f, -0.5f, 1.5f, std::nanf("")}) {
+        options.decay = decay;
+        assert(t.train_hogwild(data, options) == classifier::Error::invalid_decay);
+    }
+    options.schedule = classifier::LearningRateSchedule::inverse_time;
+    options.decay = -0.1f;
+    assert(t.train_hogwild(data, options) == classifier::Error::invalid_decay);
+    options.decay = 0.0f;
+    assert(t.train_hogwild(data, options) == classifier::Error::none);
+    options.regularization_strength = -1.0f;
+    assert(t.train_hogwild(data, options) == classifier::Error::invalid_regularization_strength);
+    std::cout << "  PASS: test_hogwild_schedule_and_errors\n";
+}
+
+template <std::size_t N>
+void check_dynamic_matches_static() {
+    classifier::Model<N> model;
+    for (std::size_t i = 0; i < N; ++i) {
+        model.set_weight(i, 0.25f * static_cast<float>(i) - 0.5f);
+    }
+    model.set_bias(0.125f);
+
+    auto dynamic = classifier::DynamicModel::from(model);
+    assert(dynamic.weight_count() == N);
+    assert(reinterpret_cast<std::uintptr_t>(dynamic.weights().data()) % 64 == 0);
+
+    std::array<float, N> features;
+    for (std::size_t i = 0; i < N; ++i) {
+        features[i] = 0.1f * static_cast<float>(i) - 0.2f;
+    }
+    classifier::Result result;
+    assert(dynamic.classify(features, result) == classifier::Error::none);
+    auto expected = model.classify(features);
+    assert(result.prediction == expected.prediction);
+    assert(result.confidence == expected.confidence);
+}
+
+void test_dynamic_model_matches_model() {
+    check_dynamic_matches_static<3>();   // compiled-in dimension
+    check_dynamic_matches_static<5>();   // runtime loop
+    check_dynamic_matches_static<128>();
+    std::cout << "  PASS: test_dynamic_model_matches_model\n";
+}
+
+void test_dynamic_model_serialize_interop() {
+    classifier::Model<5> model;
+    model.set_weight(0, 1.5f);
+    model.set_weight(4, -0.75f);
+    model.set_bias(0.5f);
+
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    assert(model.serialize(ss) == classifier::Error::none);
+
+    classifier::DynamicModel dynamic;
+    assert(dynamic.deserialize(ss) == classifier::Error::none);
+    assert(dynamic.weight_count() == 5);
+    assert(dynamic.weight(0) == 1.5f);
+    assert(dynamic.weight(4) == -0.75f);
+    assert(dynamic.bias() == 0.5f);
+
+    std::stringstream back(std::ios::binary | std::ios::in | std::ios::out);
+    assert(dynamic.serialize(back) == classifier::Error::none);
+    classifier::Model<5> reloaded;
+    assert(reloaded.deserialize(back) == classifier::Error::none);
+    assert(reloaded.weight(4) == -0.75f);
+
+    classifier::Model<4> wrong;
+    assert(dynamic.to(wrong) == classifier::Error::dimension_mismatch);
+
+    classifier::Result result;
+    std::array<float, 4> short_features{};
+    assert(dynamic.classify(short_features, result) == classifier::Error::size_mismatch);
+    std::cout << "  PASS: test_dynamic_model_serialize_interop\n";
+}
+
+template <std::size_t N>
+void check_dynamic_trainer_matches_trainer() {
+    typename classifier::Trainer<N>::TrainingSet data(16);
+    classifier::DynamicTrainingSet dynamic_data{N + 1, {}};
+    for (std::size_t r = 0; r < data.size(); ++r) {
+        for (std::size_t i = 0; i < N; ++i) {
+            data[r][i] = static_cast<float>((r * 31 + i * 17) % 11) / 5.0f - 1.0f;
+        }
+        data[r][N] = r % 2 == 0 ? 1.0f : 0.0f;
+        dynamic_data.values.insert(dynamic_data.values.end(), data[r].begin(), data[r].end());
+    }
+
+    classifier::Model<N> model;
+    classifier::Trainer<N> trainer(model);
+    assert(trainer.train(data, 0.2f, 30, classifier::Regularization::l1, 0.01f)
+           == classifier::Error::none);
+
+    classifier::DynamicModel dynamic(N);
+    classifier::DynamicTrainer dynamic_trainer(dynamic);
+    assert(dynamic_trainer.train(dynamic_data, 0.2f, 30, classifier::Regularization::l1, 0.01f)
+           == classifier::Error::none);
+
+    for (std::size_t i = 0; i < N; ++i) {
+        assert(dynamic.weight(i) == model.weight(i));
+    }
+    assert(dynamic.bias() == model.bias());
+}
+
+void test_dynamic_trainer_matches_trainer() {
+    check_dynamic_trainer_matches_trainer<2>();
+    check_dynamic_trainer_matches_trainer<7>();
+    std::cout << "  PASS: test_dynamic_trainer_matches_trainer\n";
+}
+
+void test_dynamic_trainer_training_data() {
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    std::size_t cols = 3;
+    std::size_t rows = 4;
+    ss.write(reinterpret_cast<char const*>(&cols), sizeof(cols));
+    ss.write(reinterpret_cast<char const*>(&rows), sizeof(rows));
+    float raw[4][3] = {
+        {1.0f, 0.5f, 1.0f},
+        {0.5f, 1.0f, 1.0f},
+        {-1.0f, -0.5f, 0.0f},
+        {-0.5f, -1.0f, 0.0f},
+    };
+    ss.write(reinterpret_cast<char const*>(raw), sizeof(raw));
+
+    classifier::DynamicTrainingSet data;
+    assert(classifier::DynamicTrainer::deserialize_training_data(ss, data)
+           == classifier::Error::none);
+    assert(data.rows() == 4);
+    assert(data.row(2)[0] == -1.0f);
+
+    classifier::DynamicModel wrong(3);
+    classifier::DynamicTrainer wrong_trainer(wrong);
+    assert(wrong_trainer.train(data) == classifier::Error::dimension_mismatch);
+
+    classifier::DynamicModel model(2);
+    classifier::DynamicTrainer t(model);
+    assert(t.train(data, 0.5f, 300) == classifier::Error::none);
+
+    classifier::Result result;
+    std::array<float, 2> positive = {1.0f, 0.5f};
+    assert(model.classify(positive, result) == classifier::Error::none);
+    assert(result.prediction == classifier::Prediction::positive);
+    std::cout << "  PASS: test_dynamic_trainer_training_data\n";
+}
+
+void test_deserialize_oversized_header() {
+    auto header = [](std::initializer_list<std::size_t> sizes) {
+        auto ss = std::make_unique<std::stringstream>(
+            std::ios::binary | std::ios::in | std::ios::out);
+        for (std::size_t size : sizes) {
+            ss->write(reinterpret_cast<char const*>(&size), sizeof(size));
+        }
+        float const padding[4] = {};
+        ss->write(reinterpret_cast<char const*>(padding), sizeof(padding));
+        return ss;
+    };
+    std::size_t const huge = std::numeric_limits<std::size_t>::max() / 2;
+
+    classifier::DynamicModel model(2);
+    assert(model.deserialize(*header({huge})) == classifier::Error::io_failed);
+    assert(model.deserialize(*header({5})) == classifier::Error::io_failed);
+    assert(model.deserialize(*header({3})) == classifier::Error::none);
+
+    classifier::DynamicTrainingSet data;
+    assert(classifier::DynamicTrainer::deserialize_training_data(*header({3, huge}), data)
+           == classifier::Error::io_failed);
+    assert(classifier::DynamicTrainer::deserialize_training_data(*header({huge, huge}), data)
+           == classifier::Error::io_failed);
+    assert(classifier::DynamicTrainer::deserialize_training_data(*header({2, 2}), data)
+           == classifier::Error::none);
+
+    classifier::Trainer<2>::TrainingSet fixed;
+    assert(classifier::Trainer<2>::deserialize_training_data(*header({3, huge}), fixed)
+           == classifier::Error::io_failed);
+    std::cout << "  PASS: test_deserialize_oversized_header\n";
+}
+
+// A path in the temp directory unique to this process, so concurrent test
+// runs do not clobber each other's files.
+std::filesystem::path temp_path(std::string const& name) {
+    return std::filesystem::temp_directory_path() /
+           (name + "." + std::to_string(::getpid()));
+}
+
+std::filesystem::path write_training_file(char const* name, std::size_t cols, std::size_t rows,
+                                          std::vector<float> const& values) {
+    auto path = temp_path(name);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<char const*>(&cols), sizeof(cols));
+    out.write(reinterpret_cast<char const*>(&rows), sizeof(rows));
+    out.write(reinterpret_cast<char const*>(values.data()),
+              static_cast<std::streamsize>(sizeof(float) * values.size()));
+    return path;
+}
+
+void test_mapped_training_data() {
+    auto data = make_clusters(64);
+    std::vector<float> values;
+    for (auto const& sample : data) {
+        values.insert(values.end(), sample.begin(), sample.end());
+    }
+    auto path = write_training_file("classifier_test_mapped.bin", 3, data.size(), values);
+
+    classifier::MappedTrainingData<2> mapped;
+    assert(mapped.open(path.c_str()) == classifier::Error::none);
+    auto samples = mapped.samples();
+    assert(samples.size() == data.size());
+    for (std::size_t r = 0; r < data.size(); ++r) {
+        assert(samples[r] == data[r]);
+    }
+    assert(mapped.advise(classifier::AccessPattern::random) == classifier::Error::none);
+
+    classifier::Model<2> from_vector;
+    classifier::Trainer<2> vector_trainer(from_vector);
+    assert(vector_trainer.train(data, 0.5f, 20) == classifier::Error::none);
+
+    classifier::Model<2> from_mapping;
+    classifier::Trainer<2> mapped_trainer(from_mapping);
+    assert(mapped_trainer.train(mapped.samples(), 0.5f, 20) == classifier::Error::none);
+
+    assert(from_vector.weight(0) == from_mapping.weight(0));
+    assert(from_vector.weight(1) == from_mapping.weight(1));
+    assert(from_vector.bias() == from_mapping.bias());
+
+    mapped.close();
+    std::filesystem::remove(path);
+    std::cout << "  PASS: test_mapped_training_data\n";
+}
+
+void test_mapped_training_data_validation() {
+    std::vector<float> values = {1.0f, 0.5f, 1.0f, -1.0f, -0.5f};
+    auto truncated = write_training_file("classifier_test_truncated.bin", 3, 2, values);
+    classifier::MappedTrainingData<2> mapped;
+    assert(mapped.open(truncated.c_str()) == classifier::Error::io_failed);
+    assert(!mapped.is_open());
+    std::filesystem::remove(truncated);
+
+    auto wrong_cols = write_training_file("classifier_test_cols.bin", 4, 1, {0.0f, 0.0f, 0.0f, 1.0f});
+    assert(mapped.open(wrong_cols.c_str()) == classifier::Error::dimension_mismatch);
+    std::filesystem::remove(wrong_cols);
+
+    assert(mapped.open("/nonexistent/classifier.bin") == classifier::Error::io_failed);
+    std::cout << "  PASS: test_mapped_training_data_validation\n";
+}
+
+std::stringstream serialize_training_set(classifier::Trainer<2>::TrainingSet const& data) {
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    std::size_t cols = 3;
+    std::size_t rows = data.size();
+    ss.write(reinterpret_cast<char const*>(&cols), sizeof(cols));
+    ss.write(reinterpret_cast<char const*>(&rows), sizeof(rows));
+    for (auto const& sample : data) {
+        ss.write(reinterpret_cast<char const*>(sample.data()), sizeof(float) * 3);
+    }
+    return ss;
+}
+
+void test_streaming_matches_in_memory_sgd() {
+    // With chunk boundaries on batch boundaries, streaming passes perform the
+    // same updates as in-memory unshuffled SGD epochs.
+    auto data = make_clusters(300);
+    auto ss = serialize_training_set(data);
+
+    classifier::StreamingOptions options;
+    options.learning_rate = 0.3f;
+    options.passes = 3;
+    options.chunk_rows = 64;
+    options.batch_size = 16;
+
+    classifier::Model<2> streamed;
+    classifier::StreamingTrainer<2> streaming(streamed);
+    assert(streaming.train(ss, options) == classifier::Error::none);
+
+    classifier::SgdOptions sgd;
+    sgd.learning_rate = 0.3f;
+    sgd.epochs = 3;
+    sgd.batch_size = 16;
+    sgd.shuffle = false;
+
+    classifier::Model<2> in_memory;
+    classifier::Trainer<2> trainer(in_memory);
+    assert(trainer.train_sgd(data, sgd) == classifier::Error::none);
+
+    assert(streamed.weight(0) == in_memory.weight(0));
+    assert(streamed.weight(1) == in_memory.weight(1));
+    assert(streamed.bias() == in_memory.bias());
+    assert(streamed.classify({1.0f, 0.8f}).prediction == classifier::Prediction::positive);
+    std::cout << "  PASS: test_streaming_matches_in_memory_sgd\n";
+}
+
+void test_streaming_errors() {
+    auto data = make_clusters(10);
+    auto full = serialize_training_set(data);
+    std::string bytes = full.str();
+
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 5),
+                                std::ios::binary | std::ios::in);
+    classifier::Model<2> model;
+    classifier::StreamingTrainer<2> streaming(model);
+    classifier::StreamingOptions options;
+    options.chunk_rows = 4;
+    assert(streaming.train(truncated, options) == classifier::Error::io_failed);
+
+    classifier::Model<3> wrong;
+    classifier::StreamingTrainer<3> wrong_streaming(wrong);
+    std::stringstream again(bytes, std::ios::binary | std::ios::in);
+    assert(wrong_streaming.train(again, options) == classifier::Error::dimension_mismatch);
+
+    options.chunk_rows = 0;
+    std::stringstream zero_chunk(bytes, std::ios::binary | std::ios::in);
+    assert(streaming.train(zero_chunk, options) == classifier::Error::invalid_batch_size);
+    std::cout << "  PASS: test_streaming_errors\n";
+}
+
+void test_columnar_conversion() {
+    auto data = make_clusters(21);
+    auto columnar = classifier::ColumnarTrainingSet<2>::from(data);
+    assert(columnar.rows() == 21);
+    for (std::size_t r = 0; r < data.size(); ++r) {
+        assert(columnar.feature(0)[r] == data[r][0]);
+        assert(columnar.feature(1)[r] == data[r][1]);
+        assert(columnar.labels()[r] == data[r][2]);
+    }
+    assert(reinterpret_cast<std::uintptr_t>(columnar.feature(1).data()) % 64 == 0);
+    assert(reinterpret_cast<std::uintptr_t>(columnar.labels().data()) % 64 == 0);
+    std::cout << "  PASS: test_columnar_conversion\n";
+}
+
+void test_columnar_train_matches_row_train() {
+    // Same full-batch updates as the row-major trainer, up to float summation
+    // order and the vectorized sigmoid.
+    classifier::Trainer<7>::TrainingSet data(600);
+    for (std::size_t r = 0; r < data.size(); ++r) {
+        for (std::size_t i = 0; i < 7; ++i) {
+            data[r][i] = static_cast<float>((r * 31 + i * 17) % 11) / 5.0f - 1.0f;
+        }
+        data[r][7] = data[r][0] + data[r][3] > 0.0f ? 1.0f : 0.0f;
+    }
+
+    classifier::Model<7> rows;
+    classifier::Trainer<7> row_trainer(rows);
+    assert(row_trainer.train(data, 0.5f, 50, classifier::Regularization::l2, 0.01f)
+           == classifier::Error::none);
+
+    classifier::Model<7> columns;
+    classifier::Trainer<7> column_trainer(columns);
+    auto columnar = classifier::ColumnarTrainingSet<7>::from(data);
+    assert(column_trainer.train(columnar, 0.5f, 50, classifier::Regularization::l2, 0.01f)
+           == classifier::Error::none);
+
+    for (std::size_t i = 0; i < 7; ++i) {
+        assert(std::abs(rows.weight(i) - columns.weight(i)) < 1e-4f);
+    }
+    assert(std::abs(rows.bias() - columns.bias()) < 1e-4f);
+
+    classifier::ColumnarTrainingSet<7> empty;
+    assert(column_trainer.train(empty) == classifier::Error::empty_training_set);
+    std::cout << "  PASS: test_columnar_train_matches_row_train\n";
+}
+
+void test_int8_dot_isa_agreement() {
+    constexpr std::size_t n = 203;
+    std::vector<std::uint8_t> x(n);
+    std::vector<std::int8_t> w(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = static_cast<std::uint8_t>(i % 3 == 0 ? 255 : (i * 37) % 256);
+        w[i] = static_cast<std::int8_t>(i % 5 == 0 ? -128 : static_cast<int>((i * 91) % 256) - 128);
+    }
+
+    auto expected = classifier::kernels::dot_u8s8(x.data(), w.data(), n,
+                                                  classifier::kernels::Int8Isa::scalar);
+    for (auto isa : {classifier::kernels::Int8Isa::avx2, classifier::kernels::Int8Isa::avx_vnni,
+                     classifier::kernels::Int8Isa::avx512_vnni}) {
+        if (isa > classifier::kernels::active_int8_isa()) {
+            continue;
+        }
+        for (std::size_t len : {n, std::size_t(32), std::size_t(7), std::size_t(0)}) {
+            auto scalar = classifier::kernels::dot_u8s8(x.data(), w.data(), len,
+                                                        classifier::kernels::Int8Isa::scalar);
+            auto simd = classifier::kernels::dot_u8s8(x.data(), w.data(), len, isa);
+            assert(simd.dot == scalar.dot);
+            assert(simd.activation_sum == scalar.activation_sum);
+        }
+    }
+    assert(expected.activation_sum > 0);
+    std::cout << "  PASS: test_int8_dot_isa_agreement\n";
+}
+
+void test_quantized_model_accuracy_drift() {
+    // The int8 model must stay within a small probability drift of the float
+    // model it was built from and agree on nearly every prediction.
+    constexpr std::size_t n = 24;
+    classifier::Trainer<n>::TrainingSet data(2000);
+    for (std::size_t r = 0; r < data.size(); ++r) {
+        float z = 0.0f;
+        for (std::size_t i = 0; i < n; ++i) {
+            data[r][i] = static_cast<float>((r * 131 + i * 71) % 97) / 24.0f - 2.0f;
+            z += (i % 3 == 0 ? 1.0f : -0.5f) * data[r][i];
+        }
+        data[r][n] = z > 0.0f ? 1.0f : 0.0f;
+    }
+
+    classifier::Model<n> model;
+    classifier::Trainer<n> trainer(model);
+    assert(trainer.train(data, 0.5f, 100) == classifier::Error::none);
+
+    classifier::QuantizedModel<n> quantized;
+    assert(classifier::QuantizedModel<n>::quantize(
+               model, std::span(data).first(256), quantized) == classifier::Error::none);
+
+    float max_drift = 0.0f;
+    std::size_t agree = 0;
+    for (auto const& sample : data) {
+        std::array<float, n> features;
+        std::copy_n(sample.begin(), n, features.begin());
+        auto expected = model.classify(features);
+        auto actual = quantized.classify(features);
+        float p_expected = expected.prediction == classifier::Prediction::positive
+                               ? expected.confidence
+                               : 1.0f - expected.confidence;
+        float p_actual = actual.prediction == classifier::Prediction::positive
+                             ? actual.confidence
+                             : 1.0f - actual.confidence;
+        max_drift = std::max(max_drift, std::abs(p_expected - p_actual));
+        agree += expected.prediction == actual.prediction ? 1 : 0;
+    }
+    assert(max_drift < 0.03f);
+    assert(agree >= data.size() * 99 / 100);
+
+    classifier::QuantizedModel<n> empty;
+    assert(classifier::QuantizedModel<n>::quantize(model, {}, empty)
+           == classifier::Error::empty_training_set);
+    std::cout << "  PASS: test_quantized_model_accuracy_drift\n";
+}
+
+void test_quantized_model_serialize() {
+    classifier::Model<4> model;
+    model.set_weight(0, 0.9f);
+    model.set_weight(1, -0.4f);
+    model.set_weight(2, 0.1f);
+    model.set_weight(3, -1.2f);
+    model.set_bias(0.3f);
+    classifier::Trainer<4>::TrainingSet calibration = {
+        {-1.0f, 2.0f, 0.5f, 0.0f, 1.0f},
+        {1.5f, -0.5f, 0.0f, 1.0f, 0.0f},
+    };
+
+    classifier::QuantizedModel<4> quantized;
+    assert(classifier::QuantizedModel<4>::quantize(model, calibration, quantized)
+           == classifier::Error::none);
+
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    assert(quantized.serialize(ss) == classifier::Error::none);
+    classifier::QuantizedModel<4> loaded;
+    assert(loaded.deserialize(ss) == classifier::Error::none);
+    for (std::size_t i = 0; i < 4; ++i) {
+        assert(loaded.quantized_weight(i) == quantized.quantized_weight(i));
+    }
+    assert(loaded.weight_params().scale == quantized.weight_params().scale);
+    assert(loaded.feature_params().zero_point == quantized.feature_params().zero_point);
+
+    std::array<float, 4> features = {0.5f, 1.0f, -0.5f, 0.25f};
+    assert(loaded.classify(features).confidence == quantized.classify(features).confidence);
+
+    std::vector<std::uint8_t> rows(8);
+    quantized.quantize_features(features, std::span<std::uint8_t, 4>(rows.data(), 4));
+    quantized.quantize_features(features, std::span<std::uint8_t, 4>(rows.data() + 4, 4));
+    std::vector<classifier::Result> results(2);
+    assert(quantized.classify_batch(rows, results) == classifier::Error::none);
+    assert(results[1].confidence == quantized.classify(features).confidence);
+
+    // Out-of-range and non-finite features saturate; NaN reads as 0.
+    std::array<float, 4> extreme = {1e30f, -std::numeric_limits<float>::infinity(),
+                                    std::numeric_limits<float>::infinity(), std::nanf("")};
+    std::array<std::uint8_t, 4> saturated;
+    quantized.quantize_features(extreme, saturated);
+    auto zero = static_cast<std::uint8_t>(quantized.feature_params().zero_point);
+    assert(saturated[0] == 255 && saturated[1] == 0 && saturated[2] == 255 &&
+           saturated[3] == zero);
+
+    std::stringstream float_model(std::ios::binary | std::ios::in | std::ios::out);
+    assert(model.serialize(float_model) == classifier::Error::none);
+    assert(loaded.deserialize(float_model) == classifier::Error::invalid_format);
+    std::cout << "  PASS: test_quantized_model_serialize\n";
+}
+
+template <classifier::SigmoidPolicy S>
+void check_sigmoid_error_bound() {
+    std::vector<float> inputs;
+    for (double x = -40.0; x <= 40.0; x += 1.0 / 1024.0) {
+        inputs.push_back(static_cast<float>(x));
+    }
+    inputs.push_back(-1e30f);
+    inputs.push_back(1e30f);
+
+    std::vector<float> batch = inputs;
+    S::apply_inplace(batch.data(), batch.size());
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        double exact = 1.0 / (1.0 + std::exp(-static_cast<double>(inputs[i])));
+        assert(std::abs(S::apply(inputs[i]) - exact) <= S::max_error);
+        assert(std::abs(batch[i] - exact) <= S::max_error);
+    }
+    assert(std::isnan(S::apply(std::numeric_limits<float>::quiet_NaN())));
+}
+
+void test_sigmoid_policy_error_bounds() {
+    check_sigmoid_error_bound<classifier::ExactSigmoid>();
+    check_sigmoid_error_bound<classifier::RationalSigmoid>();
+    check_sigmoid_error_bound<classifier::TableSigmoid>();
+
+    std::array<float, 3> nans = {std::nanf(""), 0.0f, std::nanf("")};
+    classifier::TableSigmoid::apply_inplace(nans.data(), nans.size());
+    assert(std::isnan(nans[0]) && nans[1] == 0.5f && std::isnan(nans[2]));
+    std::cout << "  PASS: test_sigmoid_policy_error_bounds\n";
+}
+
+void test_model_with_approximate_sigmoid() {
+    auto data = make_clusters(200);
+
+    classifier::Model<2, classifier::RationalSigmoid> model;
+    classifier::Trainer<2, classifier::RationalSigmoid> t(model);
+    assert(t.train(data, 0.5f, 100) == classifier::Error::none);
+    assert(model.classify({1.0f, 0.8f}).prediction == classifier::Prediction::positive);
+    assert(model.classify({-1.0f, -0.9f}).prediction == classifier::Prediction::negative);
+
+    classifier::Model<2> exact;
+    exact.set_weight(0, model.weight(0));
+    exact.set_weight(1, model.weight(1));
+    exact.set_bias(model.bias());
+
+    classifier::Model<2, classifier::TableSigmoid> table;
+    table.set_weight(0, model.weight(0));
+    table.set_weight(1, model.weight(1));
+    table.set_bias(model.bias());
+
+    std::vector<float> features;
+    for (auto const& sample : data) {
+        features.push_back(sample[0]);
+        features.push_back(sample[1]);
+    }
+    std::vector<float> exact_scores(data.size());
+    std::vector<float> rational_scores(data.size());
+    std::vector<float> table_scores(data.size());
+    assert(exact.score_batch(features, exact_scores) == classifier::Error::none);
+    assert(model.score_batch(features, rational_scores) == classifier::Error::none);
+    assert(table.score_batch(features, table_scores) == classifier::Error::none);
+    for (std::size_t r = 0; r < data.size(); ++r) {
+        assert(std::abs(rational_scores[r] - exact_scores[r]) < 1e-4f);
+        assert(std::abs(table_scores[r] - exact_scores[r]) < 1e-4f);
+    }
+    std::cout << "  PASS: test_model_with_approximate_sigmoid\n";
+}
+
+// One-hot rows over `dimension` features: even indices lean positive, odd
+// indices negative, plus an always-on feature 0.
+classifier::CsrTrainingSet make_sparse_clusters(std::size_t rows, std::uint32_t dimension) {
+    classifier::CsrTrainingSet data;
+    data.dimension = dimension;
+    for (std::size_t r = 0; r < rows; ++r) {
+        auto hot = static_cast<std::uint32_t>(1 + (r * 7919) % (dimension - 1));
+        classifier::SparseFeature row[2] = {{0, 1.0f}, {hot, 1.0f}};
+        data.add_row(row, hot % 2 == 0 ? 1.0f : 0.0f);
+    }
+    return data;
+}
+
+void test_sparse_model_matches_dynamic() {
+    classifier::SparseModel sparse(6);
+    classifier::DynamicModel dense(6);
+    for (std::size_t i = 0; i < 6; ++i) {
+        sparse.set_weight(i, 0.3f * static_cast<float>(i) - 0.7f);
+        dense.set_weight(i, sparse.weight(i));
+    }
+    sparse.set_bias(0.2f);
+    dense.set_bias(0.2f);
+
+    classifier::SparseFeature features[] = {{1, 0.5f}, {4, -2.0f}, {5, 1.5f}};
+    std::array<float, 6> row = {0.0f, 0.5f, 0.0f, 0.0f, -2.0f, 1.5f};
+    classifier::Result expected;
+    classifier::Result result;
+    assert(dense.classify(row, expected) == classifier::Error::none);
+    assert(sparse.classify(features, result) == classifier::Error::none);
+    assert(result.prediction == expected.prediction);
+    assert(std::fabs(result.confidence - expected.confidence) < 1e-6f);
+
+    classifier::SparseFeature out_of_range[] = {{6, 1.0f}};
+    assert(sparse.classify(out_of_range, result) == classifier::Error::dimension_mismatch);
+
+    std::stringstream ss;
+    assert(sparse.serialize(ss) == classifier::Error::none);
+    classifier::DynamicModel loaded;
+    assert(loaded.deserialize(ss) == classifier::Error::none);
+    assert(loaded.weight_count() == 6 && loaded.weight(5) == sparse.weight(5));
+    std::cout << "  PASS: test_sparse_model_matches_dynamic\n";
+}
+
+void test_csr_training_data_round_trip() {
+    auto data = make_sparse_clusters(50, 1000);
+
+    std::stringstream ss;
+    assert(classifier::SparseTrainer::serialize_training_data(ss, data) == classifier::Error::none);
+    classifier::CsrTrainingSet loaded;
+    assert(classifier::SparseTrainer::deserialize_training_data(ss, loaded) ==
+           classifier::Error::none);
+    assert(loaded.dimension == 1000 && loaded.rows() == 50);
+    assert(loaded.offsets == data.offsets && loaded.labels == data.labels);
+    for (std::size_t i = 0; i < data.features.size(); ++i) {
+        assert(loaded.features[i].index == data.features[i].index);
+        assert(loaded.features[i].value == data.features[i].value);
+    }
+
+    std::string bytes = ss.str();
+    bytes[0] ^= 1;
+    std::stringstream bad_magic(bytes);
+    assert(classifier::SparseTrainer::deserialize_training_data(bad_magic, loaded) ==
+           classifier::Error::invalid_format);
+
+    data.features[3].index = 1000;
+    std::stringstream out_of_range;
+    classifier::SparseTrainer::serialize_training_data(out_of_range, data);
+    assert(classifier::SparseTrainer::deserialize_training_data(out_of_range, loaded) ==
+           classifier::Error::invalid_format);
+
+    std::stringstream truncated(ss.str().substr(0, 40));
+    assert(classifier::SparseTrainer::deserialize_training_data(truncated, loaded) ==
+           classifier::Error::io_failed);
+
+    for (std::size_t field : {1, 2}) {
+        std::string hostile = ss.str();
+        std::size_t const huge = std::numeric_limits<std::size_t>::max() / 2;
+        std::memcpy(hostile.data() + 8 + field * sizeof(std::size_t), &huge, sizeof(huge));
+        std::stringstream oversized(hostile);
+        assert(classifier::SparseTrainer::deserialize_training_data(oversized, loaded) ==
+               classifier::Error::io_failed);
+    }
+
+    classifier::SparseModel model;
+    std::size_t const huge_weights = std::numeric_limits<std::size_t>::max() / 2;
+    std::stringstream oversized_model;
+    oversized_model.write(reinterpret_cast<char const*>(&huge_weights), sizeof(huge_weights));
+    assert(model.deserialize(oversized_model) == classifier::Error::io_failed);
+    std::cout << "  PASS: test_csr_training_data_round_trip\n";
+}
+
+void test_sparse_trainer_converges() {
+    auto data = make_sparse_clusters(4000, 200);
+
+    classifier::SparseModel model(200);
+    classifier::SparseTrainer t(model);
+    classifier::SparseSgdOptions options;
+    options.learning_rate = 0.5f;
+    options.epochs = 5;
+    assert(t.train(data, options) == classifier::Error::none);
+
+    classifier::SparseFeature positive[] = {{0, 1.0f}, {10, 1.0f}};
+    classifier::SparseFeature negative[] = {{0, 1.0f}, {11, 1.0f}};
+    classifier::Result result;
+    assert(model.classify(positive, result) == classifier::Error::none);
+    assert(result.prediction == classifier::Prediction::positive);
+    assert(model.classify(negative, result) == classifier::Error::none);
+    assert(result.prediction == classifier::Prediction::negative);
+
+    classifier::SparseModel wrong(100);
+    assert(classifier::SparseTrainer(wrong).train(data, options) ==
+           classifier::Error::dimension_mismatch);
+    auto broken = data;
+    broken.offsets[1] = broken.features.size() + 1;
+    broken.offsets[2] = 0;
+    assert(t.train(broken, options) == classifier::Error::invalid_format);
+    assert(t.train(classifier::CsrTrainingSet{}, options) == classifier::Error::empty_training_set);
+    options.regularization_strength = -1.0f;
+    assert(t.train(data, options) == classifier::Error::invalid_regularization_strength);
+    std::cout << "  PASS: test_sparse_trainer_converges\n";
+}
+
+// Reference: every step shrinks all weights, then updates the row's weights.
+void eager_sparse_sgd(classifier::CsrTrainingSet const& data, float learning_rate,
+                      std::size_t epochs, classifier::Regularization regularization,
+                      float strength, std::vector<float>& weights, float& bias) {
+    float shrink = learning_rate * strength;
+    for (std::size_t epoch = 0; epoch < epochs; ++epoch) {
+        for (std::size_t r = 0; r < data.rows(); ++r) {
+            for (float& w : weights) {
+                if (regularization == classifier::Regularization::l2) {
+                    w -= shrink * w;
+                } else if (std::fabs(w) <= shrink) {
+                    w = 0.0f;
+                } else {
+                    w -= std::copysign(shrink, w);
+                }
+            }
+            float z = bias;
+            for (auto const& feature : data.row(r)) {
+                z += weights[feature.index] * feature.value;
+            }
+            float error = classifier::math::sigmoid(z) - data.labels[r];
+            for (auto const& feature : data.row(r)) {
+                weights[feature.index] -= learning_rate * error * feature.value;
+            }
+            bias -= learning_rate * error;
+        }
+    }
+}
+
+void test_sparse_lazy_regularization_matches_eager() {
+    auto data = make_sparse_clusters(300, 40);
+    // The strong L2 case drives the shared scale factor through renormalization.
+    std::pair<classifier::Regularization, float> const cases[] = {
+        {classifier::Regularization::l1, 0.01f},
+        {classifier::Regularization::l2, 0.01f},
+        {classifier::Regularization::l2, 0.5f},
+    };
+    for (auto [regularization, strength] : cases) {
+        classifier::SparseModel model(40);
+        classifier::SparseSgdOptions options;
+        options.learning_rate = 0.2f;
+        options.epochs = 3;
+        options.shuffle = false;
+        options.regularization = regularization;
+        options.regularization_strength = strength;
+        assert(classifier::SparseTrainer(model).train(data, options) == classifier::Error::none);
+
+        std::vector<float> weights(40, 0.0f);
+        float bias = 0.0f;
+        eager_sparse_sgd(data, options.learning_rate, options.epochs, regularization,
+                         options.regularization_strength, weights, bias);
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            assert(std::fabs(model.weight(i) - weights[i]) < 1e-4f);
+        }
+        assert(std::fabs(model.bias() - bias) < 1e-4f);
+    }
+    std::cout << "  PASS: test_sparse_lazy_regularization_matches_eager\n";
+}
+
+void test_hash_keys_isa_agreement() {
+    std::vector<std::uint64_t> keys;
+    for (std::uint64_t k = 0; k < 1003; ++k) {
+        keys.push_back(k * 0x9e3779b97f4a7c15ull);
+    }
+    std::vector<classifier::kernels::HashSlot> expected(keys.size());
+    std::vector<classifier::kernels::HashSlot> actual(keys.size());
+    for (std::uint32_t buckets : {1u, 7u, 1024u, 1000003u}) {
+        classifier::kernels::hash_keys(keys.data(), keys.size(), 5, buckets, expected.data(),
+                                       classifier::kernels::HashIsa::scalar);
+        classifier::kernels::hash_keys(keys.data(), keys.size(), 5, buckets, actual.data());
+        bool saw_negative = false;
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            assert(actual[i].bucket == expected[i].bucket);
+            assert(actual[i].sign == expected[i].sign);
+            assert(expected[i].bucket < buckets);
+            saw_negative = saw_negative || expected[i].sign != 0;
+        }
+        assert(saw_negative);
+    }
+    std::cout << "  PASS: test_hash_keys_isa_agreement\n";
+}
+
+void test_feature_hasher_signed_buckets() {
+    classifier::FeatureHasher<16> hasher(3);
+    classifier::StringFeature features[] = {{"country=NZ", 2.0f}};
+    std::array<float, 16> row;
+    row.fill(7.0f);
+    hasher.hash(features, row);
+
+    float total = 0.0f;
+    std::size_t non_zero = 0;
+    for (float v : row) {
+        total += std::fabs(v);
+        non_zero += v != 0.0f;
+    }
+    assert(non_zero == 1 && total == 2.0f);
+
+    // The same feature twice lands in the same bucket with the same sign.
+    classifier::StringFeature twice[] = {{"country=NZ", 2.0f}, {"country=NZ", 1.0f}};
+    std::array<float, 16> doubled;
+    hasher.hash(twice, doubled);
+    for (std::size_t i = 0; i < 16; ++i) {
+        assert(doubled[i] == row[i] * 1.5f);
+    }
+
+    // Containers deduce the feature type as plain arrays do.
+    std::vector<classifier::StringFeature> as_vector(std::begin(features), std::end(features));
+    std::array<float, 16> from_vector;
+    hasher.hash(as_vector, from_vector);
+    assert(from_vector == row);
+    std::cout << "  PASS: test_feature_hasher_signed_buckets\n";
+}
+
+void test_feature_hasher_batch_matches_rows() {
+    classifier::FeatureHasher<8> hasher;
+    std::vector<classifier::KeyFeature> features;
+    std::vector<std::size_t> offsets = {0};
+    for (std::size_t r = 0; r < 300; ++r) {
+        for (std::size_t j = 0; j < r % 5; ++j) {
+            features.push_back({r * 31 + j, static_cast<float>(j) + 0.5f});
+        }
+        offsets.push_back(features.size());
+    }
+
+    std::vector<float> batch(300 * 8);
+    assert(hasher.hash_batch(features, offsets, batch) == classifier::Error::none);
+    for (std::size_t r = 0; r < 300; ++r) {
+        std::array<float, 8> row;
+        hasher.hash(std::span<classifier::KeyFeature const>(features.data() + offsets[r],
+                                                            offsets[r + 1] - offsets[r]),
+                    row);
+        for (std::size_t i = 0; i < 8; ++i) {
+            assert(batch[r * 8 + i] == row[i]);
+        }
+    }
+
+    std::vector<float> wrong(7);
+    assert(hasher.hash_batch(features, offsets, wrong) == classifier::Error::size_mismatch);
+    std::vector<std::size_t> bad_offsets = {0, 5, 3};
+    std::vector<float> two_rows(16);
+    assert(hasher.hash_batch(features, bad_offsets, two_rows) == classifier::Error::size_mismatch);
+    std::cout << "  PASS: test_feature_hasher_batch_matches_rows\n";
+}
+
+void test_feature_hasher_feeds_trainer() {
+    classifier::FeatureHasher<32> hasher(11);
+    std::string_view const colors[] = {"color=red", "color=green", "color=blue", "color=gray"};
+    classifier::Trainer<32>::TrainingSet data(400);
+    for (std::size_t r = 0; r < data.size(); ++r) {
+        classifier::StringFeature features[] = {{colors[r % 4], 1.0f}, {"bias", 1.0f}};
+        hasher.hash_sample(features, r % 4 < 2 ? 1.0f : 0.0f, data[r]);
+    }
+
+    classifier::Model<32> model;
+    classifier::Trainer<32> t(model);
+    assert(t.train(data, 1.0f, 200) == classifier::Error::none);
+
+    std::array<float, 32> row;
+    classifier::StringFeature red[] = {{"color=red", 1.0f}, {"bias", 1.0f}};
+    hasher.hash(red, row);
+    assert(model.classify(row).prediction == classifier::Prediction::positive);
+    classifier::StringFeature gray[] = {{"color=gray", 1.0f}, {"bias", 1.0f}};
+    hasher.hash(gray, row);
+    assert(model.classify(row).prediction == classifier::Prediction::negative);
+    std::cout << "  PASS: test_feature_hasher_feeds_trainer\n";
+}
+
+void test_crc32c() {
+    std::string_view check = "123456789";
+    assert(classifier::crc32c(check.data(), check.size()) == 0xe3069283u);
+    assert(~classifier::detail::crc32c_scalar(~0u, reinterpret_cast<unsigned char const*>(check.data()),
+                                              check.size()) == 0xe3069283u);
+
+    std::vector<unsigned char> bytes(1000);
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<unsigned char>(i * 131 + 7);
+    }
+    std::uint32_t whole = classifier::crc32c(bytes.data(), bytes.size());
+    std::uint32_t split = classifier::crc32c(bytes.data() + 333, bytes.size() - 333,
+                                             classifier::crc32c(bytes.data(), 333));
+    assert(whole == split);
+    assert(whole == ~classifier::detail::crc32c_scalar(~0u, bytes.data(), bytes.size()));
+    std::cout << "  PASS: test_crc32c\n";
+}
+
+classifier::Model<5> make_file_model() {
+    classifier::Model<5> model;
+    for (std::size_t i = 0; i < 5; ++i) {
+        model.set_weight(i, 0.5f * static_cast<float>(i) - 1.0f);
+    }
+    model.set_bias(0.25f);
+    return model;
+}
+
+void test_model_file_round_trip() {
+    auto model = make_file_model();
+    std::stringstream ss;
+    assert(classifier::write_model_file(ss, model, "trained=2026-01-01") == classifier::Error::none);
+    assert(ss.str().size() == 64 + 5 * sizeof(float) + 18);
+
+    classifier::Model<5> loaded;
+    std::string metadata;
+    assert(classifier::read_model_file(ss, loaded, &metadata) == classifier::Error::none);
+    assert(metadata == "trained=2026-01-01");
+    for (std::size_t i = 0; i < 5; ++i) {
+        assert(loaded.weight(i) == model.weight(i));
+    }
+    assert(loaded.bias() == model.bias());
+
+    // Legacy Model<N>::serialize output still loads.
+    std::stringstream legacy;
+    assert(model.serialize(legacy) == classifier::Error::none);
+    classifier::Model<5> from_legacy;
+    assert(classifier::read_model_file(legacy, from_legacy, &metadata) == classifier::Error::none);
+    assert(metadata.empty() && from_legacy.weight(4) == model.weight(4));
+
+    std::stringstream again;
+    classifier::write_model_file(again, model);
+    classifier::Model<4> wrong;
+    assert(classifier::read_model_file(again, wrong) == classifier::Error::dimension_mismatch);
+
+    std::string bytes = ss.str();
+    bytes[64 + 3] ^= 0x10;
+    std::stringstream corrupt(bytes);
+    assert(classifier::read_model_file(corrupt, loaded) == classifier::Error::invalid_format);
+
+    // A forged weights_offset far past the end of the stream is a short read,
+    // not a skip over whatever follows.
+    std::string forged = ss.str();
+    classifier::ModelFileHeader header;
+    std::memcpy(&header, forged.data(), sizeof(header));
+    header.weights_offset = ~std::uint64_t(63);
+    header.header_crc = classifier::detail::header_crc(header);
+    std::memcpy(forged.data(), &header, sizeof(header));
+    std::stringstream skipped(forged);
+    assert(classifier::read_model_file(skipped, loaded) == classifier::Error::io_failed);
+    std::cout << "  PASS: test_model_file_round_trip\n";
+}
+
+void test_mapped_model() {
+    auto model = make_file_model();
+    auto path = temp_path("classifier_test_model.clmf");
+    {
+        std::ofstream os(path, std::ios::binary);
+        assert(classifier::write_model_file(os, model, "v1") == classifier::Error::none);
+    }
+
+    classifier::MappedModel mapped;
+    assert(mapped.open(path.c_str()) == classifier::Error::none);
+    assert(mapped.weight_count() == 5 && mapped.metadata() == "v1");
+    assert(reinterpret_cast<std::uintptr_t>(mapped.weights().data()) % 64 == 0);
+
+    std::array<float, 5> features = {0.3f, -0.1f, 0.8f, 0.0f, -0.5f};
+    classifier::Result result;
+    assert(mapped.classify(features, result) == classifier::Error::none);
+    auto expected = model.classify(features);
+    assert(result.prediction == expected.prediction);
+    assert(std::fabs(result.confidence - expected.confidence) < 1e-6f);
+
+    classifier::Model<5> copy;
+    assert(mapped.to(copy) == classifier::Error::none && copy.weight(3) == model.weight(3));
+    mapped.close();
+
+    // A flipped weight bit is caught by full verification only; a flipped
+    // header bit is always caught.
+    std::string bytes;
+    {
+        std::ifstream is(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(is), {});
+    }
+    auto rewrite = [&](std::string const& contents) {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        os.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    };
+    std::string payload = bytes;
+    payload[70] ^= 0x01;
+    rewrite(payload);
+    assert(mapped.open(path.c_str()) == classifier::Error::invalid_format);
+    assert(mapped.open(path.c_str(), classifier::Verify::header) == classifier::Error::none);
+    mapped.close();
+
+    std::string header = bytes;
+    header[24] ^= 0x01;
+    rewrite(header);
+    assert(mapped.open(path.c_str(), classifier::Verify::header) ==
+           classifier::Error::invalid_format);
+
+    rewrite(bytes.substr(0, bytes.size() - 1));
+    assert(mapped.open(path.c_str()) == classifier::Error::invalid_format);
+
+    // A weights_offset chosen so offset + payload wraps around to the real
+    // file length, with a valid header checksum.
+    std::string forged = bytes;
+    forged.resize(128);
+    classifier::ModelFileHeader forged_header;
+    std::memcpy(&forged_header, forged.data(), sizeof(forged_header));
+    forged_header.dimension = std::uint64_t(1) << 38;
+    forged_header.metadata_size = 0;
+    forged_header.weights_offset = 128 - (forged_header.dimension * sizeof(float));
+    forged_header.header_crc = classifier::detail::header_crc(forged_header);
+    std::memcpy(forged.data(), &forged_header, sizeof(forged_header));
+    rewrite(forged);
+    assert(mapped.open(path.c_str(), classifier::Verify::header) ==
+           classifier::Error::invalid_format);
+    assert(mapped.open(path.c_str()) == classifier::Error::invalid_format);
+
+    std::stringstream legacy;
+    model.serialize(legacy);
+    rewrite(legacy.str());
+    assert(mapped.open(path.c_str()) == classifier::Error::none);
+    assert(mapped.weight_count() == 5 && mapped.bias() == model.bias());
+    assert(mapped.classify(features, result) == classifier::Error::none);
+    assert(result.prediction == expected.prediction);
+    mapped.close();
+
+    std::filesystem::remove(path);
+    std::cout << "  PASS: test_mapped_model\n";
+}
+
+classifier::Model<16> make_uniform_model(float value) {
+    classifier::Model<16> model;
+    for (std::size_t i = 0; i < 16; ++i) {
+        model.set_weight(i, value);
+    }
+    model.set_bias(value);
+    return model;
+}
+
+void test_model_registry_snapshots() {
+    classifier::ModelRegistry<classifier::Model<16>> registry(2);
+    auto reader = registry.reader();
+    assert(reader.valid());
+    assert(!reader.snapshot("ctr"));
+
+    auto v1 = registry.publish("ctr", make_uniform_model(1.0f));
+    {
+        auto old = reader.snapshot("ctr");
+        assert(old && old.version() == v1 && old->weight(0) == 1.0f);
+
+        auto v2 = registry.publish("ctr", make_uniform_model(2.0f));
+        assert(v2 > v1);
+        // The pinned state cannot be freed while `old` is alive.
+        assert(registry.pending_reclamation() == 1);
+        assert(old->weight(0) == 1.0f);
+
+        auto current = reader.snapshot("ctr");
+        assert(current.version() == v2 && current->weight(0) == 2.0f);
+    }
+    registry.reclaim();
+    assert(registry.pending_reclamation() == 0);
+
+    auto second = registry.reader();
+    assert(second.valid() && second.wait_free());
+    // Past max_readers a reader still sees the registry, through the lock.
+    auto third = registry.reader();
+    assert(third.valid() && !third.wait_free());
+    {
+        auto shared = third.snapshot("ctr");
+        assert(shared && shared->weight(0) == 2.0f);
+        registry.publish("ctr", make_uniform_model(3.0f));
+        assert(shared->weight(0) == 2.0f);
+        assert(third.snapshot("ctr")->weight(0) == 3.0f);
+    }
+    assert(!third.snapshot("absent"));
+    assert(!classifier::ModelRegistry<classifier::Model<16>>::Reader().valid());
+
+    assert(registry.remove("ctr"));
+    assert(!registry.remove("ctr"));
+    assert(!reader.snapshot("ctr"));
+    std::cout << "  PASS: test_model_registry_snapshots\n";
+}
+
+void test_model_registry_background_load() {
+    classifier::ModelRegistry<classifier::Model<16>> registry;
+    auto model = make_uniform_model(0.5f);
+    std::stringstream ss;
+    model.serialize(ss);
+    std::string bytes = ss.str();
+
+    auto loaded = registry.load("ctr", [&](classifier::Model<16>& out) {
+        std::istringstream is(bytes);
+        return out.deserialize(is);
+    });
+    assert(loaded.get() == classifier::Error::none);
+
+    auto failed = registry.load("ctr", [](classifier::Model<16>&) {
+        return classifier::Error::io_failed;
+    });
+    assert(failed.get() == classifier::Error::io_failed);
+
+    auto reader = registry.reader();
+    auto snapshot = reader.snapshot("ctr");
+    assert(snapshot && snapshot->weight(15) == 0.5f);
+    std::cout << "  PASS: test_model_registry_background_load\n";
+}
+
+// Readers score continuously while a writer swaps versions through
+// background loads. Every snapshot must be internally consistent, and each
+// reader must see versions only move forward. Read latency is checked by
+// test_model_registry_read_latency and measured by BM_RegistryReadLatency.
+void test_model_registry_swap_stress() {
+    classifier::ModelRegistry<classifier::Model<16>> registry;
+    registry.publish("ctr", make_uniform_model(0.0f));
+
+    constexpr std::size_t readers = 4;
+    constexpr std::size_t swaps = 200;
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+    std::atomic<bool> went_back{false};
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < readers; ++t) {
+        threads.emplace_back([&, t] {
+            auto reader = registry.reader();
+            std::array<float, 16> features;
+            features.fill(0.01f * static_cast<float>(t));
+            std::uint64_t last_version = 0;
+            while (!done.load()) {
+                auto snapshot = reader.snapshot("ctr");
+                auto result = snapshot->classify(features);
+                if (snapshot->weight(0) != snapshot->weight(15) ||
+                    snapshot->weight(0) != snapshot->bias()) {
+                    torn = true;
+                }
+                if (snapshot.version() < last_version) {
+                    went_back = true;
+                }
+                last_version = snapshot.version();
+                (void)result;
+            }
+        });
+    }
+
+    for (std::size_t swap = 1; swap <= swaps; ++swap) {
+        float value = static_cast<float>(swap);
+        auto loaded = registry.load("ctr", [value](classifier::Model<16>& out) {
+            out = make_uniform_model(value);
+            return classifier::Error::none;
+        });
+        assert(loaded.get() == classifier::Error::none);
+    }
+    done = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(!torn && !went_back);
+    registry.reclaim();
+    assert(registry.pending_reclamation() == 0);
+    auto reader = registry.reader();
+    assert(reader.snapshot("ctr")->weight(0) == static_cast<float>(swaps));
+    std::cout << "  PASS: test_model_registry_swap_stress\n";
+}
+
+// p99 of snapshot plus classify while a writer publishes every 100us must
+// stay close to p99 on a quiet registry. The bound is loose, 4x plus 2us,
+// and each attempt compares phases run back to back, so only a read path
+// that waits on the writer fails all three.
+void test_model_registry_read_latency() {
+    classifier::ModelRegistry<classifier::Model<16>> registry;
+    registry.publish("ctr", make_uniform_model(0.5f));
+    auto reader = registry.reader();
+    std::array<float, 16> features;
+    features.fill(0.25f);
+
+    auto p99_of_reads = [&] {
+        classifier::LatencyHistogram histogram;
+        for (std::size_t i = 0; i < 100'000; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            auto snapshot = reader.snapshot("ctr");
+            volatile auto result = snapshot->classify(features);
+            (void)result;
+            histogram.record(std::chrono::steady_clock::now() - start);
+        }
+        return histogram.percentile(0.99);
+    };
+
+    bool flat = false;
+    for (int attempt = 0; attempt < 3 && !flat; ++attempt) {
+        auto quiet = p99_of_reads();
+        std::atomic<bool> done{false};
+        std::thread publisher([&] {
+            float value = 1.0f;
+            while (!done.load()) {
+                registry.publish("ctr", make_uniform_model(value));
+                value += 1.0f;
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+        auto swapping = p99_of_reads();
+        done = true;
+        publisher.join();
+        flat = swapping <= 4 * quiet + std::chrono::microseconds(2);
+    }
+    assert(flat);
+    std::cout << "  PASS: test_model_registry_read_latency\n";
+}
+
+void test_linear_classes_isa_agreement() {
+    constexpr std::size_t n = 37;
+    for (std::size_t ldk : {16u, 48u, 144u, 272u}) {
+        std::vector<float> weights(n * ldk);
+        std::vector<float> bias(ldk);
+        std::vector<float> x(n);
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            weights[i] = static_cast<float>((i * 7) % 11) * 0.1f - 0.5f;
+        }
+        for (std::size_t c = 0; c < ldk; ++c) {
+            bias[c] = static_cast<float>(c % 3) - 1.0f;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] = static_cast<float>((i * 13) % 17) / 4.0f - 2.0f;
+        }
+
+        std::vector<float> expected(ldk);
+        classifier::kernels::linear_classes(weights.data(), ldk, n, bias.data(), x.data(),
+                                            expected.data(), classifier::kernels::Isa::scalar);
+        for (auto isa : {classifier::kernels::Isa::avx2, classifier::kernels::Isa::avx512}) {
+            if (isa > classifier::kernels::active_isa()) {
+                continue;
+            }
+            std::vector<float> actual(ldk);
+            classifier::kernels::linear_classes(weights.data(), ldk, n, bias.data(), x.data(),
+                                                actual.data(), isa);
+            for (std::size_t c = 0; c < ldk; ++c) {
+                assert(std::abs(actual[c] - expected[c]) < 1e-4f);
+            }
+        }
+    }
+
+    std::vector<float> logits = {-30.0f, 2.0f, 0.5f, 88.0f, 1.0f, -1.0f, 3.0f, 0.0f, 7.0f, -2.0f, 4.0f};
+    std::vector<float> expected = logits;
+    classifier::kernels::softmax_inplace(expected.data(), expected.size(),
+                                         classifier::kernels::Isa::scalar);
+    std::vector<float> actual = logits;
+    classifier::kernels::softmax_inplace(actual.data(), actual.size());
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < logits.size(); ++i) {
+        assert(std::abs(actual[i] - expected[i]) < 1e-6f);
+        sum += actual[i];
+    }
+    assert(std::abs(sum - 1.0f) < 1e-5f);
+    std::cout << "  PASS: test_linear_classes_isa_agreement\n";
+}
+
+void test_multiclass_one_vs_rest_matches_models() {
+    constexpr std::size_t k = 5;
+    constexpr std::size_t n = 23;
+    std::array<classifier::Model<n>, k> models;
+    for (std::size_t c = 0; c < k; ++c) {
+        for (std::size_t i = 0; i < n; ++i) {
+            models[c].set_weight(i, static_cast<float>((c * 31 + i * 7) % 13) * 0.1f - 0.6f);
+        }
+        models[c].set_bias(static_cast<float>(c) * 0.1f - 0.2f);
+    }
+    auto model = classifier::MulticlassModel<k, n>::one_vs_rest<classifier::ExactSigmoid>(models);
+    assert(model.mode() == classifier::MulticlassMode::one_vs_rest);
+
+    std::array<float, n> features;
+    for (std::size_t i = 0; i < n; ++i) {
+        features[i] = static_cast<float>((i * 5) % 9) / 3.0f - 1.0f;
+    }
+    std::array<float, k> probabilities;
+    model.probabilities(features, probabilities);
+
+    std::size_t best = 0;
+    for (std::size_t c = 0; c < k; ++c) {
+        float z = models[c].bias();
+        for (std::size_t i = 0; i < n; ++i) {
+            z += models[c].weight(i) * features[i];
+        }
+        assert(std::abs(probabilities[c] - classifier::math::sigmoid(z)) < 1e-5f);
+        if (probabilities[c] > probabilities[best]) {
+            best = c;
+        }
+    }
+    auto result = model.classify(features);
+    assert(result.label == best);
+    assert(std::abs(result.probability - probabilities[best]) < 1e-5f);
+    std::cout << "  PASS: test_multiclass_one_vs_rest_matches_models\n";
+}
+
+void test_multiclass_batch_and_serialize() {
+    constexpr std::size_t k = 50;
+    constexpr std::size_t n = 19;
+    classifier::MulticlassModel<k, n> model;
+    for (std::size_t c = 0; c < k; ++c) {
+        for (std::size_t i = 0; i < n; ++i) {
+            model.set_weight(c, i, static_cast<float>((c * 17 + i * 3) % 23) * 0.05f - 0.5f);
+        }
+        model.set_bias(c, static_cast<float>(c % 4) * 0.25f);
+    }
+
+    constexpr std::size_t rows = 9;
+    std::vector<float> features(rows * n);
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        features[i] = static_cast<float>((i * 11) % 7) - 3.0f;
+    }
+    std::vector<classifier::MulticlassResult> results(rows);
+    assert(model.classify_batch(features, results) == classifier::Error::none);
+    for (std::size_t r = 0; r < rows; ++r) {
+        std::array<float, n> row;
+        std::copy_n(features.begin() + static_cast<std::ptrdiff_t>(r * n), n, row.begin());
+        std::array<float, k> probabilities;
+        model.probabilities(row, probabilities);
+        float sum = 0.0f;
+        for (float p : probabilities) {
+            sum += p;
+        }
+        assert(std::abs(sum - 1.0f) < 1e-4f);
+
+        auto expected = model.classify(row);
+        assert(results[r].label == expected.label);
+        assert(std::abs(results[r].probability - probabilities[expected.label]) < 1e-5f);
+    }
+    assert(model.classify_batch(std::span(features).first(n + 1),
+                                std::span(results).first(1)) == classifier::Error::size_mismatch);
+
+    std::stringstream stream;
+    assert(model.serialize(stream) == classifier::Error::none);
+    std::string bytes = stream.str();
+    assert(bytes.size() == 3 * sizeof(std::uint32_t) + 2 * sizeof(std::size_t) +
+                               (k * n + k) * sizeof(float));
+
+    classifier::MulticlassModel<k, n> loaded(classifier::MulticlassMode::one_vs_rest);
+    assert(loaded.deserialize(stream) == classifier::Error::none);
+    assert(loaded.mode() == classifier::MulticlassMode::softmax);
+    for (std::size_t c = 0; c < k; ++c) {
+        for (std::size_t i = 0; i < n; ++i) {
+            assert(loaded.weight(c, i) == model.weight(c, i));
+        }
+        assert(loaded.bias(c) == model.bias(c));
+    }
+
+    std::stringstream wrong_shape(bytes);
+    classifier::MulticlassModel<k, n + 1> wider;
+    assert(wider.deserialize(wrong_shape) == classifier::Error::dimension_mismatch);
+    std::string corrupt = bytes;
+    corrupt[0] = 'X';
+    std::stringstream bad_magic(corrupt);
+    assert(loaded.deserialize(bad_magic) == classifier::Error::invalid_format);
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 4));
+    assert(loaded.deserialize(truncated) == classifier::Error::io_failed);
+    std::cout << "  PASS: test_multiclass_batch_and_serialize\n";
+}
+
+// Three well-separated clusters: class c has feature c high.
+std::vector<std::array<float, 5>> make_multiclass_clusters(std::size_t rows) {
+    std::mt19937_64 rng(11);
+    std::normal_distribution<float> noise(0.0f, 0.3f);
+    std::vector<std::array<float, 5>> data(rows);
+    for (std::size_t r = 0; r < rows; ++r) {
+        std::size_t label = r % 3;
+        for (std::size_t i = 0; i < 4; ++i) {
+            data[r][i] = noise(rng) + (i == label ? 2.0f : 0.0f);
+        }
+        data[r][4] = static_cast<float>(label);
+    }
+    return data;
+}
+
+void test_multiclass_trainer_converges() {
+    auto data = make_multiclass_clusters(1500);
+    for (auto mode : {classifier::MulticlassMode::softmax, classifier::MulticlassMode::one_vs_rest}) {
+        classifier::MulticlassModel<3, 4> model(mode);
+        classifier::MulticlassTrainer<3, 4> trainer(model);
+        classifier::SgdOptions options;
+        options.learning_rate = 0.5f;
+        options.epochs = 20;
+        options.batch_size = 32;
+        options.threads = 2;
+        assert(trainer.train_sgd(data, options) == classifier::Error::none);
+
+        std::size_t correct = 0;
+        for (auto const& sample : data) {
+            std::array<float, 4> features;
+            std::copy_n(sample.begin(), 4, features.begin());
+            auto result = model.classify(features);
+            correct += result.label == static_cast<std::size_t>(sample[4]);
+            assert(result.probability > 0.0f && result.probability <= 1.0f);
+        }
+        assert(correct > data.size() * 95 / 100);
+    }
+
+    classifier::MulticlassModel<3, 4> model;
+    classifier::MulticlassTrainer<3, 4> trainer(model);
+    classifier::SgdOptions options;
+    assert(trainer.train_sgd({}, options) == classifier::Error::empty_training_set);
+    data[7][4] = 3.0f;
+    assert(trainer.train_sgd(data, options) == classifier::Error::invalid_label);
+    data[7][4] = 0.5f;
+    assert(trainer.train_sgd(data, options) == classifier::Error::invalid_label);
+    std::cout << "  PASS: test_multiclass_trainer_converges\n";
+}
+
+void test_arena() {
+    classifier::Arena arena(1000);
+    assert(arena.capacity() == 1024);
+
+    auto bytes = arena.allocate<char>(3);
+    auto floats = arena.allocate<float>(10);
+    assert(bytes.size() == 3 && floats.size() == 10);
+    assert(reinterpret_cast<std::uintptr_t>(floats.data()) % classifier::cache_line_size == 0);
+    assert(arena.used() == 64 + 40);
+
+    auto mark = arena.mark();
+    assert(arena.allocate<float>(1000).empty());
+    assert(arena.used() == 64 + 40);
+    auto rest = arena.allocate<float>(128);
+    assert(rest.size() == 128 && arena.used() == 640);
+    arena.rewind(mark);
+    assert(arena.used() == 64 + 40);
+    assert(arena.high_water() == 640);
+    arena.reset();
+    assert(arena.used() == 0 && arena.allocate<float>(256).size() == 256);
+    assert(arena.allocate<float>(1).empty());
+
+    alignas(64) std::byte storage[256];
+    classifier::Arena borrowed(storage);
+    auto all = borrowed.allocate<std::uint32_t>(64);
+    assert(all.size() == 64 && static_cast<void*>(all.data()) == storage);
+    assert(borrowed.allocate<char>(1).empty());
+    std::cout << "  PASS: test_arena\n";
+}
+
+void test_inference_is_allocation_free() {
+    {
+        test_support::AllocationCounter counter;
+        auto p = std::make_unique<int>(1);
+        assert(counter.count() == 1);
+    }
+
+    constexpr std::size_t n = 40;
+    constexpr std::size_t rows = 300;
+    classifier::Model<n> model;
+    for (std::size_t i = 0; i < n; ++i) {
+        model.set_weight(i, static_cast<float>((i * 7) % 11) * 0.1f - 0.5f);
+    }
+    model.set_bias(0.1f);
+    std::vector<float> features(rows * n);
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        features[i] = static_cast<float>((i * 13) % 17) / 4.0f - 2.0f;
+    }
+    std::array<float, n> first;
+    std::copy_n(features.begin(), n, first.begin());
+
+    classifier::MulticlassModel<3, n> multiclass;
+    for (std::size_t c = 0; c < 3; ++c) {
+        for (std::size_t i = 0; i < n; ++i) {
+            multiclass.set_weight(c, i, static_cast<float>((c + i) % 5) * 0.1f - 0.2f);
+        }
+    }
+
+    classifier::Arena arena(1 << 20);
+    std::span<float> scores;
+    std::span<classifier::Result> results;
+    classifier::Explanation explanation;
+    std::span<classifier::Explanation> explanations;
+    std::span<classifier::MulticlassResult> multiclass_results;
+    std::span<float> probabilities;
+    for (int pass = 0; pass < 3; ++pass) {
+        arena.reset();
+        test_support::AllocationCounter counter;
+        auto result = model.classify(first);
+        assert(classifier::score_batch(model, features, arena, scores) == classifier::Error::none);
+        assert(classifier::classify_batch(model, features, arena, results) ==
+               classifier::Error::none);
+        assert(classifier::explain(model, first, 5, arena, explanation) ==
+               classifier::Error::none);
+        assert(classifier::explain_batch(model, features, 3, arena, explanations) ==
+               classifier::Error::none);
+        assert(classifier::classify_batch(multiclass, features, arena, multiclass_results) ==
+               classifier::Error::none);
+        assert(classifier::probabilities_batch(multiclass, features, arena, probabilities) ==
+               classifier::Error::none);
+        assert(counter.count() == 0);
+        assert(result.prediction == results[0].prediction);
+    }
+
+    assert(scores.size() == rows && results.size() == rows && explanations.size() == rows);
+    assert(multiclass_results.size() == rows && probabilities.size() == rows * 3);
+    for (std::size_t r = 0; r < rows; ++r) {
+        float p = results[r].prediction == classifier::Prediction::positive
+                      ? results[r].confidence
+                      : 1.0f - results[r].confidence;
+        assert(std::abs(scores[r] - p) < 1e-6f);
+        assert(explanations[r].result.prediction == results[r].prediction);
+        assert(explanations[r].contributions.size() == 3);
+    }
+
+    assert(explanation.contributions.size() == 5);
+    float previous = INFINITY;
+    for (auto const& contribution : explanation.contributions) {
+        float expected = model.weight(contribution.index) * first[contribution.index];
+        assert(contribution.value == expected);
+        assert(std::abs(contribution.value) <= previous);
+        previous = std::abs(contribution.value);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        assert(std::abs(model.weight(i) * first[i]) <= std::abs(explanation.contributions[0].value));
+    }
+
+    classifier::Arena small(1024);
+    assert(classifier::explain_batch(model, features, 3, small, explanations) ==
+           classifier::Error::arena_exhausted);
+    assert(small.used() == 0);
+    assert(classifier::score_batch(model, std::span(features).first(n + 1), small, scores) ==
+           classifier::Error::size_mismatch);
+    arena.reset();
+    assert(classifier::explain(model, first, 100, arena, explanation) == classifier::Error::none);
+    assert(explanation.contributions.size() == n);
+    std::cout << "  PASS: test_inference_is_allocation_free\n";
+}
+
+// Twenty features of which only the first three decide the label.
+std::vector<std::array<float, 21>> make_sparse_signal(std::size_t rows) {
+    std::mt19937_64 rng(5);
+    std::normal_distribution<float> feature(0.0f, 1.0f);
+    std::vector<std::array<float, 21>> data(rows);
+    for (auto& sample : data) {
+        for (std::size_t i = 0; i < 20; ++i) {
+            sample[i] = feature(rng);
+        }
+        sample[20] = sample[0] + sample[1] - sample[2] > 0.0f ? 1.0f : 0.0f;
+    }
+    return data;
+}
+
+template <std::size_t N>
+float log_loss(classifier::Model<N> const& model,
+               std::vector<std::array<float, N + 1>> const& data) {
+    double total = 0.0;
+    for (auto const& sample : data) {
+        float z = model.bias();
+        for (std::size_t i = 0; i < N; ++i) {
+            z += model.weight(i) * sample[i];
+        }
+        float p = std::clamp(classifier::math::sigmoid(z), 1e-7f, 1.0f - 1e-7f);
+        total -= sample[N] > 0.5f ? std::log(p) : std::log(1.0f - p);
+    }
+    return static_cast<float>(total / static_cast<double>(data.size()));
+}
+
+template <classifier::Optimizer O>
+float optimizer_loss(O optimizer, float learning_rate, std::size_t epochs) {
+    auto data = make_sparse_signal(2000);
+    classifier::Model<20> model;
+    classifier::Trainer<20> trainer(model);
+    classifier::SgdOptions options;
+    options.learning_rate = learning_rate;
+    options.epochs = epochs;
+    options.batch_size = 64;
+    assert(trainer.train_sgd(data, options, optimizer) == classifier::Error::none);
+    return log_loss(model, data);
+}
+
+void test_optimizers_converge() {
+    float plain = optimizer_loss(classifier::GradientDescent{}, 0.1f, 5);
+    float momentum = optimizer_loss(classifier::Momentum{}, 0.1f, 5);
+    float nesterov = optimizer_loss(classifier::Nesterov{}, 0.1f, 5);
+    float adagrad = optimizer_loss(classifier::AdaGrad{}, 0.5f, 5);
+    float adam = optimizer_loss(classifier::Adam{}, 0.05f, 5);
+    float ftrl = optimizer_loss(classifier::Ftrl{}, 0.5f, 5);
+    for (float loss : {momentum, nesterov, adagrad, adam, ftrl}) {
+        assert(loss < plain);
+        assert(loss < 0.2f);
+    }
+
+    // The default overload is plain gradient descent.
+    auto data = make_sparse_signal(500);
+    classifier::Model<20> a;
+    classifier::Model<20> b;
+    classifier::SgdOptions options;
+    options.epochs = 2;
+    options.batch_size = 50;
+    classifier::GradientDescent descent;
+    assert(classifier::Trainer<20>(a).train_sgd(data, options) == classifier::Error::none);
+    assert(classifier::Trainer<20>(b).train_sgd(data, options, descent) == classifier::Error::none);
+    for (std::size_t i = 0; i < 20; ++i) {
+        assert(a.weight(i) == b.weight(i));
+    }
+    assert(a.bias() == b.bias());
+
+    // Full-batch, unshuffled plain descent is train(), regularized or not.
+    for (auto regularization : {classifier::Regularization::l1, classifier::Regularization::l2}) {
+        classifier::Model<20> batch;
+        classifier::Model<20> stochastic;
+        classifier::SgdOptions full;
+        full.epochs = 3;
+        full.batch_size = data.size();
+        full.shuffle = false;
+        full.regularization = regularization;
+        full.regularization_strength = 0.01f;
+        assert(classifier::Trainer<20>(batch).train(data, full.learning_rate, full.epochs,
+                                                    regularization, 0.01f) ==
+               classifier::Error::none);
+        assert(classifier::Trainer<20>(stochastic).train_sgd(data, full) == classifier::Error::none);
+        for (std::size_t i = 0; i < 20; ++i) {
+            assert(batch.weight(i) == stochastic.weight(i));
+        }
+        assert(batch.bias() == stochastic.bias());
+    }
+
+    // State carries over between calls until reset.
+    classifier::Model<20> resumed;
+    classifier::Model<20> continuous;
+    classifier::Adam split;
+    classifier::Adam whole;
+    options.epochs = 1;
+    options.shuffle = false;
+    classifier::Trainer<20>(resumed).train_sgd(data, options, split);
+    classifier::Trainer<20>(resumed).train_sgd(data, options, split);
+    options.epochs = 2;
+    classifier::Trainer<20>(continuous).train_sgd(data, options, whole);
+    for (std::size_t i = 0; i < 20; ++i) {
+        assert(resumed.weight(i) == continuous.weight(i));
+    }
+    std::cout << "  PASS: test_optimizers_converge\n";
+}
+
+void test_ftrl_sparsity_and_compact_model() {
+    auto data = make_sparse_signal(2000);
+    classifier::SgdOptions options;
+    options.learning_rate = 0.5f;
+    options.epochs = 5;
+    options.batch_size = 64;
+    options.regularization = classifier::Regularization::l1;
+    options.regularization_strength = 0.05f;
+
+    classifier::Model<20> subgradient;
+    assert(classifier::Trainer<20>(subgradient).train_sgd(data, options) ==
+           classifier::Error::none);
+    std::size_t subgradient_zeros = 0;
+    for (std::size_t i = 0; i < 20; ++i) {
+        subgradient_zeros += subgradient.weight(i) == 0.0f;
+    }
+
+    // FTRL's L1 acts on the accumulated gradient, so it takes a larger
+    // strength than the per-step subgradient.
+    options.regularization_strength = 2.0f;
+    classifier::Model<20> model;
+    classifier::Ftrl ftrl;
+    assert(classifier::Trainer<20>(model).train_sgd(data, options, ftrl) ==
+           classifier::Error::none);
+    for (std::size_t i = 0; i < 3; ++i) {
+        assert(model.weight(i) != 0.0f);
+    }
+    std::size_t zeros = 0;
+    for (std::size_t i = 3; i < 20; ++i) {
+        zeros += model.weight(i) == 0.0f;
+    }
+    assert(zeros >= 14 && zeros > subgradient_zeros);
+    assert(log_loss(model, data) < 0.5f);
+
+    classifier::CompactModel<20> compact(model);
+    assert(compact.nonzero_count() == 20 - zeros);
+    for (std::size_t r = 0; r < 100; ++r) {
+        std::array<float, 20> features;
+        std::copy_n(data[r].begin(), 20, features.begin());
+        auto expected = model.classify(features);
+        auto actual = compact.classify(features);
+        assert(actual.prediction == expected.prediction);
+        assert(std::abs(actual.confidence - expected.confidence) < 1e-5f);
+    }
+
+    std::stringstream stream;
+    assert(compact.serialize(stream) == classifier::Error::none);
+    std::string bytes = stream.str();
+    assert(bytes.size() == 2 * sizeof(std::uint32_t) + 2 * sizeof(std::size_t) +
+                               compact.nonzero_count() * 8 + sizeof(float));
+    classifier::CompactModel<20> loaded;
+    assert(loaded.deserialize(stream) == classifier::Error::none);
+    classifier::Model<20> expanded;
+    loaded.to(expanded);
+    for (std::size_t i = 0; i < 20; ++i) {
+        assert(expanded.weight(i) == model.weight(i));
+    }
+    assert(expanded.bias() == model.bias());
+
+    std::stringstream wrong(bytes);
+    classifier::CompactModel<21> wider;
+    assert(wider.deserialize(wrong) == classifier::Error::dimension_mismatch);
+    if (compact.nonzero_count() >= 2) {
+        std::string unsorted = bytes;
+        std::size_t first = 2 * sizeof(std::uint32_t) + 2 * sizeof(std::size_t);
+        std::swap_ranges(unsorted.begin() + static_cast<std::ptrdiff_t>(first),
+                         unsorted.begin() + static_cast<std::ptrdiff_t>(first + 4),
+                         unsorted.begin() + static_cast<std::ptrdiff_t>(first + 4));
+        std::stringstream bad(unsorted);
+        assert(loaded.deserialize(bad) == classifier::Error::invalid_format);
+    }
+    std::cout << "  PASS: test_ftrl_sparsity_and_compact_model\n";
+}
+
+void test_training_observer_and_validation_split() {
+    auto data = make_sparse_signal(1000);
+    classifier::SgdOptions options;
+    options.epochs = 8;
+    options.batch_size = 50;
+    options.threads = 2;
+
+    classifier::Model<20> plain;
+    classifier::Model<20> observed;
+    classifier::GradientDescent a;
+    classifier::GradientDescent b;
+    classifier::LossHistory history;
+    assert(classifier::Trainer<20>(plain).train_sgd(data, options, a) == classifier::Error::none);
+    assert(classifier::Trainer<20>(observed).train_sgd(data, options, b, history) ==
+           classifier::Error::none);
+    for (std::size_t i = 0; i < 20; ++i) {
+        assert(plain.weight(i) == observed.weight(i));
+    }
+
+    assert(history.epochs.size() == 8);
+    for (std::size_t e = 0; e < history.epochs.size(); ++e) {
+        auto const& stats = history.epochs[e];
+        assert(stats.epoch == e);
+        assert(std::isnan(stats.validation_loss));
+        assert(stats.gradient_norm > 0.0);
+        assert(stats.wall_time.count() > 0);
+    }
+    assert(history.epochs.back().training_loss < history.epochs.front().training_loss);
+    assert(history.epochs.back().gradient_norm < history.epochs.front().gradient_norm);
+    // The first epoch starts from zero weights: every row's loss is log 2.
+    assert(history.epochs.front().training_loss < std::log(2.0));
+
+    // Held-out rows are scored but never trained on.
+    options.validation_fraction = 0.2f;
+    classifier::Model<20> split;
+    classifier::Model<20> truncated;
+    classifier::LossHistory split_history;
+    classifier::GradientDescent c;
+    classifier::GradientDescent d;
+    assert(classifier::Trainer<20>(split).train_sgd(data, options, c, split_history) ==
+           classifier::Error::none);
+    auto first = std::span(data).first(800);
+    options.validation_fraction = 0.0f;
+    assert(classifier::Trainer<20>(truncated).train_sgd(first, options, d) ==
+           classifier::Error::none);
+    for (std::size_t i = 0; i < 20; ++i) {
+        assert(split.weight(i) == truncated.weight(i));
+    }
+    double expected = 0.0;
+    for (std::size_t r = 800; r < 1000; ++r) {
+        float z = split.bias();
+        for (std::size_t i = 0; i < 20; ++i) {
+            z += split.weight(i) * data[r][i];
+        }
+        expected += classifier::math::logistic_loss(z, data[r][20]);
+    }
+    assert(std::abs(split_history.epochs.back().validation_loss - expected / 200.0) < 1e-6);
+
+    classifier::Trainer<20> trainer(plain);
+    for (float fraction : {-0.1f, 1.0f, NAN}) {
+        options.validation_fraction = fraction;
+        assert(trainer.train_sgd(data, options) == classifier::Error::invalid_validation_fraction);
+    }
+    options.validation_fraction = 0.5f;
+    assert(trainer.train_sgd({}, options) == classifier::Error::empty_training_set);
+    std::cout << "  PASS: test_training_observer_and_validation_split\n";
+}
+
+struct StopAfter {
+    std::size_t epochs;
+    std::size_t seen = 0;
+
+    classifier::EpochAction on_epoch(classifier::EpochStats const&) noexcept {
+        return ++seen == epochs ? classifier::EpochAction::stop : classifier::EpochAction::proceed;
+    }
+};
+
+struct ThrowingObserver {
+    classifier::EpochAction on_epoch(classifier::EpochStats const&) {
+        return classifier::EpochAction::proceed;
+    }
+};
+
+// Observers run inside noexcept training, so one that may throw is rejected.
+static_assert(classifier::TrainingObserver<StopAfter>);
+static_assert(classifier::TrainingObserver<classifier::LossHistory>);
+static_assert(!classifier::TrainingObserver<ThrowingObserver>);
+
+void test_early_stopping() {
+    auto data = make_sparse_signal(1000);
+    classifier::SgdOptions options;
+    options.epochs = 500;
+    options.batch_size = 100;
+    options.validation_fraction = 0.2f;
+    options.early_stopping = {1e-3, 3};
+
+    classifier::Model<20> model;
+    classifier::GradientDescent descent;
+    classifier::LossHistory history;
+    assert(classifier::Trainer<20>(model).train_sgd(data, options, descent, history) ==
+           classifier::Error::none);
+    assert(history.epochs.size() > 3 && history.epochs.size() < 500);
+    double best = history.epochs.front().validation_loss;
+    for (std::size_t e = 1; e + 3 < history.epochs.size(); ++e) {
+        best = std::min(best, history.epochs[e].validation_loss);
+    }
+    for (std::size_t e = history.epochs.size() - 3; e < history.epochs.size(); ++e) {
+        assert(history.epochs[e].validation_loss >= best - 1e-3);
+    }
+
+    // Early stopping also works without an observer.
+    classifier::Model<20> unobserved;
+    classifier::GradientDescent same;
+    assert(classifier::Trainer<20>(unobserved).train_sgd(data, options, same) ==
+           classifier::Error::none);
+    for (std::size_t i = 0; i < 20; ++i) {
+        assert(unobserved.weight(i) == model.weight(i));
+    }
+
+    options.early_stopping = {};
+    StopAfter stop{4};
+    classifier::Model<20> stopped;
+    assert(classifier::Trainer<20>(stopped).train_sgd(data, options, descent, stop) ==
+           classifier::Error::none);
+    assert(stop.seen == 4);
+    std::cout << "  PASS: test_early_stopping\n";
+}
+
+template <std::size_t N>
+void check_fixed_kernels() {
+    std::array<float, N> a;
+    std::array<float, N> b;
+    for (std::size_t i = 0; i < N; ++i) {
+        a[i] = static_cast<float>((i * 7) % 11) * 0.25f - 1.0f;
+        b[i] = static_cast<float>((i * 5) % 13) * 0.125f - 0.75f;
+    }
+    double expected = 0.0;
+    for (std::size_t i = 0; i < N; ++i) {
+        expected += static_cast<double>(a[i]) * b[i];
+    }
+    assert(std::abs(classifier::kernels::dot_fixed<N>(a.data(), b.data()) - expected) < 1e-5);
+    // Every width, not just the one this build picks.
+    assert(std::abs(classifier::kernels::dot_fixed<N, 1>(a.data(), b.data()) - expected) < 1e-5);
+    if constexpr (N >= 4) {
+        assert(std::abs(classifier::kernels::dot_fixed<N, 4>(a.data(), b.data()) - expected) <
+               1e-5);
+    }
+    if constexpr (N >= 8) {
+        assert(std::abs(classifier::kernels::dot_fixed<N, 8>(a.data(), b.data()) - expected) <
+               1e-5);
+    }
+
+    std::array<float, N> y = b;
+    classifier::kernels::axpy_fixed<N>(0.5f, a.data(), y.data());
+    for (std::size_t i = 0; i < N; ++i) {
+        assert(y[i] == b[i] + 0.5f * a[i]);
+    }
+
+    classifier::Model<N> model;
+    for (std::size_t i = 0; i < N; ++i) {
+        model.set_weight(i, a[i]);
+    }
+    auto result = model.classify(b);
+    float score = classifier::math::sigmoid(static_cast<float>(expected));
+    assert(std::abs((result.prediction == classifier::Prediction::positive
+                         ? result.confidence
+                         : 1.0f - result.confidence) -
+                    score) < 1e-5f);
+}
+
+void test_fixed_kernels() {
+    check_fixed_kernels<1>();
+    check_fixed_kernels<3>();
+    check_fixed_kernels<4>();
+    check_fixed_kernels<5>();
+    check_fixed_kernels<8>();
+    check_fixed_kernels<11>();
+    check_fixed_kernels<16>();
+    check_fixed_kernels<19>();
+    check_fixed_kernels<31>();
+    check_fixed_kernels<32>();
+    std::cout << "  PASS: test_fixed_kernels\n";
+}
+
+void test_thread_pool_run_tasks() {
+    classifier::ThreadPool pool(4);
+    std::vector<std::atomic<int>> runs(103);
+    std::atomic<std::size_t> participants_seen{0};
+    pool.run_tasks(runs.size(), [&](std::size_t task, std::size_t t) {
+        assert(t < pool.size());
+        runs[task].fetch_add(1);
+        participants_seen.fetch_or(std::size_t(1) << t);
+    });
+    for (auto const& count : runs) {
+        assert(count.load() == 1);
+    }
+    assert(participants_seen.load() != 0);
+
+    int calls = 0;
+    pool.run_tasks(0, [&](std::size_t, std::size_t) { ++calls; });
+    assert(calls == 0);
+    std::cout << "  PASS: test_thread_pool_run_tasks\n";
+}
+
+void test_search_candidates() {
+    classifier::SearchGrid space;
+    space.learning_rates = {0.01f, 0.1f, 1.0f};
+    space.epochs = {10, 20};
+    space.regularizations = {classifier::Regularization::l1, classifier::Regularization::l2};
+    space.regularization_strengths = {0.0f, 0.5f};
+    auto candidates = classifier::grid(space);
+    assert(candidates.size() == 24);
+    assert(candidates[0].learning_rate == 0.01f && candidates[0].epochs == 10);
+    assert(candidates[1].regularization_strength == 0.5f);
+    assert(candidates[23].learning_rate == 1.0f && candidates[23].epochs == 20 &&
+           candidates[23].regularization == classifier::Regularization::l2);
+
+    classifier::SearchRanges ranges;
+    auto drawn = classifier::random_search(ranges, 50, 3);
+    auto again = classifier::random_search(ranges, 50, 3);
+    assert(drawn.size() == 50);
+    for (std::size_t i = 0; i < drawn.size(); ++i) {
+        auto const& c = drawn[i];
+        assert(c.learning_rate >= ranges.min_learning_rate &&
+               c.learning_rate <= ranges.max_learning_rate);
+        assert(c.epochs >= ranges.min_epochs && c.epochs <= ranges.max_epochs);
+        if (c.regularization == classifier::Regularization::none) {
+            assert(c.regularization_strength == 0.0f);
+        } else {
+            assert(c.regularization_strength >= ranges.min_regularization_strength &&
+                   c.regularization_strength <= ranges.max_regularization_strength);
+        }
+        assert(c.learning_rate == again[i].learning_rate && c.epochs == again[i].epochs);
+    }
+
+    auto invalid = [&](auto change) {
+        classifier::SearchRanges bad = ranges;
+        change(bad);
+        return !bad.valid() && classifier::random_search(bad, 10).empty();
+    };
+    assert(invalid([](auto& r) { r.min_epochs = 300; }));
+    assert(invalid([](auto& r) { r.min_learning_rate = 0.0f; }));
+    assert(invalid([](auto& r) { r.max_learning_rate = 1e-4f; }));
+    assert(invalid([](auto& r) { r.min_regularization_strength = -1.0f; }));
+    assert(invalid([](auto& r) { r.max_regularization_strength = std::nanf(""); }));
+    std::cout << "  PASS: test_search_candidates\n";
+}
+
+void test_roc_auc() {
+    std::vector<std::pair<float, float>> scored = {{0.1f, 0.0f}, {0.4f, 0.0f}, {0.35f, 1.0f},
+                                                   {0.8f, 1.0f}};
+    assert(std::abs(classifier::detail::roc_auc(scored) - 0.75) < 1e-12);
+
+    std::vector<std::pair<float, float>> tied = {{0.5f, 1.0f}, {0.5f, 0.0f}, {0.9f, 1.0f}};
+    assert(std::abs(classifier::detail::roc_auc(tied) - 0.75) < 1e-12);
+
+    std::vector<std::pair<float, float>> one_class = {{0.2f, 1.0f}, {0.3f, 1.0f}};
+    assert(std::isnan(classifier::detail::roc_auc(one_class)));
+    std::cout << "  PASS: test_roc_auc\n";
+}
+
+void test_cross_validation() {
+    auto data = make_sparse_signal(600);
+    classifier::SearchGrid space;
+    space.learning_rates = {1e-4f, 0.5f};
+    space.epochs = {40};
+    space.regularizations = {classifier::Regularization::l2};
+    space.regularization_strengths = {0.0f, 1e-3f};
+    auto candidates = classifier::grid(space);
+
+    classifier::CrossValidationOptions options;
+    options.folds = 4;
+    options.threads = 1;
+    classifier::SearchResult<20> serial;
+    assert(classifier::cross_validate<20>(data, candidates, options, serial) ==
+           classifier::Error::none);
+    options.threads = 3;
+    classifier::SearchResult<20> parallel;
+    assert(classifier::cross_validate<20>(data, candidates, options, parallel) ==
+           classifier::Error::none);
+
+    assert(serial.scores.size() == candidates.size());
+    for (std::size_t c = 0; c < candidates.size(); ++c) {
+        assert(serial.scores[c].mean_log_loss == parallel.scores[c].mean_log_loss);
+        assert(serial.scores[c].std_auc == parallel.scores[c].std_auc);
+        assert(serial.scores[c].std_log_loss >= 0.0);
+    }
+    assert(serial.best == parallel.best);
+    assert(candidates[serial.best].learning_rate == 0.5f);
+    auto const& best = serial.scores[serial.best];
+    assert(best.mean_auc > 0.95 && best.mean_log_loss < serial.scores[0].mean_log_loss);
+
+    // The returned model is the best candidate refit on everything.
+    classifier::Model<20> refit;
+    classifier::Trainer<20> trainer(refit);
+    trainer.train(data, best.hyperparameters.learning_rate, best.hyperparameters.epochs,
+                  best.hyperparameters.regularization,
+                  best.hyperparameters.regularization_strength);
+    for (std::size_t i = 0; i < 20; ++i) {
+        assert(refit.weight(i) == serial.model.weight(i));
+    }
+    assert(refit.bias() == serial.model.bias());
+
+    options.folds = 1;
+    assert(classifier::cross_validate<20>(data, candidates, options, serial) ==
+           classifier::Error::invalid_fold_count);
+    options.folds = data.size() + 1;
+    assert(classifier::cross_validate<20>(data, candidates, options, serial) ==
+           classifier::Error::invalid_fold_count);
+    options.folds = 3;
+    assert(classifier::cross_validate<20>(data, {}, options, serial) ==
+           classifier::Error::empty_search_space);
+    candidates[0].regularization_strength = -1.0f;
+    assert(classifier::cross_validate<20>(data, candidates, options, serial) ==
+           classifier::Error::invalid_regularization_strength);
+    std::cout << "  PASS: test_cross_validation\n";
+}
+
+void test_train_on_row_subset() {
+    auto data = make_sparse_signal(200);
+    std::vector<std::size_t> rows;
+    std::vector<std::array<float, 21>> copied;
+    for (std::size_t r = 0; r < data.size(); r += 3) {
+        rows.push_back(r);
+        copied.push_back(data[r]);
+    }
+    classifier::Model<20> viewed;
+    classifier::Model<20> dense;
+    classifier::Trainer<20>(viewed).train(data, rows, 0.3f, 20);
+    classifier::Trainer<20>(dense).train(copied, 0.3f, 20);
+    for (std::size_t i = 0; i < 20; ++i) {
+        assert(viewed.weight(i) == dense.weight(i));
+    }
+    assert(viewed.bias() == dense.bias());
+    assert(classifier::Trainer<20>(viewed).train(data, std::span<std::size_t const>{}) ==
+           classifier::Error::empty_training_set);
+    std::cout << "  PASS: test_train_on_row_subset\n";
+}
+
+void test_latency_histogram() {
+    classifier::LatencyHistogram histogram;
+    assert(histogram.percentile(0.5).count() == 0);
+    for (std::uint64_t v = 1; v <= 100'000; ++v) {
+        histogram.record(v * 1000);
+    }
+    assert(histogram.count() == 100'000);
+    assert(histogram.max().count() == 100'000'000);
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        double exact = q * 100'000'000.0;
+        double reported = static_cast<double>(histogram.percentile(q).count());
+        assert(reported >= exact * 0.999 && reported <= exact * (1.0 + 1.0 / 32.0));
+    }
+    assert(histogram.percentile(1.0) == histogram.max());
+
+    // Exact below 32, and every bucket's bound maps back to the bucket.
+    for (std::uint64_t v = 0; v < 32; ++v) {
+        assert(classifier::LatencyHistogram::bucket_of(v) == v);
+    }
+    for (std::size_t b = 0; b + 1 < classifier::LatencyHistogram::bucket_count; ++b) {
+        std::uint64_t bound = classifier::LatencyHistogram::upper_bound(b);
+        assert(classifier::LatencyHistogram::bucket_of(bound) == b);
+        assert(classifier::LatencyHistogram::bucket_of(bound + 1) == b + 1);
+    }
+
+    classifier::LatencyHistogram other;
+    other.record(std::chrono::milliseconds(500));
+    auto merged = histogram.snapshot();
+    merged.merge(other);
+    assert(merged.count() == 100'001);
+    assert(merged.max() == std::chrono::milliseconds(500));
+    std::cout << "  PASS: test_latency_histogram\n";
+}
+
+void check_scoring_server(classifier::ScoringServerOptions options) {
+    constexpr std::size_t N = 8;
+    classifier::Model<N> model;
+    for (std::size_t i = 0; i < N; ++i) {
+        model.set_weight(i, 0.25f * static_cast<float>(i) - 1.0f);
+    }
+    model.set_bias(0.1f);
+
+    options.loops = 2;
+    options.max_batch_rows = 16;
+    options.max_queue_delay = std::chrono::microseconds(200);
+    options.max_request_rows = 64;
+    classifier::ScoringServer<N> server(model, options);
+    assert(server.start() == classifier::Error::none);
+
+    auto connect = [&](classifier::ScoringClient<N>& client) {
+        return options.unix_path.empty() ? client.connect_tcp(server.port())
+                                         : client.connect_unix(options.unix_path);
+    };
+
+    constexpr std::size_t clients = 4;
+    constexpr std::size_t requests = 50;
+    std::atomic<std::size_t> failures{0};
+    std::vector<std::thread> threads;
+    for (std::size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            classifier::ScoringClient<N> client;
+            if (connect(client) != classifier::Error::none) {
+                ++failures;
+                return;
+            }
+            std::mt19937_64 rng(c);
+            std::normal_distribution<float> feature(0.0f, 1.0f);
+            for (std::size_t r = 0; r < requests; ++r) {
+                std::size_t rows = 1 + (c + r) % 20;
+                std::vector<float> features(rows * N);
+                for (auto& v : features) {
+                    v = feature(rng);
+                }
+                std::vector<float> scores(rows);
+                std::vector<float> expected(rows);
+                model.score_batch(features, expected);
+                if (client.score(features, scores) != classifier::Error::none) {
+                    ++failures;
+                    return;
+                }
+                for (std::size_t i = 0; i < rows; ++i) {
+                    if (std::abs(scores[i] - expected[i]) > 1e-6f) {
+                        ++failures;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(failures.load() == 0);
+
+    // Pipelined requests come back in order.
+    classifier::ScoringClient<N> client;
+    assert(connect(client) == classifier::Error::none);
+    std::vector<float> ones(N, 1.0f);
+    std::vector<float> zeros(2 * N, 0.0f);
+    assert(client.send(ones) == classifier::Error::none);
+    assert(client.send(zeros) == classifier::Error::none);
+    std::vector<float> first(1);
+    std::vector<float> second(2);
+    assert(client.receive(first) == classifier::Error::none);
+    assert(client.receive(second) == classifier::Error::none);
+    assert(std::abs(second[0] - classifier::math::sigmoid(0.1f)) < 1e-6f);
+    // The weights sum to -1.
+    assert(std::abs(first[0] - classifier::math::sigmoid(-0.9f)) < 1e-6f);
+
+    // Oversized requests close the connection.
+    std::vector<float> oversized(65 * N, 0.0f);
+    std::vector<float> oversized_scores(65);
+    assert(client.score(oversized, oversized_scores) == classifier::Error::io_failed);
+
+    auto stats = server.stats();
+    assert(stats.connections == clients + 1);
+    assert(stats.requests == clients * requests + 2);
+    assert(stats.latency.count() == stats.requests);
+    assert(stats.batches > 0 && stats.batches <= stats.requests);
+    server.stop();
+    assert(server.stats().requests == stats.requests);
+
+    // Starting again, running or not, serves afresh.
+    assert(server.start() == classifier::Error::none);
+    assert(server.start() == classifier::Error::none);
+    assert(connect(client) == classifier::Error::none);
+    assert(client.score(ones, first) == classifier::Error::none);
+    assert(std::abs(first[0] - classifier::math::sigmoid(-0.9f)) < 1e-6f);
+}
+
+// A client that sends far more than it reads: the server stops reading it
+// at max_pending_output and picks up again as the responses drain.
+void test_scoring_server_backpressure() {
+    constexpr std::size_t N = 4;
+    classifier::Model<N> model;
+    model.set_bias(0.5f);
+    classifier::ScoringServerOptions options;
+    options.loops = 1;
+    options.max_queue_delay = std::chrono::microseconds(0);
+    options.max_pending_output = 4096;
+    options.unix_path = temp_path("classifier_backpressure.sock").string();
+    classifier::ScoringServer<N> server(model, options);
+    assert(server.start() == classifier::Error::none);
+
+    classifier::ScoringClient<N> client;
+    assert(client.connect_unix(options.unix_path) == classifier::Error::none);
+    constexpr std::size_t requests = 300;
+    constexpr std::size_t rows = 4096;
+    std::vector<float> features(rows * N, 1.0f);
+    std::thread sender([&] {
+        for (std::size_t r = 0; r < requests; ++r) {
+            assert(client.send(features) == classifier::Error::none);
+        }
+    });
+    // Sending alone outruns the socket buffers, so the server has paused
+    // this connection by the time the first response is read.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::vector<float> scores(rows);
+    for (std::size_t r = 0; r < requests; ++r) {
+        assert(client.receive(scores) == classifier::Error::none);
+        assert(std::abs(scores.back() - classifier::math::sigmoid(0.5f)) < 1e-6f);
+    }
+    sender.join();
+    server.stop();
+    assert(server.stats().requests == requests);
+    std::cout << "  PASS: test_scoring_server_backpressure\n";
+}
+
+void test_scoring_server() {
+    classifier::ScoringServerOptions options;
+    check_scoring_server(options);
+    options.unix_path = temp_path("classifier_test.sock").string();
+    check_scoring_server(options);
+    assert(!std::filesystem::exists(options.unix_path));
+
+    // A regular file at the socket path is neither replaced nor removed.
+    std::ofstream(options.unix_path) << "keep";
+    classifier::ScoringServer<2> blocked(classifier::Model<2>{}, options);
+    assert(blocked.start() == classifier::Error::io_failed);
+    assert(std::filesystem::is_regular_file(options.unix_path));
+    std::filesystem::remove(options.unix_path);
+    std::cout << "  PASS: test_scoring_server\n";
+}
+
+classifier::Trainer<2>::TrainingSet make_noisy_labels(std::size_t rows) {
+    std::mt19937_64 rng(11);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    classifier::Trainer<2>::TrainingSet data(rows);
+    for (auto& sample : data) {
+        sample[0] = normal(rng);
+        sample[1] = normal(rng);
+        sample[2] = sample[0] + 0.5f * sample[1] + normal(rng) > 0.0f ? 1.0f : 0.0f;
+    }
+    return data;
+}
+
+// Reads from a string but cannot seek or report its position, like a pipe.
+struct UnseekableBuffer : std::streambuf {
+    explicit UnseekableBuffer(std::string contents) : bytes(std::move(contents)) {
+        setg(bytes.data(), bytes.data(), bytes.data() + bytes.size());
+    }
+    std::string bytes;
+};
+
+void test_evaluation() {
+    auto data = make_noisy_labels(20000);
+    classifier::Model<2> model;
+    model.set_weight(0, 0.8f);
+    model.set_weight(1, 0.3f);
+    model.set_bias(0.1f);
+
+    // Reference: one row at a time, AUC from sorting every margin, computed
+    // with the same kernel so that equal margins stay equal.
+    double loss = 0.0;
+    std::uint64_t positives = 0, predicted = 0, true_positives = 0, correct = 0;
+    std::vector<std::pair<float, float>> scored;
+    for (auto const& sample : data) {
+        float z = classifier::kernels::dot_fixed<2>(model.weights().data(), sample.data()) +
+                  model.bias();
+        bool positive = sample[2] > 0.5f;
+        bool predicted_positive =
+            model.classify({sample[0], sample[1]}).prediction == classifier::Prediction::positive;
+        loss += classifier::math::logistic_loss(z, sample[2]);
+        positives += positive;
+        predicted += predicted_positive;
+        true_positives += positive && predicted_positive;
+        correct += positive == predicted_positive;
+        scored.emplace_back(z, sample[2]);
+    }
+    double exact_auc = classifier::detail::roc_auc(scored);
+
+    classifier::EvaluationOptions options;
+    options.auc_error = 1e-5;
+    options.threads = 3;
+    classifier::Evaluation result;
+    assert(classifier::evaluate(model, std::span(std::as_const(data)), options, result) ==
+           classifier::Error::none);
+    assert(result.rows == data.size() && result.positives == positives);
+    assert(std::abs(result.log_loss - loss / 20000.0) < 1e-5);
+    assert(result.accuracy == static_cast<double>(correct) / 20000.0);
+    assert(result.precision == static_cast<double>(true_positives) / static_cast<double>(predicted));
+    assert(result.recall == static_cast<double>(true_positives) / static_cast<double>(positives));
+    assert(result.auc_error <= options.auc_error);
+    assert(std::abs(result.auc - exact_auc) <= result.auc_error + 1e-12);
+
+    std::uint64_t calibrated = 0;
+    for (std::size_t b = 0; b < result.calibration.size(); ++b) {
+        auto const& bin = result.calibration[b];
+        calibrated += bin.count;
+        assert(bin.lower == static_cast<float>(b) / 10.0f);
+        assert(bin.count == 0 || (bin.mean_probability >= bin.lower - 1e-6 &&
+                                  bin.mean_probability <= bin.upper + 1e-6));
+    }
+    assert(result.calibration.size() == 10 && calibrated == data.size());
+
+    // The histogram alone reports how far off it may be; an exact budget
+    // ranks every mixed bin and matches the sort.
+    options.auc_error = 1.0;
+    classifier::Evaluation coarse;
+    classifier::evaluate(model, std::span(std::as_const(data)), options, coarse);
+    assert(coarse.auc_error > 1e-5 && std::abs(coarse.auc - exact_auc) <= coarse.auc_error);
+    options.auc_error = 0.0;
+    options.threads = 1;
+    classifier::Evaluation exact;
+    classifier::evaluate(model, std::span(std::as_const(data)), options, exact);
+    assert(exact.auc_error == 0.0 && std::abs(exact.auc - exact_auc) < 1e-12);
+
+    // A stream read in chunks gives the same counts and AUC.
+    auto ss = serialize_training_set(data);
+    options.chunk_rows = 700;
+    options.threads = 2;
+    classifier::Evaluation streamed;
+    assert(classifier::evaluate(model, ss, options, streamed) == classifier::Error::none);
+    assert(streamed.rows == exact.rows && streamed.accuracy == exact.accuracy);
+    assert(streamed.auc == exact.auc && std::abs(streamed.log_loss - exact.log_loss) < 1e-9);
+
+    for (auto& sample : data) {
+        sample[2] = 1.0f;
+    }
+    classifier::evaluate(model, std::span(std::as_const(data)), options, result);
+    assert(std::isnan(result.auc) && result.recall == result.accuracy);
+
+    data.clear();
+    assert(classifier::evaluate(model, std::span(std::as_const(data)), options, result) ==
+           classifier::Error::empty_training_set);
+    data = make_noisy_labels(10);
+    options.calibration_bins = 0;
+    assert(classifier::evaluate(model, std::span(std::as_const(data)), options, result) ==
+           classifier::Error::invalid_bin_count);
+    options.calibration_bins = 10;
+
+    // A NaN feature gives a NaN margin, which has no calibration bin and no
+    // place in the ranking.
+    auto clean = data;
+    options.auc_error = 0.0;
+    classifier::Evaluation reference;
+    assert(classifier::evaluate(model, std::span(std::as_const(clean)), options, reference) ==
+           classifier::Error::none);
+    data.push_back({std::nanf(""), 0.0f, 1.0f});
+    data.push_back({std::nanf(""), 1.0f, 0.0f});
+    assert(classifier::evaluate(model, std::span(std::as_const(data)), options, result) ==
+           classifier::Error::none);
+    assert(result.rows == 12 && result.unscored == 2 && reference.unscored == 0);
+    std::uint64_t binned = 0;
+    for (auto const& bin : result.calibration) {
+        binned += bin.count;
+    }
+    assert(binned == 10);
+    assert(result.auc == reference.auc);
+    data = clean;
+    options.auc_error = 1e-3;
+    options.chunk_rows = 0;
+    auto small = serialize_training_set(data);
+    assert(classifier::evaluate(model, small, options, result) ==
+           classifier::Error::invalid_batch_size);
+    options.chunk_rows = 4;
+    std::string bytes = serialize_training_set(data).str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 5),
+                                std::ios::binary | std::ios::in);
+    assert(classifier::evaluate(model, truncated, options, result) ==
+           classifier::Error::io_failed);
+    classifier::Model<3> wider;
+    auto mismatched = serialize_training_set(data);
+    assert(classifier::evaluate(wider, mismatched, options, result) ==
+           classifier::Error::dimension_mismatch);
+
+    // A pipe is read once; only a second pass to refine the AUC needs a seek.
+    classifier::Trainer<2>::TrainingSet separable = {
+        {2.0f, 0.0f, 1.0f}, {3.0f, 0.0f, 1.0f}, {-2.0f, 0.0f, 0.0f}, {-3.0f, 0.0f, 0.0f}};
+    options.auc_error = 0.0;
+    UnseekableBuffer once(serialize_training_set(separable).str());
+    std::istream pipe(&once);
+    assert(classifier::evaluate(model, pipe, options, result) == classifier::Error::none);
+    assert(result.rows == 4 && result.auc == 1.0 && result.auc_error == 0.0);
+    classifier::Trainer<2>::TrainingSet tied = {{1.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}};
+    UnseekableBuffer twice(serialize_training_set(tied).str());
+    std::istream refining(&twice);
+    assert(classifier::evaluate(model, refining, options, result) ==
+           classifier::Error::io_failed);
+    std::cout << "  PASS: test_evaluation\n";
+}
+
+void test_linear_classes_rows_isa_agreement() {
+    constexpr std::size_t n = 19;
+    constexpr std::size_t count = 7;
+    for (std::size_t columns : {1u, 13u, 16u, 40u, 100u}) {
+        std::size_t ldk = (columns + 15) & ~std::size_t(15);
+        std::vector<float> weights(n * ldk);
+        std::vector<float> bias(ldk);
+        std::vector<float> rows(count * n);
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            weights[i] = static_cast<float>((i * 7) % 11) * 0.1f - 0.5f;
+        }
+        for (std::size_t c = 0; c < ldk; ++c) {
+            bias[c] = static_cast<float>(c % 3) - 1.0f;
+        }
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            rows[i] = static_cast<float>((i * 13) % 17) / 4.0f - 2.0f;
+        }
+
+        // Each row agrees with linear_classes, and nothing past `columns`
+        // is written.
+        std::vector<float> single(ldk);
+        for (auto isa : {classifier::kernels::Isa::scalar, classifier::kernels::Isa::avx2,
+                         classifier::kernels::Isa::avx512}) {
+            if (isa > classifier::kernels::active_isa()) {
+                continue;
+            }
+            std::vector<float> out(count * columns + 1, 42.0f);
+            classifier::kernels::linear_classes_rows(weights.data(), ldk, n, bias.data(),
+                                                     rows.data(), count, columns, out.data(),
+                                                     columns, isa);
+            for (std::size_t r = 0; r < count; ++r) {
+                classifier::kernels::linear_classes(weights.data(), ldk, n, bias.data(),
+                                                    rows.data() + r * n, single.data(),
+                                                    classifier::kernels::Isa::scalar);
+                for (std::size_t c = 0; c < columns; ++c) {
+                    assert(std::abs(out[r * columns + c] - single[c]) < 1e-4f);
+                }
+            }
+            assert(out.back() == 42.0f);
+        }
+    }
+    std::cout << "  PASS: test_linear_classes_rows_isa_agreement\n";
+}
+
+classifier::Model<20> make_tenant_model(std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<float> weight(0.0f, 0.3f);
+    classifier::Model<20> model;
+    for (std::size_t i = 0; i < 20; ++i) {
+        model.set_weight(i, weight(rng));
+    }
+    model.set_bias(weight(rng));
+    return model;
+}
+
+// Every live model's bank score for each row against its own classify().
+void check_bank_matches_models(classifier::ModelBank<20> const& bank,
+                               std::vector<classifier::Model<20>> const& models,
+                               std::vector<float> const& rows) {
+    std::size_t count = rows.size() / 20;
+    std::vector<float> batch(count * bank.size());
+    assert(bank.score_batch(rows, batch) == classifier::Error::none);
+    std::vector<float> single(bank.size());
+    for (std::size_t r = 0; r < count; ++r) {
+        std::array<float, 20> x;
+        std::copy_n(rows.begin() + static_cast<std::ptrdiff_t>(r * 20), 20, x.begin());
+        assert(bank.score(x, single) == classifier::Error::none);
+        for (std::size_t c = 0; c < bank.size(); ++c) {
+            auto result = models[bank.ids()[c]].classify(x);
+            float expected = result.prediction == classifier::Prediction::positive
+                                 ? result.confidence
+                                 : 1.0f - result.confidence;
+            assert(std::abs(single[c] - expected) < 1e-5f);
+            assert(std::abs(batch[r * bank.size() + c] - single[c]) < 1e-6f);
+        }
+    }
+}
+
+void test_model_bank() {
+    std::vector<float> rows(9 * 20);
+    std::mt19937_64 rng(5);
+    std::normal_distribution<float> feature(0.0f, 1.0f);
+    for (auto& v : rows) {
+        v = feature(rng);
+    }
+
+    // models[id] is the model the bank should hold under that id.
+    classifier::ModelBank<20> bank;
+    std::vector<classifier::Model<20>> models;
+    for (std::size_t m = 0; m < 37; ++m) {
+        auto id = bank.add(make_tenant_model(m));
+        assert(id == m);
+        models.push_back(make_tenant_model(m));
+    }
+    assert(bank.size() == 37 && bank.stride() == 64);
+    check_bank_matches_models(bank, models, rows);
+
+    // Removing moves the last column into the hole; the freed id is reused.
+    assert(bank.remove(3) == classifier::Error::none);
+    assert(bank.remove(36) == classifier::Error::none);
+    assert(bank.size() == 35 && !bank.contains(3) && bank.column(35) == 3);
+    assert(bank.remove(3) == classifier::Error::unknown_model);
+    assert(bank.column(3) == bank.npos && bank.column(1000) == bank.npos);
+    check_bank_matches_models(bank, models, rows);
+    auto reused = bank.add(make_tenant_model(100));
+    assert(reused == 36);
+    models[reused] = make_tenant_model(100);
+    assert(bank.replace(10, make_tenant_model(101)) == classifier::Error::none);
+    models[10] = make_tenant_model(101);
+    check_bank_matches_models(bank, models, rows);
+
+    classifier::Model<20> copy;
+    assert(bank.get(10, copy) == classifier::Error::none);
+    for (std::size_t i = 0; i < 20; ++i) {
+        assert(copy.weight(i) == models[10].weight(i));
+    }
+    assert(copy.bias() == models[10].bias());
+    assert(bank.get(3, copy) == classifier::Error::unknown_model);
+    assert(bank.replace(99, copy) == classifier::Error::unknown_model);
+
+    std::vector<float> scores(bank.size() + 1);
+    assert(bank.score_batch(rows, scores) == classifier::Error::size_mismatch);
+    assert(bank.score_batch(std::span<float const>(rows).first(30), scores) ==
+           classifier::Error::size_mismatch);
+    std::array<float, 20> x{};
+    assert(bank.score(x, scores) == classifier::Error::size_mismatch);
+
+    while (bank.size() > 0) {
+        assert(bank.remove(bank.ids().back()) == classifier::Error::none);
+    }
+    assert(bank.score_batch(rows, std::span<float>()) == classifier::Error::none);
+    std::cout << "  PASS: test_model_bank\n";
+}
+
 int main() {
     std::cout << "Running classifier tests...\n";
 
@@ -308,6 +3111,70 @@ int main() {
     test_deserialize_training_data();
     test_deserialize_training_data_column_mismatch();
     test_deserialize_training_data_round_trip_train();
+    test_classify_batch_matches_classify();
+    test_score_batch_isa_agreement();
+    test_classify_batch_size_mismatch();
+    test_classify_batch_empty_model();
+    test_sgd_converges();
+    test_sgd_deterministic_for_seed_and_threads();
+    test_sgd_full_batch_matches_train();
+    test_sgd_invalid_options();
+    test_hogwild_converges();
+    test_hogwild_single_thread_deterministic();
+    test_hogwild_schedule_and_errors();
+    test_dynamic_model_matches_model();
+    test_dynamic_model_serialize_interop();
+    test_dynamic_trainer_matches_trainer();
+    test_dynamic_trainer_training_data();
+    test_deserialize_oversized_header();
+    test_mapped_training_data();
+    test_mapped_training_data_validation();
+    test_streaming_matches_in_memory_sgd();
+    test_streaming_errors();
+    test_columnar_conversion();
+    test_columnar_train_matches_row_train();
+    test_int8_dot_isa_agreement();
+    test_quantized_model_accuracy_drift();
+    test_quantized_model_serialize();
+    test_sigmoid_policy_error_bounds();
+    test_model_with_approximate_sigmoid();
+    test_sparse_model_matches_dynamic();
+    test_csr_training_data_round_trip();
+    test_sparse_trainer_converges();
+    test_sparse_lazy_regularization_matches_eager();
+    test_hash_keys_isa_agreement();
+    test_feature_hasher_signed_buckets();
+    test_feature_hasher_batch_matches_rows();
+    test_feature_hasher_feeds_trainer();
+    test_crc32c();
+    test_model_file_round_trip();
+    test_mapped_model();
+    test_model_registry_snapshots();
+    test_model_registry_background_load();
+    test_model_registry_swap_stress();
+    test_model_registry_read_latency();
+    test_linear_classes_isa_agreement();
+    test_multiclass_one_vs_rest_matches_models();
+    test_multiclass_batch_and_serialize();
+    test_multiclass_trainer_converges();
+    test_arena();
+    test_inference_is_allocation_free();
+    test_optimizers_converge();
+    test_ftrl_sparsity_and_compact_model();
+    test_training_observer_and_validation_split();
+    test_early_stopping();
+    test_fixed_kernels();
+    test_thread_pool_run_tasks();
+    test_search_candidates();
+    test_roc_auc();
+    test_train_on_row_subset();
+    test_cross_validation();
+    test_latency_histogram();
+    test_scoring_server();
+    test_scoring_server_backpressure();
+    test_evaluation();
+    test_linear_classes_rows_isa_agreement();
+    test_model_bank();
 
     std::cout << "All tests passed.\n";
     return 0;
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "classifier/metrics.h"
+#include "classifier/model.h"
+#include "classifier/trainer.h"
+
+// Built twice, with the metrics layer compiled out (or as configured) and
+// forced in, so both forms of metrics.h stay covered.
+
+void test_metrics() {
+    namespace metrics = classifier::metrics;
+    if constexpr (!metrics::enabled) {
+        assert(sizeof(classifier::Model<3>) == 4 * sizeof(float));
+        assert(metrics::register_model("unused") == 0);
+        assert(metrics::snapshot().models.empty());
+        std::cout << "  PASS: test_metrics (compiled out)\n";
+        return;
+    }
+
+    metrics::ModelId id = metrics::register_model("test_metrics");
+    assert(id != 0 && metrics::register_model("test_metrics") == id);
+    auto before = metrics::snapshot();
+
+    classifier::Model<4> model;
+    model.set_metrics_id(metrics::max_models);
+    assert(model.metrics_id() == 0);
+    model.set_metrics_id(id);
+    assert(model.metrics_id() == id);
+    std::array<float, 4> x = {1.0f, 2.0f, 3.0f, 4.0f};
+    for (int i = 0; i < 1000; ++i) {
+        model.classify(x);
+    }
+    std::vector<float> rows(10 * 4, 0.5f);
+    std::vector<float> scores(10);
+    for (int i = 0; i < 3; ++i) {
+        model.score_batch(rows, scores);
+    }
+    std::thread([&] {
+        for (int i = 0; i < 500; ++i) {
+            model.classify(x);
+        }
+    }).join();
+
+    std::stringstream stream;
+    model.serialize(stream);
+    classifier::Model<4> loaded;
+    assert(loaded.deserialize(stream) == classifier::Error::none);
+
+    std::stringstream data_stream;
+    std::size_t shape[2] = {5, 3};
+    std::vector<float> values(15, 1.0f);
+    data_stream.write(reinterpret_cast<char const*>(shape), sizeof(shape));
+    data_stream.write(reinterpret_cast<char const*>(values.data()), sizeof(float) * values.size());
+    classifier::Trainer<4>::TrainingSet data;
+    assert(classifier::Trainer<4>::deserialize_training_data(data_stream, data) ==
+           classifier::Error::none);
+    classifier::Trainer<4>(model).train(data, 0.1f, 7);
+
+    auto after = metrics::snapshot();
+    auto tagged = std::find_if(after.models.begin(), after.models.end(),
+                               [&](auto const& m) { return m.id == id; });
+    assert(tagged != after.models.end() && tagged->name == "test_metrics");
+    assert(tagged->calls == 1503 && tagged->rows == 1530);
+    assert(tagged->latency.count() > 0 && tagged->latency.count() <= tagged->calls);
+
+    assert(after.model_reads.calls == before.model_reads.calls + 1);
+    assert(after.model_reads.bytes ==
+           before.model_reads.bytes + sizeof(std::size_t) + 5 * sizeof(float));
+    assert(after.training_data_reads.bytes ==
+           before.training_data_reads.bytes + sizeof(shape) + sizeof(float) * values.size());
+    assert(after.epochs.count() == before.epochs.count() + 7);
+
+    std::ostringstream text;
+    metrics::write_text(text, after);
+    assert(text.str().find("classifier_scoring_calls_total{model=\"test_metrics\"} 1503") !=
+           std::string::npos);
+    assert(text.str().find("classifier_epoch_seconds_count") != std::string::npos);
+    std::cout << "  PASS: test_metrics\n";
+}
+
+int main() {
+    std::cout << "Running metrics tests...\n";
+
+    test_metrics();
+
+    std::cout << "All tests passed.\n";
+    return 0;
+}